@@ -0,0 +1,63 @@
+/*
+    SwiffBench.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import <Foundation/Foundation.h>
+
+@class SwiffMovie;
+
+
+// moviePaths is nil when no movies were given on the command line
+typedef void (*SwiffBenchFunction)(NSArray *moviePaths);
+
+// Seconds since an arbitrary point in time
+extern double SwiffBenchGetTime(void);
+
+// Writes a line to stdout
+extern void SwiffBenchPrint(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
+
+// Paths of filenames in the Tests directory of the repository, or of all of its .swf files when filenames is nil
+extern NSArray *SwiffBenchGetTestMoviePaths(NSArray *filenames);
+
+// Returns nil (after printing why) when path cannot be read
+extern SwiffMovie *SwiffBenchCreateMovie(NSString *path, SwiffMovieReadingOptions options);
+
+// Returns the movie at path as an uncompressed (FWS) file, so that parsing it does not include
+// decompression.  Returns nil (after printing why) when path cannot be read
+extern NSData *SwiffBenchCopyUncompressedData(NSString *path);
+
+
+// Benchmarks, one per source file.  Each reports its numbers through SwiffBenchPrint()
+//
+extern void SwiffBenchBitReader(NSArray *moviePaths);
+extern void SwiffBenchCompression(NSArray *moviePaths);
+extern void SwiffBenchEdges(NSArray *moviePaths);
+extern void SwiffBenchFilters(NSArray *moviePaths);
+extern void SwiffBenchGlyphs(NSArray *moviePaths);
+extern void SwiffBenchShapes(NSArray *moviePaths);
+extern void SwiffBenchSprites(NSArray *moviePaths);
+extern void SwiffBenchTiles(NSArray *moviePaths);
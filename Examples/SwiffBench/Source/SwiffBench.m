@@ -0,0 +1,132 @@
+/*
+    SwiffBench.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+#import <mach/mach_time.h>
+
+
+double SwiffBenchGetTime(void)
+{
+    static mach_timebase_info_data_t sTimebase;
+    if (!sTimebase.denom) mach_timebase_info(&sTimebase);
+
+    return ((double)mach_absolute_time() * sTimebase.numer) / (sTimebase.denom * 1e9);
+}
+
+
+void SwiffBenchPrint(NSString *format, ...)
+{
+    va_list v;
+    va_start(v, format);
+    NSString *string = [[NSString alloc] initWithFormat:format arguments:v];
+    va_end(v);
+
+    fprintf(stdout, "%s\n", [string UTF8String]);
+    fflush(stdout);
+}
+
+
+static NSString *sGetTestsPath(void)
+{
+    // This file is Examples/SwiffBench/Source/SwiffBench.m
+    NSString *path = [[NSString alloc] initWithUTF8String:__FILE__];
+
+    for (NSInteger i = 0; i < 4; i++) {
+        path = [path stringByDeletingLastPathComponent];
+    }
+
+    return [path stringByAppendingPathComponent:@"Tests"];
+}
+
+
+NSArray *SwiffBenchGetTestMoviePaths(NSArray *filenames)
+{
+    NSString *testsPath = sGetTestsPath();
+    NSMutableArray *result = [NSMutableArray array];
+
+    if (!filenames) {
+        NSArray *contents = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:testsPath error:NULL];
+        filenames = [contents pathsMatchingExtensions:[NSArray arrayWithObject:@"swf"]];
+        filenames = [filenames sortedArrayUsingSelector:@selector(compare:)];
+    }
+
+    for (NSString *filename in filenames) {
+        [result addObject:[testsPath stringByAppendingPathComponent:filename]];
+    }
+
+    return result;
+}
+
+
+SwiffMovie *SwiffBenchCreateMovie(NSString *path, SwiffMovieReadingOptions options)
+{
+    SwiffMovie *movie = [[SwiffMovie alloc] initWithContentsOfFile:path options:options];
+
+    if (!movie) {
+        SwiffBenchPrint(@"Could not read %@", path);
+    }
+
+    return movie;
+}
+
+
+NSData *SwiffBenchCopyUncompressedData(NSString *path)
+{
+    NSData *data = [[NSData alloc] initWithContentsOfFile:path];
+    NSMutableData *result = nil;
+
+    if (!data) {
+        SwiffBenchPrint(@"Could not read %@", path);
+        return nil;
+    }
+
+    SwiffParser *parser = SwiffParserCreateWithBackingData(data);
+    SwiffHeader header;
+
+    if (SwiffParserReadHeader(parser, &header) && (header.fileLength > 8)) {
+        // The decompressed data of a CWS or ZWS file starts after the 8 byte header
+        NSData     *body       = header.isCompressed ? SwiffParserGetBackingData(parser) : data;
+        NSUInteger  bodyOffset = header.isCompressed ? 0 : 8;
+        NSUInteger  bodyLength = MIN([body length] - bodyOffset, header.fileLength - 8);
+
+        UInt32 fileLength = OSSwapHostToLittleInt32((UInt32)(bodyLength + 8));
+        UInt8  signature[4] = { 'F', 'W', 'S', (UInt8)header.version };
+
+        result = [[NSMutableData alloc] initWithCapacity:(bodyLength + 8)];
+        [result appendBytes:signature length:sizeof(signature)];
+        [result appendBytes:&fileLength length:sizeof(fileLength)];
+        [result appendBytes:((const UInt8 *)[body bytes] + bodyOffset) length:bodyLength];
+
+    } else {
+        SwiffBenchPrint(@"Could not read the header of %@", path);
+    }
+
+    SwiffParserFree(parser);
+
+    return result;
+}
@@ -0,0 +1,256 @@
+/*
+    SwiffBenchBitReader.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+static const NSUInteger sPassCount = 5;
+
+// Field widths are read in this order, repeating.  The mix resembles the style change and edge
+// records of a DefineShape: flag bits, 4 and 5 bit counts, and 13 to 16 bit deltas
+static const UInt8 sFieldWidths[] = { 1, 1, 4, 15, 15, 1, 1, 13, 1, 5, 16, 16, 1, 2, 14 };
+
+#define sFieldWidthsCount (sizeof(sFieldWidths) / sizeof(sFieldWidths[0]))
+
+
+#pragma mark -
+#pragma mark Reference Reader
+
+// The SwiffParserReadUBits() which shipped before the word-at-a-time reader: one bit per iteration,
+// with a bounds check for each byte
+//
+typedef struct SwiffBenchBitReader {
+    const UInt8 *b;
+    const UInt8 *end;
+    UInt8        bitPosition;
+    UInt8        bitByte;
+} SwiffBenchBitReader;
+
+
+static __attribute__((noinline)) BOOL sEnsureBuffer(SwiffBenchBitReader *reader, NSUInteger length)
+{
+    return (reader->b + length) <= reader->end;
+}
+
+
+static void sReadUBits(SwiffBenchBitReader *reader, UInt8 numberOfBits, UInt32 *outValue)
+{
+    UInt32 value = 0;
+    UInt8  bp    = reader->bitPosition;
+
+    for (UInt8 i = 0; i < numberOfBits; i++) {
+        if (bp == 0) {
+            if (!sEnsureBuffer(reader, 1)) break;
+            reader->bitByte = *reader->b;
+            reader->b++;
+        }
+
+        UInt8 bit = ((reader->bitByte >> (7 - bp)) & 0x1);
+        value = (value << 1) + bit;
+
+        bp = (bp + 1) % 8;
+    }
+
+    reader->bitPosition = bp;
+
+    if (outValue) *outValue = value;
+}
+
+
+#pragma mark -
+#pragma mark Benchmark
+
+typedef struct SwiffBenchTotals {
+    NSUInteger fieldCount;
+    NSUInteger bitCount;
+    UInt32     checksum;
+} SwiffBenchTotals;
+
+
+// Reads fields of sFieldWidths from the current tag of parser, until the tag is exhausted
+static void sReadTagWithParser(SwiffParser *parser, SwiffBenchTotals *totals)
+{
+    NSUInteger tagBits = SwiffParserGetBytesRemainingInCurrentTag(parser) * 8;
+    NSUInteger bits    = 0;
+
+    for (NSUInteger i = 0; (bits + sFieldWidths[i]) <= tagBits; i = (i + 1) % sFieldWidthsCount) {
+        UInt32 value;
+        SwiffParserReadUBits(parser, sFieldWidths[i], &value);
+
+        bits += sFieldWidths[i];
+        totals->checksum = (totals->checksum * 31) + value;
+        totals->fieldCount++;
+    }
+
+    totals->bitCount += bits;
+}
+
+
+static void sReadTagWithReader(SwiffBenchBitReader *reader, SwiffBenchTotals *totals)
+{
+    NSUInteger tagBits = (reader->end - reader->b) * 8;
+    NSUInteger bits    = 0;
+
+    for (NSUInteger i = 0; (bits + sFieldWidths[i]) <= tagBits; i = (i + 1) % sFieldWidthsCount) {
+        UInt32 value;
+        sReadUBits(reader, sFieldWidths[i], &value);
+
+        bits += sFieldWidths[i];
+        totals->checksum = (totals->checksum * 31) + value;
+        totals->fieldCount++;
+    }
+
+    totals->bitCount += bits;
+}
+
+
+static BOOL sIsBenchmarkedTag(SwiffTag tag)
+{
+    return (tag == SwiffTagDefineShape) || (tag == SwiffTagDefineFont);
+}
+
+
+// Reads the DefineShape and DefineFont tags of each movie as a stream of bit fields, once through
+// SwiffParserReadUBits() and once through the reference reader, then decodes the shapes for real
+//
+void SwiffBenchBitReader(NSArray *moviePaths)
+{
+    if (!moviePaths) moviePaths = SwiffBenchGetTestMoviePaths([NSArray arrayWithObject:@"TestSuite.swf"]);
+
+    for (NSString *path in moviePaths) {
+        @autoreleasepool {
+            NSData *data = SwiffBenchCopyUncompressedData(path);
+            if (!data) continue;
+
+            const UInt8 *bytes  = [data bytes];
+            NSUInteger   length = [data length];
+
+            // Tag bodies for the reference reader, as { start, end } pairs
+            NSMutableData *ranges = [[NSMutableData alloc] init];
+            NSUInteger     shapeCount = 0;
+
+            SwiffParser *parser = SwiffParserCreate(bytes, length);
+            SwiffParserReadHeader(parser, NULL);
+
+            while (SwiffParserIsValid(parser)) {
+                SwiffParserAdvanceToNextTag(parser);
+
+                SwiffTag tag = SwiffParserGetCurrentTag(parser);
+                if (tag == SwiffTagEnd) break;
+                if (!sIsBenchmarkedTag(tag)) continue;
+
+                const UInt8 *range[2];
+                range[0] = SwiffParserGetCurrentBytePointer(parser);
+                range[1] = range[0] + SwiffParserGetBytesRemainingInCurrentTag(parser);
+                [ranges appendBytes:range length:sizeof(range)];
+
+                if (tag == SwiffTagDefineShape) shapeCount++;
+            }
+
+            SwiffParserFree(parser);
+
+            const UInt8 **rangePointers = (const UInt8 **)[ranges bytes];
+            NSUInteger    rangesCount   = [ranges length] / (sizeof(const UInt8 *) * 2);
+
+            double bestParser = DBL_MAX, bestReference = DBL_MAX, bestShapes = DBL_MAX;
+            SwiffBenchTotals parserTotals, referenceTotals;
+
+            for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+                memset(&parserTotals,    0, sizeof(parserTotals));
+                memset(&referenceTotals, 0, sizeof(referenceTotals));
+
+                // SwiffParserReadUBits(), including the walk over the tags
+                double start = SwiffBenchGetTime();
+
+                parser = SwiffParserCreate(bytes, length);
+                SwiffParserReadHeader(parser, NULL);
+
+                while (SwiffParserIsValid(parser)) {
+                    SwiffParserAdvanceToNextTag(parser);
+
+                    SwiffTag tag = SwiffParserGetCurrentTag(parser);
+                    if (tag == SwiffTagEnd) break;
+
+                    if (sIsBenchmarkedTag(tag)) {
+                        sReadTagWithParser(parser, &parserTotals);
+                    }
+                }
+
+                SwiffParserFree(parser);
+
+                bestParser = MIN(bestParser, SwiffBenchGetTime() - start);
+
+                // Reference reader
+                start = SwiffBenchGetTime();
+
+                for (NSUInteger i = 0; i < rangesCount; i++) {
+                    SwiffBenchBitReader reader = { rangePointers[i * 2], rangePointers[(i * 2) + 1], 0, 0 };
+                    sReadTagWithReader(&reader, &referenceTotals);
+                }
+
+                bestReference = MIN(bestReference, SwiffBenchGetTime() - start);
+
+                // Full DefineShape decoding, which is dominated by edge records
+                start = SwiffBenchGetTime();
+
+                @autoreleasepool {
+                    parser = SwiffParserCreate(bytes, length);
+                    SwiffParserReadHeader(parser, NULL);
+
+                    while (SwiffParserIsValid(parser)) {
+                        SwiffParserAdvanceToNextTag(parser);
+
+                        SwiffTag tag = SwiffParserGetCurrentTag(parser);
+                        if (tag == SwiffTagEnd) break;
+
+                        if (tag == SwiffTagDefineShape) {
+                            (void)[[SwiffShapeDefinition alloc] initWithParser:parser movie:nil];
+                        }
+                    }
+
+                    SwiffParserFree(parser);
+                }
+
+                bestShapes = MIN(bestShapes, SwiffBenchGetTime() - start);
+            }
+
+            SwiffBenchPrint(@"%@: %ld tags, %.1f KB of bit fields, %ld fields", [path lastPathComponent],
+                (long)rangesCount, parserTotals.bitCount / (8.0 * 1024.0), (long)parserTotals.fieldCount);
+
+            if ((parserTotals.checksum != referenceTotals.checksum) || (parserTotals.fieldCount != referenceTotals.fieldCount)) {
+                SwiffBenchPrint(@"    MISMATCH: SwiffParserReadUBits() and the reference reader read different values");
+            }
+
+            double parserRate    = parserTotals.fieldCount    / bestParser    / 1e6;
+            double referenceRate = referenceTotals.fieldCount / bestReference / 1e6;
+
+            SwiffBenchPrint(@"    bit-at-a-time         %8.3f ms  %7.1f M fields/s", bestReference * 1000.0, referenceRate);
+            SwiffBenchPrint(@"    SwiffParserReadUBits  %8.3f ms  %7.1f M fields/s  %5.2fx", bestParser * 1000.0, parserRate, bestReference / bestParser);
+            SwiffBenchPrint(@"    DefineShape decoding  %8.3f ms for %ld shapes", bestShapes * 1000.0, (long)shapeCount);
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/*
+    SwiffBenchCompression.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+static const NSUInteger sPassCount  = 5;
+static const NSUInteger sChunkLength = 64 * 1024;
+
+
+static NSData *sCopyCompressedData(NSData *uncompressedData, SwiffCompression compression)
+{
+    const UInt8 *bytes  = [uncompressedData bytes];
+    NSUInteger   length = [uncompressedData length];
+
+    SwiffParser *parser = SwiffParserCreate(bytes, length);
+    SwiffHeader  header;
+    SwiffParserReadHeader(parser, &header);
+
+    // The tags follow the header, SwiffWriterGetDataWithHeader() writes a new one
+    const UInt8 *tags = SwiffParserGetCurrentBytePointer(parser);
+    SwiffParserFree(parser);
+
+    SwiffWriter *writer = SwiffWriterCreate();
+    SwiffWriterAppendBytes(writer, tags, (UInt32)((bytes + length) - tags));
+
+    header.isCompressed = YES;
+    header.compression  = compression;
+
+    NSData *result = SwiffWriterGetDataWithHeader(writer, header);
+    SwiffWriterFree(writer);
+
+    return result;
+}
+
+
+// Decodes data in one call, as SwiffMovie does for files
+static double sTimeDecode(NSData *data)
+{
+    double best = DBL_MAX;
+
+    for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+        double start = SwiffBenchGetTime();
+
+        SwiffParser *parser = SwiffParserCreate([data bytes], [data length]);
+        SwiffParserReadHeader(parser, NULL);
+        SwiffParserFree(parser);
+
+        best = MIN(best, SwiffBenchGetTime() - start);
+    }
+
+    return best;
+}
+
+
+// Decodes data as it arrives in chunks of sChunkLength, as SwiffMovie does for -appendData:
+static double sTimeIncrementalDecode(NSData *data, BOOL *outIsComplete)
+{
+    double best = DBL_MAX;
+    BOOL   isComplete = YES;
+
+    for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+        const UInt8 *bytes  = [data bytes];
+        NSUInteger   length = [data length];
+
+        double start = SwiffBenchGetTime();
+
+        SwiffParser *parser = SwiffParserCreateIncremental();
+
+        for (NSUInteger offset = 0; offset < length; offset += sChunkLength) {
+            SwiffParserAppendBytes(parser, bytes + offset, MIN(sChunkLength, length - offset));
+        }
+
+        SwiffParserFinishAppending(parser);
+        isComplete = isComplete && SwiffParserIsComplete(parser);
+        SwiffParserFree(parser);
+
+        best = MIN(best, SwiffBenchGetTime() - start);
+    }
+
+    if (outIsComplete) *outIsComplete = isComplete;
+
+    return best;
+}
+
+
+// Re-encodes each movie as CWS and as ZWS, then reports the file sizes and the decode throughput of each,
+// in megabytes of uncompressed output per second
+//
+void SwiffBenchCompression(NSArray *moviePaths)
+{
+    if (!moviePaths) moviePaths = SwiffBenchGetTestMoviePaths(nil);
+
+    NSUInteger totalLength = 0, totalCWSLength = 0, totalZWSLength = 0;
+    double     totalCWSTime = 0, totalZWSTime = 0;
+
+    for (NSString *path in moviePaths) {
+        @autoreleasepool {
+            NSData *data = SwiffBenchCopyUncompressedData(path);
+            if (!data) continue;
+
+            NSData *cwsData = sCopyCompressedData(data, SwiffCompressionZlib);
+            NSData *zwsData = sCopyCompressedData(data, SwiffCompressionLZMA);
+
+            if (((const char *)[zwsData bytes])[0] != 'Z') {
+                SwiffBenchPrint(@"%@: could not encode as ZWS", [path lastPathComponent]);
+                continue;
+            }
+
+            BOOL   cwsIsComplete, zwsIsComplete;
+            double cwsTime            = sTimeDecode(cwsData);
+            double zwsTime            = sTimeDecode(zwsData);
+            double cwsIncrementalTime = sTimeIncrementalDecode(cwsData, &cwsIsComplete);
+            double zwsIncrementalTime = sTimeIncrementalDecode(zwsData, &zwsIsComplete);
+
+            double megabytes = [data length] / (1024.0 * 1024.0);
+
+            SwiffBenchPrint(@"%@: %.1f KB uncompressed", [path lastPathComponent], [data length] / 1024.0);
+            SwiffBenchPrint(@"    CWS  %8.1f KB  %7.1f MB/s  %7.1f MB/s incremental%@",
+                [cwsData length] / 1024.0, megabytes / cwsTime, megabytes / cwsIncrementalTime, cwsIsComplete ? @"" : @" (INCOMPLETE)");
+            SwiffBenchPrint(@"    ZWS  %8.1f KB  %7.1f MB/s  %7.1f MB/s incremental%@  %.0f%% of CWS size",
+                [zwsData length] / 1024.0, megabytes / zwsTime, megabytes / zwsIncrementalTime, zwsIsComplete ? @"" : @" (INCOMPLETE)",
+                ([zwsData length] * 100.0) / [cwsData length]);
+
+            totalLength    += [data length];
+            totalCWSLength += [cwsData length];
+            totalZWSLength += [zwsData length];
+            totalCWSTime   += cwsTime;
+            totalZWSTime   += zwsTime;
+        }
+    }
+
+    if (totalCWSLength && totalZWSLength) {
+        double megabytes = totalLength / (1024.0 * 1024.0);
+
+        SwiffBenchPrint(@"All movies: CWS %.1f MB/s, ZWS %.1f MB/s, ZWS is %.0f%% of CWS size",
+            megabytes / totalCWSTime, megabytes / totalZWSTime, (totalZWSLength * 100.0) / totalCWSLength);
+    }
+}
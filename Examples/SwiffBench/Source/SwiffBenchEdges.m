@@ -0,0 +1,78 @@
+/*
+    SwiffBenchEdges.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+
+// Sums the packed edge storage of every DefineShape in each movie, and compares it to the storage
+// of the same edges as shape operations.  Shapes must not have built their paths yet, so each movie
+// is loaded fresh and nothing is rendered
+//
+void SwiffBenchEdges(NSArray *moviePaths)
+{
+    if (!moviePaths) moviePaths = SwiffBenchGetTestMoviePaths(nil);
+
+    NSUInteger totalEdgeCount = 0, totalPacked = 0, totalUnpacked = 0;
+
+    for (NSString *path in moviePaths) {
+        @autoreleasepool {
+            SwiffMovie *movie = SwiffBenchCreateMovie(path, SwiffMovieReadingOptionsNone);
+            if (!movie) continue;
+
+            NSUInteger shapeCount = 0, edgeCount = 0, packed = 0, unpacked = 0;
+
+            for (NSUInteger libraryID = 1; libraryID <= UINT16_MAX; libraryID++) {
+                SwiffShapeDefinition *shape = [movie shapeDefinitionWithLibraryID:(UInt16)libraryID];
+                if (!shape) continue;
+
+                shapeCount++;
+                edgeCount += [shape edgeCount];
+                packed    += [shape edgeByteCount];
+                unpacked  += [shape unpackedEdgeByteCount];
+            }
+
+            if (!edgeCount) continue;
+
+            SwiffBenchPrint(@"%-32s %5ld shapes %8ld edges:  %6.1f bytes/edge as operations,  %5.1f packed  (%ld KB -> %ld KB)",
+                [[path lastPathComponent] UTF8String], (long)shapeCount, (long)edgeCount,
+                (double)unpacked / edgeCount, (double)packed / edgeCount,
+                (long)(unpacked / 1024), (long)(packed / 1024));
+
+            totalEdgeCount += edgeCount;
+            totalPacked    += packed;
+            totalUnpacked  += unpacked;
+        }
+    }
+
+    if (totalEdgeCount) {
+        SwiffBenchPrint(@"%-32s %14ld edges:  %6.1f bytes/edge as operations,  %5.1f packed  (%ld KB -> %ld KB)",
+            "Total", (long)totalEdgeCount,
+            (double)totalUnpacked / totalEdgeCount, (double)totalPacked / totalEdgeCount,
+            (long)(totalUnpacked / 1024), (long)(totalPacked / 1024));
+    }
+}
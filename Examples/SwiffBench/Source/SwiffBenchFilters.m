@@ -0,0 +1,292 @@
+/*
+    SwiffBenchFilters.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+#import <SwiffFilter.h>
+
+static const size_t     sWidth          = 512;
+static const size_t     sHeight         = 512;
+static const NSUInteger sPassCount      = 3;
+static const NSUInteger sIterationCount = 10;
+
+
+#pragma mark -
+#pragma mark FILTERLIST Writing
+
+static void sAppendFixed(SwiffWriter *writer, CGFloat value)
+{
+    SwiffWriterAppendUInt32(writer, (UInt32)lround(value * 65536.0));
+}
+
+
+static void sAppendFloat(SwiffWriter *writer, float value)
+{
+    UInt32 i;
+    memcpy(&i, &value, sizeof(i));
+    SwiffWriterAppendUInt32(writer, i);
+}
+
+
+static void sAppendColorRGBA(SwiffWriter *writer, UInt8 red, UInt8 green, UInt8 blue, UInt8 alpha)
+{
+    SwiffWriterAppendUInt8(writer, red);
+    SwiffWriterAppendUInt8(writer, green);
+    SwiffWriterAppendUInt8(writer, blue);
+    SwiffWriterAppendUInt8(writer, alpha);
+}
+
+
+static void sAppendBlurFilter(SwiffWriter *writer, CGFloat blur, UInt8 passes)
+{
+    SwiffWriterAppendUInt8(writer, 1);
+    sAppendFixed(writer, blur);
+    sAppendFixed(writer, blur);
+    SwiffWriterAppendUBits(writer, 5, passes);
+    SwiffWriterAppendUBits(writer, 3, 0);
+}
+
+
+static void sAppendDropShadowFilter(SwiffWriter *writer)
+{
+    SwiffWriterAppendUInt8(writer, 0);
+    sAppendColorRGBA(writer, 0, 0, 0, 0x80);
+    sAppendFixed(writer, 4);            // BlurX
+    sAppendFixed(writer, 4);            // BlurY
+    sAppendFixed(writer, M_PI_4);       // Angle
+    sAppendFixed(writer, 4);            // Distance
+    SwiffWriterAppendFixed8(writer, 1); // Strength
+    SwiffWriterAppendUBits(writer, 1, 0);
+    SwiffWriterAppendUBits(writer, 1, 0);
+    SwiffWriterAppendUBits(writer, 1, 1);
+    SwiffWriterAppendUBits(writer, 5, 1);
+}
+
+
+static void sAppendGlowFilter(SwiffWriter *writer)
+{
+    SwiffWriterAppendUInt8(writer, 2);
+    sAppendColorRGBA(writer, 0xFF, 0xFF, 0x00, 0xFF);
+    sAppendFixed(writer, 6);            // BlurX
+    sAppendFixed(writer, 6);            // BlurY
+    SwiffWriterAppendFixed8(writer, 2); // Strength
+    SwiffWriterAppendUBits(writer, 1, 0);
+    SwiffWriterAppendUBits(writer, 1, 0);
+    SwiffWriterAppendUBits(writer, 1, 1);
+    SwiffWriterAppendUBits(writer, 5, 2);
+}
+
+
+static void sAppendBevelFilter(SwiffWriter *writer)
+{
+    SwiffWriterAppendUInt8(writer, 3);
+    sAppendColorRGBA(writer, 0x00, 0x00, 0x00, 0xFF);
+    sAppendColorRGBA(writer, 0xFF, 0xFF, 0xFF, 0xFF);
+    sAppendFixed(writer, 4);            // BlurX
+    sAppendFixed(writer, 4);            // BlurY
+    sAppendFixed(writer, M_PI_4);       // Angle
+    sAppendFixed(writer, 4);            // Distance
+    SwiffWriterAppendFixed8(writer, 1); // Strength
+    SwiffWriterAppendUBits(writer, 1, 1);
+    SwiffWriterAppendUBits(writer, 1, 0);
+    SwiffWriterAppendUBits(writer, 1, 1);
+    SwiffWriterAppendUBits(writer, 1, 0);
+    SwiffWriterAppendUBits(writer, 4, 1);
+}
+
+
+// Desaturates, using the luminance weights of the Flash authoring tool
+static void sAppendColorMatrixFilter(SwiffWriter *writer)
+{
+    const float r = 0.3086, g = 0.6094, b = 0.0820;
+    const float matrix[20] = {
+        r, g, b, 0, 0,
+        r, g, b, 0, 0,
+        r, g, b, 0, 0,
+        0, 0, 0, 1, 0
+    };
+
+    SwiffWriterAppendUInt8(writer, 6);
+
+    for (NSInteger i = 0; i < 20; i++) {
+        sAppendFloat(writer, matrix[i]);
+    }
+}
+
+
+// A 3x3 sharpen kernel
+static void sAppendConvolutionFilter(SwiffWriter *writer)
+{
+    const float matrix[9] = {
+         0, -1,  0,
+        -1,  5, -1,
+         0, -1,  0
+    };
+
+    SwiffWriterAppendUInt8(writer, 5);
+    SwiffWriterAppendUInt8(writer, 3);
+    SwiffWriterAppendUInt8(writer, 3);
+    sAppendFloat(writer, 1);            // Divisor
+    sAppendFloat(writer, 0);            // Bias
+
+    for (NSInteger i = 0; i < 9; i++) {
+        sAppendFloat(writer, matrix[i]);
+    }
+
+    sAppendColorRGBA(writer, 0, 0, 0, 0);
+    SwiffWriterAppendUBits(writer, 6, 0);
+    SwiffWriterAppendUBits(writer, 1, 1);   // Clamp
+    SwiffWriterAppendUBits(writer, 1, 1);   // PreserveAlpha
+}
+
+
+typedef void (*sAppendFilterFunction)(SwiffWriter *writer);
+
+static void sAppendBlur4x1(SwiffWriter *writer)  { sAppendBlurFilter(writer, 4,  1); }
+static void sAppendBlur4x3(SwiffWriter *writer)  { sAppendBlurFilter(writer, 4,  3); }
+static void sAppendBlur16x3(SwiffWriter *writer) { sAppendBlurFilter(writer, 16, 3); }
+
+typedef struct {
+    const char *name;
+    sAppendFilterFunction function;
+} sFilterEntry;
+
+// The gradient glow and gradient bevel filters are missing, as SwiffGradient only reads the
+// PlaceObject3 gradient format while a PlaceObject3 tag is being parsed
+//
+static const sFilterEntry sFilterEntries[] = {
+    { "blur 4px, 1 pass",    sAppendBlur4x1           },
+    { "blur 4px, 3 passes",  sAppendBlur4x3           },
+    { "blur 16px, 3 passes", sAppendBlur16x3          },
+    { "drop shadow",         sAppendDropShadowFilter  },
+    { "glow, 2 passes",      sAppendGlowFilter        },
+    { "bevel",               sAppendBevelFilter       },
+    { "color matrix",        sAppendColorMatrixFilter },
+    { "convolution 3x3",     sAppendConvolutionFilter }
+};
+
+#define sFilterEntriesCount (sizeof(sFilterEntries) / sizeof(sFilterEntries[0]))
+
+
+// Writes a FILTERLIST holding the single filter of entry, and reads it back with +[SwiffFilter filterListWithParser:]
+static NSArray *sCreateFilterList(const sFilterEntry *entry)
+{
+    SwiffWriter *writer = SwiffWriterCreate();
+
+    SwiffWriterAppendUInt8(writer, 1);
+    entry->function(writer);
+    SwiffWriterByteAlign(writer);
+
+    NSData *data = SwiffWriterGetData(writer);
+    SwiffWriterFree(writer);
+
+    SwiffParser *parser = SwiffParserCreate([data bytes], [data length]);
+    NSArray *result = [SwiffFilter filterListWithParser:parser];
+    BOOL isValid = SwiffParserIsValid(parser);
+    SwiffParserFree(parser);
+
+    return isValid ? result : nil;
+}
+
+
+#pragma mark -
+#pragma mark Benchmark
+
+// Premultiplied RGBA: an opaque disc in the middle of a transparent buffer, with a color gradient,
+// so that blurs and shadows see both edges and flat areas
+static void sFillSourcePixels(UInt8 *pixels, size_t width, size_t height)
+{
+    CGFloat centerX = width / 2.0, centerY = height / 2.0;
+    CGFloat radius  = MIN(width, height) * 0.375;
+
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            UInt8 *p = &pixels[((y * width) + x) * 4];
+            CGFloat distance = hypot(x - centerX, y - centerY);
+
+            if (distance <= radius) {
+                p[0] = (UInt8)((x * 255) / width);
+                p[1] = (UInt8)((y * 255) / height);
+                p[2] = 0x80;
+                p[3] = 0xFF;
+            } else {
+                p[0] = p[1] = p[2] = p[3] = 0;
+            }
+        }
+    }
+}
+
+
+// Runs each filter over a sWidth x sHeight buffer with SwiffFilterListApply(), restoring the source pixels
+// before each run, and reports the fastest of sPassCount passes of sIterationCount runs in pixels per second
+//
+void SwiffBenchFilters(NSArray *moviePaths)
+{
+    size_t bytesPerRow = sWidth * 4;
+    size_t length      = bytesPerRow * sHeight;
+
+    UInt8 *source = malloc(length);
+    UInt8 *pixels = malloc(length);
+
+    sFillSourcePixels(source, sWidth, sHeight);
+
+    SwiffBenchPrint(@"%ld x %ld pixels", (long)sWidth, (long)sHeight);
+
+    for (NSUInteger i = 0; i < sFilterEntriesCount; i++) {
+        @autoreleasepool {
+            const sFilterEntry *entry = &sFilterEntries[i];
+            NSArray *filters = sCreateFilterList(entry);
+
+            if ([filters count] != 1) {
+                SwiffBenchPrint(@"    %-20s could not be read", entry->name);
+                continue;
+            }
+
+            double best = DBL_MAX;
+
+            for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+                double total = 0;
+
+                for (NSUInteger iteration = 0; iteration < sIterationCount; iteration++) {
+                    memcpy(pixels, source, length);
+
+                    double start = SwiffBenchGetTime();
+                    SwiffFilterListApply(filters, pixels, sWidth, sHeight, bytesPerRow, 1.0);
+                    total += SwiffBenchGetTime() - start;
+                }
+
+                best = MIN(best, total);
+            }
+
+            double pixelsPerSecond = (sWidth * sHeight * sIterationCount) / best;
+            SwiffBenchPrint(@"    %-20s %8.1f Mpx/sec  %7.2f ms", entry->name, pixelsPerSecond / 1e6, (best * 1000.0) / sIterationCount);
+        }
+    }
+
+    free(source);
+    free(pixels);
+}
@@ -0,0 +1,234 @@
+/*
+    SwiffBenchGlyphs.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+static const CGFloat    sScale          = 2.0;
+static const NSUInteger sPassCount      = 3;
+static const NSUInteger sIterationCount = 20;
+
+typedef enum {
+    sMethodPerGlyph = 0,    // Save, concat, add path, fill and restore for each glyph
+    sMethodPerRecord,       // One fill per record, of a path rebuilt from the glyph paths on each draw
+    sMethodCached,          // One fill per record, of -[SwiffStaticTextDefinition glyphRunPaths]
+
+    sMethodsCount
+} sMethod;
+
+static const char *sMethodNames[sMethodsCount] = {
+    "per glyph",
+    "per record, rebuilt",
+    "cached glyph runs"
+};
+
+
+static void sSetFillColor(CGContextRef context, SwiffStaticTextRecord *record)
+{
+    if ([record hasColor]) {
+        SwiffColor color = [record color];
+        CGContextSetRGBFillColor(context, color.red, color.green, color.blue, color.alpha);
+    }
+}
+
+
+// Walks the records of definition as the renderer did before glyph runs were cached.  With perGlyph,
+// each glyph is filled on its own, otherwise each record is filled once with a path built for this draw
+//
+static void sDrawUncached(CGContextRef context, SwiffMovie *movie, SwiffStaticTextDefinition *definition, BOOL perGlyph)
+{
+    CGPathRef *glyphPaths = NULL;
+    NSUInteger glyphCount = 0;
+    CGFloat    multiplier = 1.0;
+    CGPoint    offset     = CGPointZero;
+
+    for (SwiffStaticTextRecord *record in [definition textRecords]) {
+        NSInteger glyphEntriesCount = [record glyphEntriesCount];
+        SwiffStaticTextRecordGlyphEntry *glyphEntries = [record glyphEntries];
+
+        CGFloat advance = 0;
+
+        if ([record hasFont]) {
+            SwiffFontDefinition *font = [movie fontDefinitionWithLibraryID:[record fontID]];
+            glyphPaths = [font glyphPaths];
+            glyphCount = [font glyphCount];
+            multiplier = (1.0 / SwiffFontEmSquareHeight) * [record textHeight];
+        }
+
+        if ([record hasXOffset]) offset.x = [record xOffset];
+        if ([record hasYOffset]) offset.y = [record yOffset];
+
+        sSetFillColor(context, record);
+
+        CGMutablePathRef path = perGlyph ? NULL : CGPathCreateMutable();
+
+        if (glyphPaths && glyphEntries) {
+            for (NSInteger i = 0; i < glyphEntriesCount; i++) {
+                SwiffStaticTextRecordGlyphEntry entry = glyphEntries[i];
+
+                if (entry.index < glyphCount) {
+                    CGAffineTransform glyphTransform = CGAffineTransformMake(multiplier, 0, 0, multiplier, offset.x + advance, offset.y);
+
+                    if (perGlyph) {
+                        CGContextSaveGState(context);
+                        CGContextConcatCTM(context, glyphTransform);
+                        CGContextAddPath(context, glyphPaths[entry.index]);
+                        CGContextFillPath(context);
+                        CGContextRestoreGState(context);
+                    } else {
+                        CGPathAddPath(path, &glyphTransform, glyphPaths[entry.index]);
+                    }
+                }
+
+                advance += entry.advance;
+            }
+        }
+
+        if (path) {
+            CGContextAddPath(context, path);
+            CGContextFillPath(context);
+            CGPathRelease(path);
+        }
+
+        offset.x += advance;
+    }
+}
+
+
+static void sDrawCached(CGContextRef context, SwiffStaticTextDefinition *definition)
+{
+    NSArray *glyphRunPaths = [definition glyphRunPaths];
+    NSUInteger index = 0;
+
+    for (SwiffStaticTextRecord *record in [definition textRecords]) {
+        CGPathRef path = (__bridge CGPathRef)[glyphRunPaths objectAtIndex:index++];
+
+        sSetFillColor(context, record);
+
+        if (!CGPathIsEmpty(path)) {
+            CGContextAddPath(context, path);
+            CGContextFillPath(context);
+        }
+    }
+}
+
+
+static NSUInteger sGetGlyphCount(SwiffStaticTextDefinition *definition)
+{
+    NSUInteger result = 0;
+
+    for (SwiffStaticTextRecord *record in [definition textRecords]) {
+        result += [record glyphEntriesCount];
+    }
+
+    return result;
+}
+
+
+// Draws every DefineText of each movie, at its text transform, into a bitmap context of sScale times the
+// stage size.  Each pass draws all definitions sIterationCount times with each method, and the fastest
+// of sPassCount passes is reported as glyphs per second
+//
+void SwiffBenchGlyphs(NSArray *moviePaths)
+{
+    if (!moviePaths) {
+        moviePaths = SwiffBenchGetTestMoviePaths([NSArray arrayWithObjects:@"DynamicText.swf", @"TestSuite.swf", nil]);
+    }
+
+    for (NSString *path in moviePaths) {
+        @autoreleasepool {
+            SwiffMovie *movie = SwiffBenchCreateMovie(path, SwiffMovieReadingOptionsNone);
+            if (!movie) continue;
+
+            NSMutableArray *definitions = [NSMutableArray array];
+            NSUInteger glyphCount = 0;
+
+            for (NSUInteger libraryID = 1; libraryID <= UINT16_MAX; libraryID++) {
+                SwiffStaticTextDefinition *definition = [movie staticTextDefinitionWithLibraryID:(UInt16)libraryID];
+                if (!definition) continue;
+
+                [definitions addObject:definition];
+                glyphCount += sGetGlyphCount(definition);
+            }
+
+            if (!glyphCount) {
+                SwiffBenchPrint(@"%@: no static text", [path lastPathComponent]);
+                continue;
+            }
+
+            CGRect stageRect = [movie stageRect];
+            size_t width     = (size_t)ceil(stageRect.size.width  * sScale);
+            size_t height    = (size_t)ceil(stageRect.size.height * sScale);
+
+            CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+            CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, width * 4, colorSpace, kCGImageAlphaPremultipliedLast);
+            CGColorSpaceRelease(colorSpace);
+
+            CGContextScaleCTM(context, sScale, sScale);
+            CGContextTranslateCTM(context, -stageRect.origin.x, -stageRect.origin.y);
+
+            double best[sMethodsCount];
+            for (NSUInteger m = 0; m < sMethodsCount; m++) {
+                best[m] = DBL_MAX;
+            }
+
+            for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+                for (NSUInteger m = 0; m < sMethodsCount; m++) {
+                    @autoreleasepool {
+                        double start = SwiffBenchGetTime();
+
+                        for (NSUInteger i = 0; i < sIterationCount; i++) {
+                            for (SwiffStaticTextDefinition *definition in definitions) {
+                                CGContextSaveGState(context);
+                                CGContextConcatCTM(context, [definition textTransform]);
+
+                                if (m == sMethodCached) {
+                                    sDrawCached(context, definition);
+                                } else {
+                                    sDrawUncached(context, movie, definition, (m == sMethodPerGlyph));
+                                }
+
+                                CGContextRestoreGState(context);
+                            }
+                        }
+
+                        best[m] = MIN(best[m], SwiffBenchGetTime() - start);
+                    }
+                }
+            }
+
+            CGContextRelease(context);
+
+            SwiffBenchPrint(@"%@: %ld text definitions, %ld glyphs", [path lastPathComponent], (long)[definitions count], (long)glyphCount);
+
+            for (NSUInteger m = 0; m < sMethodsCount; m++) {
+                double glyphsPerSecond = (glyphCount * sIterationCount) / best[m];
+                SwiffBenchPrint(@"    %-20s %10.0f glyphs/sec  %5.2fx", sMethodNames[m], glyphsPerSecond, best[sMethodPerGlyph] / best[m]);
+            }
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/*
+    SwiffBenchMain.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+
+typedef struct SwiffBenchEntry {
+    const char        *name;
+    SwiffBenchFunction function;
+    const char        *description;
+} SwiffBenchEntry;
+
+
+static const SwiffBenchEntry sEntries[] = {
+    { "bits",    SwiffBenchBitReader,   "SwiffParserReadUBits() vs. a bit-at-a-time reader on shape and font tags" },
+    { "zws",     SwiffBenchCompression, "Size and decode throughput of CWS vs. ZWS, on all movies in Tests/" },
+    { "edges",   SwiffBenchEdges,       "Bytes per edge of packed shape edges vs. shape operations, on all movies in Tests/" },
+    { "filters", SwiffBenchFilters,     "Pixels/sec of each SwiffFilter through SwiffFilterListApply()" },
+    { "glyphs",  SwiffBenchGlyphs,      "Static text glyphs/sec, per-glyph fills vs. cached glyph run paths" },
+    { "shapes",  SwiffBenchShapes,      "-[SwiffShapeDefinition paths] on synthetic shapes of 10k to 100k edges" },
+    { "sprites", SwiffBenchSprites,     "SwiffTimeline steps with 100 to 1000 animating clip instances" },
+    { "tiles",   SwiffBenchTiles,       "Rasterizer frames at 2x, single-threaded vs. tiled on all cores" }
+};
+
+static const NSUInteger sEntriesCount = sizeof(sEntries) / sizeof(sEntries[0]);
+
+
+static void sPrintUsage(void)
+{
+    SwiffBenchPrint(@"usage: SwiffBench [benchmark ...] [movie.swf ...]");
+    SwiffBenchPrint(@"Runs all benchmarks, on the movies in Tests/ which each uses by default.  Benchmarks:");
+
+    for (NSUInteger i = 0; i < sEntriesCount; i++) {
+        SwiffBenchPrint(@"    %-10s %s", sEntries[i].name, sEntries[i].description);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    @autoreleasepool {
+        NSMutableArray *moviePaths = nil;
+        NSMutableIndexSet *selected = [NSMutableIndexSet indexSet];
+
+        for (int i = 1; i < argc; i++) {
+            NSString *argument = [NSString stringWithUTF8String:argv[i]];
+
+            if ([[argument pathExtension] caseInsensitiveCompare:@"swf"] == NSOrderedSame) {
+                if (!moviePaths) moviePaths = [NSMutableArray array];
+                [moviePaths addObject:argument];
+                continue;
+            }
+
+            NSUInteger index = NSNotFound;
+            for (NSUInteger j = 0; j < sEntriesCount; j++) {
+                if (strcmp(argv[i], sEntries[j].name) == 0) index = j;
+            }
+
+            if (index == NSNotFound) {
+                sPrintUsage();
+                return 1;
+            }
+
+            [selected addIndex:index];
+        }
+
+        if (![selected count]) {
+            [selected addIndexesInRange:NSMakeRange(0, sEntriesCount)];
+        }
+
+#if DEBUG
+        SwiffBenchPrint(@"Debug build, use the Release configuration for representative numbers");
+#endif
+        SwiffBenchPrint(@"%ld active cores", (long)[[NSProcessInfo processInfo] activeProcessorCount]);
+
+        [selected enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+            SwiffBenchPrint(@"\n%s: %s", sEntries[index].name, sEntries[index].description);
+
+            @autoreleasepool {
+                sEntries[index].function(moviePaths);
+            }
+        }];
+    }
+
+    return 0;
+}
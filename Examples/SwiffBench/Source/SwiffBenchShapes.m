@@ -0,0 +1,189 @@
+/*
+    SwiffBenchShapes.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+static const NSUInteger sPassCount   = 3;
+static const SInt32     sCellTwips   = 100;
+static const UInt8      sMoveBits    = 17;
+static const UInt8      sDeltaBits   = 9;
+static const NSUInteger sGridSizes[] = { 71, 112, 158, 224 };  // About 10k, 25k, 50k and 100k edges
+
+#define sGridSizesCount (sizeof(sGridSizes) / sizeof(sGridSizes[0]))
+
+
+// The fill style of the cell at column, row: a checkerboard of styles 1 and 2, and 0 outside of the grid
+static UInt32 sGetCellFillStyle(NSInteger column, NSInteger row, NSInteger size)
+{
+    if ((column < 0) || (row < 0) || (column >= size) || (row >= size)) return 0;
+    return ((column + row) % 2) ? 2 : 1;
+}
+
+
+// Writes a STYLECHANGERECORD with a move to from and both fill styles, then a STRAIGHTEDGERECORD to from + delta
+static void sAppendEdge(SwiffWriter *writer, SInt32 fromX, SInt32 fromY, BOOL isVertical, UInt32 fillStyle0, UInt32 fillStyle1)
+{
+    SwiffWriterAppendUBits(writer, 1, 0);   // TypeFlag
+    SwiffWriterAppendUBits(writer, 1, 0);   // StateNewStyles
+    SwiffWriterAppendUBits(writer, 1, 0);   // StateLineStyle
+    SwiffWriterAppendUBits(writer, 1, 1);   // StateFillStyle1
+    SwiffWriterAppendUBits(writer, 1, 1);   // StateFillStyle0
+    SwiffWriterAppendUBits(writer, 1, 1);   // StateMoveTo
+    SwiffWriterAppendUBits(writer, 5, sMoveBits);
+    SwiffWriterAppendSBits(writer, sMoveBits, fromX);
+    SwiffWriterAppendSBits(writer, sMoveBits, fromY);
+    SwiffWriterAppendUBits(writer, 2, fillStyle0);
+    SwiffWriterAppendUBits(writer, 2, fillStyle1);
+
+    SwiffWriterAppendUBits(writer, 1, 1);   // TypeFlag
+    SwiffWriterAppendUBits(writer, 1, 1);   // StraightFlag
+    SwiffWriterAppendUBits(writer, 4, sDeltaBits - 2);
+    SwiffWriterAppendUBits(writer, 1, 0);   // GeneralLineFlag
+    SwiffWriterAppendUBits(writer, 1, isVertical ? 1 : 0);
+    SwiffWriterAppendSBits(writer, sDeltaBits, sCellTwips);
+}
+
+
+// Returns a movie containing a single DefineShape: a size x size grid of cells, filled as a checkerboard.
+// Each edge between two cells is written once, with a move to its start and the fill styles on both sides.
+// All horizontal edges come first, row by row, then all vertical edges, column by column, so that the
+// edges of each cell are far apart in the file
+//
+static NSData *sCopyGridMovieData(NSInteger size, NSUInteger *outEdgeCount)
+{
+    SwiffWriter *writer = SwiffWriterCreate();
+    NSUInteger edgeCount = 0;
+
+    SwiffWriterStartTag(writer, SwiffTagDefineShape, 1);
+    SwiffWriterAppendUInt16(writer, 1);
+    SwiffWriterAppendRect(writer, CGRectMake(0, 0, (size * sCellTwips) / 20.0, (size * sCellTwips) / 20.0));
+
+    // FILLSTYLEARRAY with two solid fills, empty LINESTYLEARRAY
+    SwiffWriterAppendUInt8(writer, 2);
+    SwiffWriterAppendUInt8(writer, 0x00);
+    SwiffWriterAppendUInt8(writer, 0xFF); SwiffWriterAppendUInt8(writer, 0x00); SwiffWriterAppendUInt8(writer, 0x00);
+    SwiffWriterAppendUInt8(writer, 0x00);
+    SwiffWriterAppendUInt8(writer, 0x00); SwiffWriterAppendUInt8(writer, 0x00); SwiffWriterAppendUInt8(writer, 0xFF);
+    SwiffWriterAppendUInt8(writer, 0);
+
+    SwiffWriterAppendUBits(writer, 4, 2);   // NumFillBits
+    SwiffWriterAppendUBits(writer, 4, 0);   // NumLineBits
+
+    // Horizontal edges run left to right, with the cell above on their left
+    for (NSInteger row = 0; row <= size; row++) {
+        for (NSInteger column = 0; column < size; column++) {
+            UInt32 above = sGetCellFillStyle(column, row - 1, size);
+            UInt32 below = sGetCellFillStyle(column, row, size);
+
+            sAppendEdge(writer, (SInt32)(column * sCellTwips), (SInt32)(row * sCellTwips), NO, above, below);
+            edgeCount++;
+        }
+    }
+
+    // Vertical edges run top to bottom, with the cell to the right on their left
+    for (NSInteger column = 0; column <= size; column++) {
+        for (NSInteger row = 0; row < size; row++) {
+            UInt32 left  = sGetCellFillStyle(column - 1, row, size);
+            UInt32 right = sGetCellFillStyle(column, row, size);
+
+            sAppendEdge(writer, (SInt32)(column * sCellTwips), (SInt32)(row * sCellTwips), YES, right, left);
+            edgeCount++;
+        }
+    }
+
+    SwiffWriterAppendUBits(writer, 6, 0);   // ENDSHAPERECORD
+    SwiffWriterEndTag(writer);
+
+    SwiffWriterStartTag(writer, SwiffTagEnd, 0);
+    SwiffWriterEndTag(writer);
+
+    SwiffHeader header;
+    memset(&header, 0, sizeof(header));
+    header.version   = 10;
+    header.stageRect = CGRectMake(0, 0, 550, 400);
+    header.frameRate = 24;
+
+    NSData *result = SwiffWriterGetDataWithHeader(writer, header);
+    SwiffWriterFree(writer);
+
+    if (outEdgeCount) *outEdgeCount = edgeCount;
+
+    return result;
+}
+
+
+static SwiffShapeDefinition *sCreateShapeDefinition(NSData *data)
+{
+    SwiffParser *parser = SwiffParserCreate([data bytes], [data length]);
+    SwiffShapeDefinition *result = nil;
+
+    if (SwiffParserReadHeader(parser, NULL)) {
+        SwiffParserAdvanceToNextTag(parser);
+
+        if (SwiffParserGetCurrentTag(parser) == SwiffTagDefineShape) {
+            result = [[SwiffShapeDefinition alloc] initWithParser:parser movie:nil];
+        }
+    }
+
+    SwiffParserFree(parser);
+
+    return result;
+}
+
+
+// Decodes synthetic grid shapes of up to 100k edges, and times the first -paths call, which chains the
+// edges of each fill style into paths.  A linear assembler keeps the time per edge flat as the shapes grow
+//
+void SwiffBenchShapes(NSArray *moviePaths)
+{
+    for (NSUInteger i = 0; i < sGridSizesCount; i++) {
+        @autoreleasepool {
+            NSUInteger edgeCount = 0;
+            NSData *data = sCopyGridMovieData(sGridSizes[i], &edgeCount);
+
+            double bestDecode = DBL_MAX, bestPaths = DBL_MAX;
+            NSUInteger pathsCount = 0;
+
+            for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+                @autoreleasepool {
+                    double start = SwiffBenchGetTime();
+                    SwiffShapeDefinition *shape = sCreateShapeDefinition(data);
+                    bestDecode = MIN(bestDecode, SwiffBenchGetTime() - start);
+
+                    start = SwiffBenchGetTime();
+                    pathsCount = [[shape paths] count];
+                    bestPaths = MIN(bestPaths, SwiffBenchGetTime() - start);
+                }
+            }
+
+            SwiffBenchPrint(@"%3ld x %-3ld grid, %6ld edges:  decode %8.2f ms,  paths %8.2f ms  %6.1f ns/edge  (%ld paths)",
+                (long)sGridSizes[i], (long)sGridSizes[i], (long)edgeCount,
+                bestDecode * 1000.0, bestPaths * 1000.0, (bestPaths * 1e9) / edgeCount, (long)pathsCount);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+/*
+    SwiffBenchSprites.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+static const NSUInteger sPassCount        = 3;
+static const NSUInteger sStepCount        = 240;
+static const NSUInteger sRootFrameCount   = 48;
+static const NSUInteger sSpriteFrameCount = 24;
+static const NSUInteger sInstanceCounts[] = { 100, 250, 500, 1000 };
+
+static const UInt16 sShapeID  = 1;
+static const UInt16 sSpriteID = 2;
+
+#define sInstanceCountsCount (sizeof(sInstanceCounts) / sizeof(sInstanceCounts[0]))
+
+
+#pragma mark -
+#pragma mark Movie Writing
+
+static void sAppendTranslateMatrix(SwiffWriter *writer, SInt32 x, SInt32 y)
+{
+    SwiffWriterAppendUBits(writer, 1, 0);   // HasScale
+    SwiffWriterAppendUBits(writer, 1, 0);   // HasRotate
+    SwiffWriterAppendUBits(writer, 5, 17);
+    SwiffWriterAppendSBits(writer, 17, x);
+    SwiffWriterAppendSBits(writer, 17, y);
+    SwiffWriterByteAlign(writer);
+}
+
+
+// PlaceObject2 with a translation.  A characterID of 0 moves the object already at depth
+static void sAppendPlaceObject(SwiffWriter *writer, UInt16 depth, UInt16 characterID, SInt32 x, SInt32 y)
+{
+    SwiffWriterStartTag(writer, SwiffTagPlaceObject, 2);
+    SwiffWriterAppendUInt8(writer, characterID ? 0x06 : 0x05);  // HasMatrix, then HasCharacter or Move
+    SwiffWriterAppendUInt16(writer, depth);
+    if (characterID) SwiffWriterAppendUInt16(writer, characterID);
+    sAppendTranslateMatrix(writer, x, y);
+    SwiffWriterEndTag(writer);
+}
+
+
+static void sAppendTag(SwiffWriter *writer, SwiffTag tag)
+{
+    SwiffWriterStartTag(writer, tag, 0);
+    SwiffWriterEndTag(writer);
+}
+
+
+// A 10 x 10 point square, filled with a solid color
+static void sAppendShape(SwiffWriter *writer)
+{
+    SwiffWriterStartTag(writer, SwiffTagDefineShape, 1);
+    SwiffWriterAppendUInt16(writer, sShapeID);
+    SwiffWriterAppendRect(writer, CGRectMake(0, 0, 10, 10));
+
+    SwiffWriterAppendUInt8(writer, 1);
+    SwiffWriterAppendUInt8(writer, 0x00);
+    SwiffWriterAppendUInt8(writer, 0x00); SwiffWriterAppendUInt8(writer, 0x80); SwiffWriterAppendUInt8(writer, 0xFF);
+    SwiffWriterAppendUInt8(writer, 0);
+
+    SwiffWriterAppendUBits(writer, 4, 1);   // NumFillBits
+    SwiffWriterAppendUBits(writer, 4, 0);   // NumLineBits
+
+    // STYLECHANGERECORD: move to 0,0 with FillStyle1
+    SwiffWriterAppendUBits(writer, 6, 0x05);
+    SwiffWriterAppendUBits(writer, 5, 1);
+    SwiffWriterAppendSBits(writer, 1, 0);
+    SwiffWriterAppendSBits(writer, 1, 0);
+    SwiffWriterAppendUBits(writer, 1, 1);
+
+    // STRAIGHTEDGERECORDs around the square, 200 twips per side
+    const SInt32 deltas[4] = { 200, 200, -200, -200 };
+
+    for (NSInteger i = 0; i < 4; i++) {
+        SwiffWriterAppendUBits(writer, 2, 0x03);
+        SwiffWriterAppendUBits(writer, 4, 10 - 2);
+        SwiffWriterAppendUBits(writer, 1, 0);               // GeneralLineFlag
+        SwiffWriterAppendUBits(writer, 1, (i % 2) ? 1 : 0); // VertLineFlag
+        SwiffWriterAppendSBits(writer, 10, deltas[i]);
+    }
+
+    SwiffWriterAppendUBits(writer, 6, 0);
+    SwiffWriterEndTag(writer);
+}
+
+
+// A clip which moves the square to the right on each of its sSpriteFrameCount frames
+static void sAppendSprite(SwiffWriter *writer)
+{
+    SwiffWriter *spriteWriter = SwiffWriterCreate();
+
+    for (NSUInteger i = 0; i < sSpriteFrameCount; i++) {
+        sAppendPlaceObject(spriteWriter, 1, i ? 0 : sShapeID, (SInt32)(i * 20), 0);
+        sAppendTag(spriteWriter, SwiffTagShowFrame);
+    }
+
+    sAppendTag(spriteWriter, SwiffTagEnd);
+
+    SwiffWriterStartTag(writer, SwiffTagDefineSprite, 0);
+    SwiffWriterAppendUInt16(writer, sSpriteID);
+    SwiffWriterAppendUInt16(writer, sSpriteFrameCount);
+    SwiffWriterAppendData(writer, SwiffWriterGetData(spriteWriter));
+    SwiffWriterEndTag(writer);
+
+    SwiffWriterFree(spriteWriter);
+}
+
+
+// Returns a movie which places instanceCount copies of characterID on its first frame, in a grid,
+// and then shows sRootFrameCount - 1 frames without changes
+//
+static NSData *sCopyMovieData(NSUInteger instanceCount, UInt16 characterID)
+{
+    SwiffWriter *writer = SwiffWriterCreate();
+
+    sAppendShape(writer);
+    sAppendSprite(writer);
+
+    for (NSUInteger i = 0; i < instanceCount; i++) {
+        SInt32 x = (SInt32)((i % 40) * 220);
+        SInt32 y = (SInt32)((i / 40) * 220);
+
+        sAppendPlaceObject(writer, (UInt16)(i + 1), characterID, x, y);
+    }
+
+    for (NSUInteger i = 0; i < sRootFrameCount; i++) {
+        sAppendTag(writer, SwiffTagShowFrame);
+    }
+
+    sAppendTag(writer, SwiffTagEnd);
+
+    SwiffHeader header;
+    memset(&header, 0, sizeof(header));
+    header.version   = 10;
+    header.stageRect = CGRectMake(0, 0, 550, 400);
+    header.frameRate = 24;
+
+    NSData *result = SwiffWriterGetDataWithHeader(writer, header);
+    SwiffWriterFree(writer);
+
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Benchmark
+
+// Steps the root timeline of a movie with hundreds of looping clip instances sStepCount times, and
+// separately times -childFramesSignature, which the renderer asks for on each frame.  The same movie
+// with static shapes in place of the clips shows the cost which does not depend on the instances
+//
+void SwiffBenchSprites(NSArray *moviePaths)
+{
+    for (NSUInteger i = 0; i < sInstanceCountsCount; i++) {
+        for (NSUInteger useSprites = 0; useSprites < 2; useSprites++) {
+            @autoreleasepool {
+                NSUInteger instanceCount = sInstanceCounts[i];
+                NSData *data = sCopyMovieData(instanceCount, useSprites ? sSpriteID : sShapeID);
+                SwiffMovie *movie = [[SwiffMovie alloc] initWithData:data];
+
+                if ([[movie frames] count] != sRootFrameCount) {
+                    SwiffBenchPrint(@"Could not read the movie for %ld instances", (long)instanceCount);
+                    continue;
+                }
+
+                double bestStep = DBL_MAX, bestSignature = DBL_MAX;
+
+                for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+                    @autoreleasepool {
+                        SwiffTimeline *timeline = [[SwiffTimeline alloc] initWithMovie:movie];
+                        double stepTotal = 0, signatureTotal = 0;
+
+                        for (NSUInteger step = 0; step < sStepCount; step++) {
+                            double start = SwiffBenchGetTime();
+                            [timeline stepToFrameWithIndex:((step + 1) % sRootFrameCount)];
+                            double mid = SwiffBenchGetTime();
+                            [timeline childFramesSignature];
+                            double end = SwiffBenchGetTime();
+
+                            stepTotal      += mid - start;
+                            signatureTotal += end - mid;
+                        }
+
+                        bestStep      = MIN(bestStep, stepTotal);
+                        bestSignature = MIN(bestSignature, signatureTotal);
+                    }
+                }
+
+                double stepMicroseconds      = (bestStep      * 1e6) / sStepCount;
+                double signatureMicroseconds = (bestSignature * 1e6) / sStepCount;
+
+                SwiffBenchPrint(@"%5ld %-7s  step %8.2f us  (%6.1f ns/instance),  signature %8.2f us",
+                    (long)instanceCount, useSprites ? "clips" : "shapes",
+                    stepMicroseconds, (stepMicroseconds * 1000.0) / instanceCount, signatureMicroseconds);
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/*
+    SwiffBenchTiles.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffBench.h"
+
+static const CGFloat    sScale      = 2.0;
+static const NSUInteger sPassCount  = 3;
+static const size_t     sTileSizes[] = { 64, 128, 256, 512 };
+
+#define sTileSizesCount (sizeof(sTileSizes) / sizeof(sTileSizes[0]))
+#define sMethodsCount   (sTileSizesCount + 1)
+
+
+// Renders every frame of each movie at sScale times the stage size with the CPU rasterizer, once on the
+// calling thread and once for each tile size.  The fastest of sPassCount passes is reported, so that the
+// first pass can decode definitions and bitmaps
+//
+void SwiffBenchTiles(NSArray *moviePaths)
+{
+    if (!moviePaths) moviePaths = SwiffBenchGetTestMoviePaths([NSArray arrayWithObject:@"TestSuite.swf"]);
+
+    for (NSString *path in moviePaths) {
+        @autoreleasepool {
+            SwiffMovie *movie = SwiffBenchCreateMovie(path, SwiffMovieReadingOptionsNone);
+            if (!movie) continue;
+
+            CGRect stageRect   = [movie stageRect];
+            size_t width       = (size_t)ceil(stageRect.size.width  * sScale);
+            size_t height      = (size_t)ceil(stageRect.size.height * sScale);
+            size_t bytesPerRow = width * 4;
+            UInt8 *buffer      = malloc(bytesPerRow * height);
+
+            CGAffineTransform transform = CGAffineTransformMakeTranslation(-stageRect.origin.x, -stageRect.origin.y);
+            transform = CGAffineTransformConcat(transform, CGAffineTransformMakeScale(sScale, sScale));
+
+            SwiffRenderer *renderer = [[SwiffRenderer alloc] initWithMovie:movie];
+            [renderer setBaseAffineTransform:&transform];
+
+            NSUInteger frameCount = [[movie frames] count];
+            double     best[sMethodsCount];
+
+            for (NSUInteger m = 0; m < sMethodsCount; m++) {
+                best[m] = DBL_MAX;
+            }
+
+            for (NSUInteger pass = 0; pass < sPassCount; pass++) {
+                SwiffTimeline *timeline = [[SwiffTimeline alloc] initWithMovie:movie];
+                [renderer setTimeline:timeline];
+
+                double totals[sMethodsCount];
+                memset(totals, 0, sizeof(totals));
+
+                for (NSUInteger frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+                    @autoreleasepool {
+                        if (frameIndex) [timeline stepToFrameWithIndex:frameIndex];
+                        NSArray *placedObjects = [[timeline frame] placedObjects];
+
+                        for (NSUInteger m = 0; m < sMethodsCount; m++) {
+                            memset(buffer, 0, bytesPerRow * height);
+
+                            double start = SwiffBenchGetTime();
+
+                            if (m == 0) {
+                                [renderer renderPlacedObjects:placedObjects intoBuffer:buffer width:width height:height bytesPerRow:bytesPerRow];
+                            } else {
+                                [renderer renderPlacedObjects:placedObjects intoBuffer:buffer width:width height:height bytesPerRow:bytesPerRow tileSize:sTileSizes[m - 1]];
+                            }
+
+                            totals[m] += SwiffBenchGetTime() - start;
+                        }
+                    }
+                }
+
+                for (NSUInteger m = 0; m < sMethodsCount; m++) {
+                    best[m] = MIN(best[m], totals[m]);
+                }
+            }
+
+            free(buffer);
+
+            if (!frameCount) continue;
+
+            SwiffBenchPrint(@"%@: %ld x %ld pixels, %ld frames", [path lastPathComponent], (long)width, (long)height, (long)frameCount);
+            SwiffBenchPrint(@"    single-threaded  %8.2f ms/frame", (best[0] * 1000.0) / frameCount);
+
+            for (NSUInteger m = 1; m < sMethodsCount; m++) {
+                NSString *label = [NSString stringWithFormat:@"%ld x %ld tiles", (long)sTileSizes[m - 1], (long)sTileSizes[m - 1]];
+                SwiffBenchPrint(@"    %-16s %8.2f ms/frame  %5.2fx", [label UTF8String], (best[m] * 1000.0) / frameCount, best[0] / best[m]);
+            }
+        }
+    }
+}
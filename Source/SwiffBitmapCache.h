@@ -0,0 +1,61 @@
+/*
+    SwiffBitmapCache.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+#import <SwiffTypes.h>
+#import <SwiffLRUCache.h>
+
+
+// A least-recently-used cache of rasterized placed objects, limited by the size of their pixels.
+// SwiffRenderer uses it for placed objects with cachesAsBitmap, and optionally for complex sprites
+// which only move (see -[SwiffRenderer shouldCacheSlidingSprites]).  It also holds the 8-bit coverage
+// of clipping masks which are seen unchanged.  The cache does not interpret the pixels, their format
+// is up to the key.
+//
+// Entries are keyed by a key object compared with -isEqual:, which identifies the content and its
+// colors, plus the scale, rotation, and skew of the transform to device space.  The translation is
+// not part of the key.  When only it has changed, the cached pixels are reused at a new position,
+// rounded to whole pixels, as Flash Player does for cacheAsBitmap.
+//
+// byteLimit defaults to 8 MB.  Not thread-safe, use from one thread at a time.
+//
+@interface SwiffBitmapCache : SwiffLRUCache
+
+// Returns the pixels cached for key and the non-translation part of transform, or
+// nil on a miss.  On a hit, outRect is set to the device rect of the pixels for the translation of transform,
+// and outImage to the image added with them, or NULL.  The image is not retained for the caller.
+// On a miss, outWasMissed is set to whether key and transform missed before, and were not added since.
+- (NSData *) pixelsForKey:(id)key transform:(CGAffineTransform)transform rect:(CGRect *)outRect image:(CGImageRef *)outImage wasMissed:(BOOL *)outWasMissed;
+
+// rect is the integral device rect of pixels when drawn with transform.  image is optional, and should
+// read from pixels rather than hold a copy of them, as only pixels count toward byteLimit.
+// Pixels larger than byteLimit are not added
+- (void) addPixels:(NSData *)pixels image:(CGImageRef)image rect:(CGRect)rect forKey:(id)key transform:(CGAffineTransform)transform;
+
+- (void) removeAllPixels;
+
+@end
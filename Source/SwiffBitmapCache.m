@@ -0,0 +1,162 @@
+/*
+    SwiffBitmapCache.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffBitmapCache.h"
+
+static const NSUInteger sDefaultByteLimit = 8 * 1024 * 1024;
+
+// Keys which missed are remembered for the sliding sprite heuristic, up to this many
+static const NSUInteger sMaximumMissedCount = 256;
+
+
+@interface SwiffBitmapCacheEntry : SwiffLRUCacheEntry {
+@public
+    id                _key;
+    CGAffineTransform _transform;   // Only a, b, c, and d take part in equality
+    CGRect            _rect;
+    NSData           *_pixels;
+    CGImageRef        _image;
+}
+@end
+
+
+@implementation SwiffBitmapCacheEntry
+
+- (void) dealloc
+{
+    CGImageRelease(_image);
+}
+
+
+- (NSUInteger) hash
+{
+    return [_key hash] ^ (NSUInteger)lround(_transform.a * 1024) ^ ((NSUInteger)lround(_transform.d * 1024) << 16);
+}
+
+
+- (BOOL) isEqual:(id)otherObject
+{
+    if (![otherObject isKindOfClass:[SwiffBitmapCacheEntry class]]) return NO;
+
+    SwiffBitmapCacheEntry *other = otherObject;
+
+    if ((_transform.a != other->_transform.a) ||
+        (_transform.b != other->_transform.b) ||
+        (_transform.c != other->_transform.c) ||
+        (_transform.d != other->_transform.d))
+    {
+        return NO;
+    }
+
+    return (_key == other->_key) || [_key isEqual:other->_key];
+}
+
+@end
+
+
+@implementation SwiffBitmapCache {
+    NSMutableSet *_missedEntries;
+}
+
+
+- (id) init
+{
+    if ((self = [super initWithByteLimit:sDefaultByteLimit])) {
+        _missedEntries = [[NSMutableSet alloc] init];
+    }
+
+    return self;
+}
+
+
+- (NSData *) pixelsForKey:(id)key transform:(CGAffineTransform)transform rect:(CGRect *)outRect image:(CGImageRef *)outImage wasMissed:(BOOL *)outWasMissed
+{
+    if (!key) return nil;
+
+    SwiffBitmapCacheEntry *probe = [[SwiffBitmapCacheEntry alloc] init];
+    probe->_key = key;
+    probe->_transform = transform;
+
+    SwiffBitmapCacheEntry *entry = [self memberEntry:probe];
+
+    if (entry) {
+        [self hitEntry:entry];
+
+        if (outRect) {
+            CGRect rect = entry->_rect;
+            rect.origin.x += round(transform.tx) - round(entry->_transform.tx);
+            rect.origin.y += round(transform.ty) - round(entry->_transform.ty);
+            *outRect = rect;
+        }
+
+        if (outImage) {
+            *outImage = entry->_image;
+        }
+
+        return entry->_pixels;
+    }
+
+    if (outWasMissed) {
+        *outWasMissed = ([_missedEntries member:probe] != nil);
+    }
+
+    if ([_missedEntries count] >= sMaximumMissedCount) {
+        [_missedEntries removeAllObjects];
+    }
+
+    [_missedEntries addObject:probe];
+
+    [self miss];
+    return nil;
+}
+
+
+- (void) addPixels:(NSData *)pixels image:(CGImageRef)image rect:(CGRect)rect forKey:(id)key transform:(CGAffineTransform)transform
+{
+    if (!pixels || !key) return;
+
+    SwiffBitmapCacheEntry *entry = [[SwiffBitmapCacheEntry alloc] init];
+    entry->_key = key;
+    entry->_transform = transform;
+    entry->_rect = rect;
+    entry->_pixels = pixels;
+    entry->_image = CGImageRetain(image);
+    entry->_byteCount = [pixels length];
+
+    [_missedEntries removeObject:entry];
+    [self addEntry:entry];
+}
+
+
+- (void) removeAllPixels
+{
+    [self removeAllEntries];
+    [_missedEntries removeAllObjects];
+}
+
+
+@end
@@ -0,0 +1,47 @@
+/*
+    SwiffBlendProcessor.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+#import <SwiffTypes.h>
+
+
+// Composites premultiplied RGBA8 pixels (bytes in R, G, B, A order) with the SWF blend modes, as used by
+// the SwiffRasterizer and by the offscreen layers of SwiffRenderer.  The color channels are treated
+// alike, so BGRA pixels may also be used, as long as src and dst have the same order.
+//
+// Separable modes follow the premultiplied formulas of the W3C compositing spec.  Add and Subtract
+// clamp per channel.  Invert inverts dst where src is opaque, ignoring the color of src.  Alpha and
+// Erase multiply dst by the alpha (or the inverse alpha) of src.  SwiffBlendModeOther modes, which
+// only Core Graphics can draw, are composited as normal.
+//
+
+// Composites count pixels of src onto dst.  coverage, when non-NULL, is the 0-255 fraction by which
+// each dst pixel moves towards the blended result.  Pixels with 0 coverage are not touched
+extern void SwiffBlendModeCompositeSpan(SwiffBlendMode mode, UInt8 *dst, const UInt8 *src, const UInt8 *coverage, size_t count);
+
+// Returns NO for the modes which Core Graphics cannot draw: Subtract and Invert
+extern BOOL SwiffBlendModeGetCGBlendMode(SwiffBlendMode mode, CGBlendMode *outBlendMode);
@@ -0,0 +1,388 @@
+/*
+    SwiffBlendProcessor.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffBlendProcessor.h"
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#import <arm_neon.h>
+#define SWIFF_BLEND_SIMD_NEON 1
+#elif defined(__SSE2__)
+#import <emmintrin.h>
+#define SWIFF_BLEND_SIMD_SSE 1
+#endif
+
+
+#pragma mark -
+#pragma mark Vector Helpers
+
+// A pixel as four floats in R, G, B, A order, with values from 0 to 1
+
+#if SWIFF_BLEND_SIMD_NEON
+
+typedef float32x4_t SwiffBlendFloat4;
+
+static inline SwiffBlendFloat4 sFloat4Splat(float x)                                { return vdupq_n_f32(x);         }
+static inline SwiffBlendFloat4 sFloat4Add(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return vaddq_f32(x, y);        }
+static inline SwiffBlendFloat4 sFloat4Sub(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return vsubq_f32(x, y);        }
+static inline SwiffBlendFloat4 sFloat4Mul(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return vmulq_f32(x, y);        }
+static inline SwiffBlendFloat4 sFloat4Min(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return vminq_f32(x, y);        }
+static inline SwiffBlendFloat4 sFloat4Max(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return vmaxq_f32(x, y);        }
+static inline float            sFloat4GetAlpha(SwiffBlendFloat4 x)                   { return vgetq_lane_f32(x, 3);   }
+static inline SwiffBlendFloat4 sFloat4SetAlpha(SwiffBlendFloat4 x, float a)          { return vsetq_lane_f32(a, x, 3); }
+
+// For each lane, (x <= y) ? a : b
+static inline SwiffBlendFloat4 sFloat4SelectLessEqual(SwiffBlendFloat4 x, SwiffBlendFloat4 y, SwiffBlendFloat4 a, SwiffBlendFloat4 b)
+{
+    return vbslq_f32(vcleq_f32(x, y), a, b);
+}
+
+static inline SwiffBlendFloat4 sFloat4LoadRGBA8(const UInt8 *pixel)
+{
+    UInt32 rgba;
+    memcpy(&rgba, pixel, 4);
+
+    uint8x8_t bytes = vreinterpret_u8_u32(vdup_n_u32(rgba));
+    return vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes)))), 1.0f / 255.0f);
+}
+
+// Clamps to 0-1 and rounds
+static inline void sFloat4StoreRGBA8(UInt8 *pixel, SwiffBlendFloat4 x)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(0)), vdupq_n_f32(1));
+
+    uint16x4_t halfwords = vmovn_u32(vcvtnq_u32_f32(vmulq_n_f32(x, 255)));
+    uint8x8_t  bytes     = vmovn_u16(vcombine_u16(halfwords, halfwords));
+
+    UInt32 rgba = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    memcpy(pixel, &rgba, 4);
+}
+
+#elif SWIFF_BLEND_SIMD_SSE
+
+typedef __m128 SwiffBlendFloat4;
+
+static inline SwiffBlendFloat4 sFloat4Splat(float x)                                { return _mm_set1_ps(x);    }
+static inline SwiffBlendFloat4 sFloat4Add(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return _mm_add_ps(x, y);  }
+static inline SwiffBlendFloat4 sFloat4Sub(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return _mm_sub_ps(x, y);  }
+static inline SwiffBlendFloat4 sFloat4Mul(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return _mm_mul_ps(x, y);  }
+static inline SwiffBlendFloat4 sFloat4Min(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return _mm_min_ps(x, y);  }
+static inline SwiffBlendFloat4 sFloat4Max(SwiffBlendFloat4 x, SwiffBlendFloat4 y)    { return _mm_max_ps(x, y);  }
+static inline float            sFloat4GetAlpha(SwiffBlendFloat4 x)                   { return _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+static inline SwiffBlendFloat4 sFloat4SetAlpha(SwiffBlendFloat4 x, float a)
+{
+    __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+    return _mm_or_ps(_mm_and_ps(mask, _mm_set1_ps(a)), _mm_andnot_ps(mask, x));
+}
+
+// For each lane, (x <= y) ? a : b
+static inline SwiffBlendFloat4 sFloat4SelectLessEqual(SwiffBlendFloat4 x, SwiffBlendFloat4 y, SwiffBlendFloat4 a, SwiffBlendFloat4 b)
+{
+    __m128 mask = _mm_cmple_ps(x, y);
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline SwiffBlendFloat4 sFloat4LoadRGBA8(const UInt8 *pixel)
+{
+    UInt32 rgba;
+    memcpy(&rgba, pixel, 4);
+
+    __m128i zero = _mm_setzero_si128();
+    __m128i x    = _mm_cvtsi32_si128((int)rgba);
+
+    x = _mm_unpacklo_epi8(x, zero);
+    x = _mm_unpacklo_epi16(x, zero);
+
+    return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(1.0f / 255.0f));
+}
+
+// Clamps to 0-1 and rounds
+static inline void sFloat4StoreRGBA8(UInt8 *pixel, SwiffBlendFloat4 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1));
+
+    __m128i i = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(255)));
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+
+    UInt32 rgba = (UInt32)_mm_cvtsi128_si32(i);
+    memcpy(pixel, &rgba, 4);
+}
+
+#else
+
+typedef struct SwiffBlendFloat4 {
+    float v[4];
+} SwiffBlendFloat4;
+
+static inline SwiffBlendFloat4 sFloat4Make(float r, float g, float b, float a)
+{
+    SwiffBlendFloat4 result = {{ r, g, b, a }};
+    return result;
+}
+
+static inline SwiffBlendFloat4 sFloat4Splat(float x)
+{
+    return sFloat4Make(x, x, x, x);
+}
+
+static inline SwiffBlendFloat4 sFloat4Add(SwiffBlendFloat4 x, SwiffBlendFloat4 y)
+{
+    return sFloat4Make(x.v[0] + y.v[0], x.v[1] + y.v[1], x.v[2] + y.v[2], x.v[3] + y.v[3]);
+}
+
+static inline SwiffBlendFloat4 sFloat4Sub(SwiffBlendFloat4 x, SwiffBlendFloat4 y)
+{
+    return sFloat4Make(x.v[0] - y.v[0], x.v[1] - y.v[1], x.v[2] - y.v[2], x.v[3] - y.v[3]);
+}
+
+static inline SwiffBlendFloat4 sFloat4Mul(SwiffBlendFloat4 x, SwiffBlendFloat4 y)
+{
+    return sFloat4Make(x.v[0] * y.v[0], x.v[1] * y.v[1], x.v[2] * y.v[2], x.v[3] * y.v[3]);
+}
+
+static inline SwiffBlendFloat4 sFloat4Min(SwiffBlendFloat4 x, SwiffBlendFloat4 y)
+{
+    return sFloat4Make(MIN(x.v[0], y.v[0]), MIN(x.v[1], y.v[1]), MIN(x.v[2], y.v[2]), MIN(x.v[3], y.v[3]));
+}
+
+static inline SwiffBlendFloat4 sFloat4Max(SwiffBlendFloat4 x, SwiffBlendFloat4 y)
+{
+    return sFloat4Make(MAX(x.v[0], y.v[0]), MAX(x.v[1], y.v[1]), MAX(x.v[2], y.v[2]), MAX(x.v[3], y.v[3]));
+}
+
+static inline float sFloat4GetAlpha(SwiffBlendFloat4 x)
+{
+    return x.v[3];
+}
+
+static inline SwiffBlendFloat4 sFloat4SetAlpha(SwiffBlendFloat4 x, float a)
+{
+    x.v[3] = a;
+    return x;
+}
+
+// For each lane, (x <= y) ? a : b
+static inline SwiffBlendFloat4 sFloat4SelectLessEqual(SwiffBlendFloat4 x, SwiffBlendFloat4 y, SwiffBlendFloat4 a, SwiffBlendFloat4 b)
+{
+    SwiffBlendFloat4 result;
+
+    for (NSInteger i = 0; i < 4; i++) {
+        result.v[i] = (x.v[i] <= y.v[i]) ? a.v[i] : b.v[i];
+    }
+
+    return result;
+}
+
+static inline SwiffBlendFloat4 sFloat4LoadRGBA8(const UInt8 *pixel)
+{
+    const float scale = 1.0f / 255.0f;
+    return sFloat4Make(pixel[0] * scale, pixel[1] * scale, pixel[2] * scale, pixel[3] * scale);
+}
+
+// Clamps to 0-1 and rounds
+static inline void sFloat4StoreRGBA8(UInt8 *pixel, SwiffBlendFloat4 x)
+{
+    for (NSInteger i = 0; i < 4; i++) {
+        float value = x.v[i] * 255;
+        pixel[i] = (UInt8)lrintf(MAX(0, MIN(value, 255)));
+    }
+}
+
+#endif
+
+
+#pragma mark -
+#pragma mark Blending
+
+// The hard light term of the W3C spec, premultiplied: 2 * s * d where 2 * x <= xa, and
+// sa * da - 2 * (da - d) * (sa - s) elsewhere.  Overlay is hard light with the layers swapped,
+// which only changes which layer, x, picks the case
+static inline SwiffBlendFloat4 sHardLight(SwiffBlendFloat4 s, SwiffBlendFloat4 d, SwiffBlendFloat4 x, float sa, float da)
+{
+    SwiffBlendFloat4 two      = sFloat4Splat(2);
+    SwiffBlendFloat4 multiply = sFloat4Mul(two, sFloat4Mul(s, d));
+    SwiffBlendFloat4 screen   = sFloat4Sub(sFloat4Splat(sa * da), sFloat4Mul(two, sFloat4Mul(sFloat4Sub(sFloat4Splat(da), d), sFloat4Sub(sFloat4Splat(sa), s))));
+
+    return sFloat4SelectLessEqual(sFloat4Mul(two, x), sFloat4Splat(sFloat4GetAlpha(x)), multiply, screen);
+}
+
+
+static inline SwiffBlendFloat4 sBlend(SwiffBlendMode mode, SwiffBlendFloat4 s, SwiffBlendFloat4 d)
+{
+    float sa = sFloat4GetAlpha(s);
+    float da = sFloat4GetAlpha(d);
+
+    // The separable modes add the blended term B(s, d) to the parts of s and d outside of the other.
+    // For every one of them, the alpha of B is sa * da, which gives the union of the alphas
+    SwiffBlendFloat4 outside    = sFloat4Add(sFloat4Mul(s, sFloat4Splat(1 - da)), sFloat4Mul(d, sFloat4Splat(1 - sa)));
+    float            unionAlpha = (sa + da) - (sa * da);
+
+    switch (mode) {
+    case SwiffBlendModeMultiply:
+        return sFloat4Add(outside, sFloat4Mul(s, d));
+
+    case SwiffBlendModeScreen:
+        return sFloat4Sub(sFloat4Add(s, d), sFloat4Mul(s, d));
+
+    case SwiffBlendModeLighten:
+        return sFloat4Add(outside, sFloat4Max(sFloat4Mul(s, sFloat4Splat(da)), sFloat4Mul(d, sFloat4Splat(sa))));
+
+    case SwiffBlendModeDarken:
+        return sFloat4Add(outside, sFloat4Min(sFloat4Mul(s, sFloat4Splat(da)), sFloat4Mul(d, sFloat4Splat(sa))));
+
+    case SwiffBlendModeDifference: {
+        SwiffBlendFloat4 both = sFloat4Min(sFloat4Mul(s, sFloat4Splat(da)), sFloat4Mul(d, sFloat4Splat(sa)));
+        return sFloat4SetAlpha(sFloat4Sub(sFloat4Add(s, d), sFloat4Add(both, both)), unionAlpha);
+    }
+
+    case SwiffBlendModeOverlay:
+        return sFloat4SetAlpha(sFloat4Add(outside, sHardLight(s, d, d, sa, da)), unionAlpha);
+
+    case SwiffBlendModeHardlight:
+        return sFloat4SetAlpha(sFloat4Add(outside, sHardLight(s, d, s, sa, da)), unionAlpha);
+
+    case SwiffBlendModeAdd:
+        return sFloat4Min(sFloat4Add(s, d), sFloat4Splat(1));
+
+    case SwiffBlendModeSubtract:
+        return sFloat4SetAlpha(sFloat4Max(sFloat4Sub(d, s), sFloat4Splat(0)), unionAlpha);
+
+    case SwiffBlendModeInvert: {
+        SwiffBlendFloat4 inverted = sFloat4Sub(sFloat4Splat(da), d);
+        return sFloat4SetAlpha(sFloat4Add(sFloat4Mul(inverted, sFloat4Splat(sa)), sFloat4Mul(d, sFloat4Splat(1 - sa))), da);
+    }
+
+    case SwiffBlendModeAlpha:
+        return sFloat4Mul(d, sFloat4Splat(sa));
+
+    case SwiffBlendModeErase:
+        return sFloat4Mul(d, sFloat4Splat(1 - sa));
+
+    default:
+        return sFloat4Add(s, sFloat4Mul(d, sFloat4Splat(1 - sa)));
+    }
+}
+
+
+static inline void sCompositePixel(SwiffBlendMode mode, UInt8 *dst, const UInt8 *src, UInt32 coverage)
+{
+    if (!coverage) return;
+
+    // A transparent source pixel leaves dst unchanged in every mode but Alpha
+    if (!src[3] && (mode != SwiffBlendModeAlpha)) return;
+
+    SwiffBlendFloat4 s = sFloat4LoadRGBA8(src);
+    SwiffBlendFloat4 d = sFloat4LoadRGBA8(dst);
+    SwiffBlendFloat4 result = sBlend(mode, s, d);
+
+    if (coverage < 255) {
+        result = sFloat4Add(d, sFloat4Mul(sFloat4Sub(result, d), sFloat4Splat(coverage / 255.0f)));
+    }
+
+    sFloat4StoreRGBA8(dst, result);
+}
+
+
+// Add is a saturating add of every byte, done 16 bytes at a time where all four pixels are fully covered.
+// Returns the number of pixels composited
+static size_t sCompositeAddSpan(UInt8 *dst, const UInt8 *src, const UInt8 *coverage, size_t count)
+{
+    size_t i = 0;
+
+#if SWIFF_BLEND_SIMD_NEON || SWIFF_BLEND_SIMD_SSE
+    for ( ; (i + 4) <= count; i += 4) {
+        UInt32 c4 = 0xFFFFFFFF;
+        if (coverage) memcpy(&c4, &coverage[i], 4);
+
+        if (c4 != 0xFFFFFFFF) {
+            for (size_t j = i; j < (i + 4); j++) {
+                sCompositePixel(SwiffBlendModeAdd, &dst[j * 4], &src[j * 4], coverage[j]);
+            }
+
+            continue;
+        }
+
+#if SWIFF_BLEND_SIMD_NEON
+        vst1q_u8(&dst[i * 4], vqaddq_u8(vld1q_u8(&dst[i * 4]), vld1q_u8(&src[i * 4])));
+#else
+        __m128i s = _mm_loadu_si128((const __m128i *)&src[i * 4]);
+        __m128i d = _mm_loadu_si128((const __m128i *)&dst[i * 4]);
+        _mm_storeu_si128((__m128i *)&dst[i * 4], _mm_adds_epu8(d, s));
+#endif
+    }
+#endif
+
+    return i;
+}
+
+
+#pragma mark -
+#pragma mark Public Functions
+
+void SwiffBlendModeCompositeSpan(SwiffBlendMode mode, UInt8 *dst, const UInt8 *src, const UInt8 *coverage, size_t count)
+{
+    size_t i = 0;
+
+    if (mode == SwiffBlendModeAdd) {
+        i = sCompositeAddSpan(dst, src, coverage, count);
+    }
+
+    for ( ; i < count; i++) {
+        sCompositePixel(mode, &dst[i * 4], &src[i * 4], coverage ? coverage[i] : 255);
+    }
+}
+
+
+BOOL SwiffBlendModeGetCGBlendMode(SwiffBlendMode mode, CGBlendMode *outBlendMode)
+{
+    CGBlendMode blendMode;
+
+    switch (mode) {
+    case SwiffBlendModeMultiply:   blendMode = kCGBlendModeMultiply;        break;
+    case SwiffBlendModeScreen:     blendMode = kCGBlendModeScreen;          break;
+    case SwiffBlendModeLighten:    blendMode = kCGBlendModeLighten;         break;
+    case SwiffBlendModeDarken:     blendMode = kCGBlendModeDarken;          break;
+    case SwiffBlendModeDifference: blendMode = kCGBlendModeDifference;      break;
+    case SwiffBlendModeOverlay:    blendMode = kCGBlendModeOverlay;         break;
+    case SwiffBlendModeHardlight:  blendMode = kCGBlendModeHardLight;       break;
+    case SwiffBlendModeAdd:        blendMode = kCGBlendModePlusLighter;     break;
+    case SwiffBlendModeAlpha:      blendMode = kCGBlendModeDestinationIn;   break;
+    case SwiffBlendModeErase:      blendMode = kCGBlendModeDestinationOut;  break;
+
+    case SwiffBlendModeSubtract:
+    case SwiffBlendModeInvert:
+        return NO;
+
+    default:
+        blendMode = (mode >= SwiffBlendModeOther) ? (CGBlendMode)(mode - SwiffBlendModeOther) : kCGBlendModeNormal;
+        break;
+    }
+
+    if (outBlendMode) *outBlendMode = blendMode;
+    return YES;
+}
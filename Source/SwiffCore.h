@@ -37,21 +37,30 @@
 #import <SwiffSpriteDefinition.h>
 #import <SwiffStaticTextDefinition.h>
 
+#import <SwiffBitmapCache.h>
+#import <SwiffBlendProcessor.h>
+#import <SwiffDisplayList.h>
+#import <SwiffDisplayListCache.h>
 #import <SwiffFillStyle.h>
+#import <SwiffFilterProcessor.h>
 #import <SwiffFrame.h>
 #import <SwiffGradient.h>
 #import <SwiffHTMLToCoreTextConverter.h>
+#import <SwiffLRUCache.h>
 #import <SwiffLineStyle.h>
 #import <SwiffParser.h>
 #import <SwiffPath.h>
 #import <SwiffPlacedDynamicText.h>
 #import <SwiffPlacedObject.h>
 #import <SwiffPlayhead.h>
+#import <SwiffRasterizer.h>
 #import <SwiffRenderer.h>
 #import <SwiffStaticTextRecord.h>
+#import <SwiffTimeline.h>
 #import <SwiffWriter.h>
 
 #import <SwiffMovie.h>
+#import <SwiffMovieInfo.h>
 
 #import <SwiffLayer.h>
 #import <SwiffView.h>
@@ -0,0 +1,119 @@
+/*
+    SwiffDisplayList.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+#import <SwiffTypes.h>
+
+@class SwiffMovie, SwiffPlacedDynamicText;
+
+
+// A flat list of drawing commands, recorded by -[SwiffRenderer displayListForPlacedObjects:]
+// and replayed by -[SwiffRenderer renderDisplayList:inContext:].
+//
+// All traversal work is done during recording: definitions are looked up, transforms are
+// concatenated, and colors have the color transform stack, colorModificationTransform, and
+// colorModificationBlock applied.
+//
+typedef NS_ENUM(UInt8, SwiffDisplayListCommandType) {
+    // Drawing commands, which are skipped on replay when outside of the clip bounds
+    SwiffDisplayListCommandTypeStrokePath = 0,  // object is a SwiffPath with a line style, color is the stroke color
+    SwiffDisplayListCommandTypeFillPath,        // object is a SwiffPath with a fill style, see below for colors
+    SwiffDisplayListCommandTypeFillText,        // object is a CGPathRef of static text glyphs, color is the fill color
+    SwiffDisplayListCommandTypeDrawText,        // object is a CFAttributedStringRef of dynamic text, laid out in rect
+
+    // State commands, which are always replayed
+    SwiffDisplayListCommandTypeBeginClipPath,   // Following fills build the clipping path, and are not drawn.  transform
+                                                // is of the mask, rect is the bounds of the mask in the space of transform
+    SwiffDisplayListCommandTypeEndClipPath,
+    SwiffDisplayListCommandTypePushClip,        // Clips to the clipping path
+    SwiffDisplayListCommandTypePopClip,
+    SwiffDisplayListCommandTypePushBlendMode,
+    SwiffDisplayListCommandTypePopBlendMode,
+    SwiffDisplayListCommandTypeBeginLayer,      // Following commands draw offscreen.  object is an NSArray of SwiffFilter or NULL,
+                                                // rect is the bounds of the placed object in the space of transform.
+                                                // Skipped through the matching EndLayer when outside of the clip bounds
+    SwiffDisplayListCommandTypeEndLayer         // Applies the filters to the offscreen pixels and draws them with layerBlendMode
+};
+
+typedef struct SwiffDisplayListCommand {
+    SwiffDisplayListCommandType type;
+    CGBlendMode       blendMode;
+    SwiffBlendMode    layerBlendMode;   // For BeginLayer
+
+    // The final transform, to which the base transform of the replaying renderer is appended
+    CGAffineTransform transform;
+
+    // The render bounds of the placed object which produced the command, in the same space as transform.
+    // Drawing commands outside of the replay clip bounds are skipped
+    CGRect            bounds;
+
+    // For solid fills, the fill color.  For bitmap fills, only alpha is used
+    SwiffColor        color;
+
+    CFTypeRef         object;
+    CGRect            rect;
+
+    // For BeginLayer and BeginClipPath, non-NULL when the layer or the coverage of the clipping path may be drawn
+    // from a SwiffBitmapCache.  Compared with -isEqual:
+    CFTypeRef         cacheKey;
+
+    // For gradient fills.  Either may be NULL when the command is drawn directly rather than recorded
+    CGGradientRef     gradient;
+    UInt8            *gradientTable;  // UInt8[SwiffRasterizerGradientTableLength * 4]
+} SwiffDisplayListCommand;
+
+
+@class SwiffDisplayList;
+
+// Appends a copy of command to displayList.  The display list retains object, cacheKey, and gradient, and copies gradientTable
+extern void SwiffDisplayListAddCommand(SwiffDisplayList *displayList, const SwiffDisplayListCommand *command);
+
+// Notes that displayList contains the current text of placedDynamicText, see -isStale
+extern void SwiffDisplayListAddPlacedDynamicText(SwiffDisplayList *displayList, SwiffPlacedDynamicText *placedDynamicText);
+
+@interface SwiffDisplayList : NSObject
+
+- (id) initWithMovie:(SwiffMovie *)movie colorModificationTransform:(const SwiffColorTransform *)colorModificationTransform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock;
+
+// Weak, as the display list is usually owned by the movie through its SwiffDisplayListCache
+@property (nonatomic, weak, readonly) SwiffMovie *movie;
+
+// The colorModificationTransform (NULL if none) and colorModificationBlock which were applied to the recorded colors.
+// The block is not retained, and is only meant to be compared by identity
+@property (nonatomic, assign, readonly) const SwiffColorTransform *colorModificationTransform;
+@property (nonatomic, assign, readonly) SwiffColorModificationBlock colorModificationBlock;
+
+// YES once the text of a recorded SwiffPlacedDynamicText has changed
+@property (nonatomic, assign, readonly, getter=isStale) BOOL stale;
+
+// Approximate memory used by the commands
+@property (nonatomic, assign, readonly) NSUInteger byteCount;
+
+@property (nonatomic, assign, readonly) NSUInteger commandsCount;
+@property (nonatomic, assign, readonly) const SwiffDisplayListCommand *commands; // Inside pointer, valid until the next SwiffDisplayListAddCommand()
+
+@end
@@ -0,0 +1,160 @@
+/*
+    SwiffDisplayList.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffDisplayList.h"
+#import "SwiffPlacedDynamicText.h"
+#import "SwiffRasterizer.h"
+
+static const NSUInteger sMinimumCommandsCapacity = 64;
+
+// Rough size of the glyph outlines or attributed string of a text command.  SwiffPaths
+// belong to their shape definitions and are not counted.
+static const NSUInteger sApproximateTextByteCount = 512;
+
+
+@implementation SwiffDisplayList {
+    SwiffDisplayListCommand *_commands;
+    NSUInteger _commandsCapacity;
+    NSMutableArray *_placedDynamicTexts;
+    NSMutableArray *_attributedTexts;
+    SwiffColorTransform _colorModificationTransform;
+    BOOL _hasColorModificationTransform;
+}
+
+@synthesize movie                  = _movie,
+            colorModificationBlock = _colorModificationBlock,
+            commandsCount          = _commandsCount,
+            byteCount              = _byteCount;
+
+
+void SwiffDisplayListAddCommand(SwiffDisplayList *displayList, const SwiffDisplayListCommand *inCommand)
+{
+    if (displayList->_commandsCount == displayList->_commandsCapacity) {
+        displayList->_commandsCapacity = MAX(displayList->_commandsCapacity * 2, sMinimumCommandsCapacity);
+        displayList->_commands = realloc(displayList->_commands, sizeof(SwiffDisplayListCommand) * displayList->_commandsCapacity);
+    }
+
+    SwiffDisplayListCommand *command = &displayList->_commands[displayList->_commandsCount++];
+    *command = *inCommand;
+
+    if (command->object)   CFRetain(command->object);
+    if (command->cacheKey) CFRetain(command->cacheKey);
+    if (command->gradient) CGGradientRetain(command->gradient);
+
+    displayList->_byteCount += sizeof(SwiffDisplayListCommand);
+
+    if (command->gradientTable) {
+        size_t length = SwiffRasterizerGradientTableLength * 4;
+        command->gradientTable = malloc(length);
+        memcpy(command->gradientTable, inCommand->gradientTable, length);
+
+        displayList->_byteCount += length;
+    }
+
+    if ((command->type == SwiffDisplayListCommandTypeFillText) || (command->type == SwiffDisplayListCommandTypeDrawText)) {
+        displayList->_byteCount += sApproximateTextByteCount;
+    }
+}
+
+
+void SwiffDisplayListAddPlacedDynamicText(SwiffDisplayList *displayList, SwiffPlacedDynamicText *placedDynamicText)
+{
+    if (!displayList->_placedDynamicTexts) {
+        displayList->_placedDynamicTexts = [[NSMutableArray alloc] init];
+        displayList->_attributedTexts    = [[NSMutableArray alloc] init];
+    }
+
+    NSAttributedString *attributedText = [placedDynamicText attributedText];
+
+    [displayList->_placedDynamicTexts addObject:placedDynamicText];
+    [displayList->_attributedTexts    addObject:(attributedText ? attributedText : (id)[NSNull null])];
+}
+
+
+- (id) initWithMovie:(SwiffMovie *)movie colorModificationTransform:(const SwiffColorTransform *)colorModificationTransform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock
+{
+    if ((self = [super init])) {
+        _movie = movie;
+        _colorModificationBlock = colorModificationBlock;
+
+        if (colorModificationTransform) {
+            _colorModificationTransform = *colorModificationTransform;
+            _hasColorModificationTransform = YES;
+        }
+    }
+
+    return self;
+}
+
+
+- (void) dealloc
+{
+    for (NSUInteger i = 0; i < _commandsCount; i++) {
+        SwiffDisplayListCommand *command = &_commands[i];
+
+        if (command->object)        CFRelease(command->object);
+        if (command->cacheKey)      CFRelease(command->cacheKey);
+        if (command->gradient)      CGGradientRelease(command->gradient);
+        if (command->gradientTable) free(command->gradientTable);
+    }
+
+    free(_commands);
+    _commands = NULL;
+}
+
+
+- (const SwiffDisplayListCommand *) commands
+{
+    return _commands;
+}
+
+
+- (const SwiffColorTransform *) colorModificationTransform
+{
+    return _hasColorModificationTransform ? &_colorModificationTransform : NULL;
+}
+
+
+- (BOOL) isStale
+{
+    NSUInteger count = [_placedDynamicTexts count];
+
+    for (NSUInteger i = 0; i < count; i++) {
+        SwiffPlacedDynamicText *placedDynamicText = [_placedDynamicTexts objectAtIndex:i];
+        id attributedText = [placedDynamicText attributedText];
+
+        if ((attributedText ? attributedText : [NSNull null]) != [_attributedTexts objectAtIndex:i]) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+
+@end
@@ -0,0 +1,54 @@
+/*
+    SwiffDisplayListCache.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+#import <SwiffTypes.h>
+#import <SwiffLRUCache.h>
+
+@class SwiffDisplayList;
+
+
+// A least-recently-used cache of recorded display lists, limited by their -byteCount.
+//
+// Entries are keyed by the identity of a placed objects array, so frames which share
+// the same array (see -[SwiffFrame placedObjects]) share one entry, plus an optional
+// variant object compared with -isEqual:.  Display lists do not depend on the scale or
+// base transform they are replayed with, so these are not part of the key.
+//
+// byteLimit defaults to 4 MB.  Not thread-safe, use from one thread at a time.
+//
+@interface SwiffDisplayListCache : SwiffLRUCache
+
+// Returns nil on a miss.  Entries which are stale, or which were recorded with a different
+// colorModificationTransform or colorModificationBlock, are removed and count as misses.
+- (SwiffDisplayList *) displayListForPlacedObjects:(NSArray *)placedObjects variant:(id)variant colorModificationTransform:(const SwiffColorTransform *)colorModificationTransform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock;
+
+- (void) addDisplayList:(SwiffDisplayList *)displayList forPlacedObjects:(NSArray *)placedObjects variant:(id)variant;
+
+- (void) removeAllDisplayLists;
+
+@end
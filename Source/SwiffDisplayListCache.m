@@ -0,0 +1,121 @@
+/*
+    SwiffDisplayListCache.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SwiffDisplayListCache.h"
+#import "SwiffDisplayList.h"
+#import "SwiffUtils.h"
+
+static const NSUInteger sDefaultByteLimit = 4 * 1024 * 1024;
+
+
+@interface SwiffDisplayListCacheEntry : SwiffLRUCacheEntry {
+@public
+    NSArray          *_placedObjects;
+    id                _variant;
+    SwiffDisplayList *_displayList;
+}
+@end
+
+
+@implementation SwiffDisplayListCacheEntry
+
+- (NSUInteger) hash
+{
+    return (NSUInteger)(__bridge void *)_placedObjects ^ [_variant hash];
+}
+
+
+- (BOOL) isEqual:(id)otherObject
+{
+    if (![otherObject isKindOfClass:[SwiffDisplayListCacheEntry class]]) return NO;
+
+    SwiffDisplayListCacheEntry *other = otherObject;
+    if (_placedObjects != other->_placedObjects) return NO;
+
+    return (_variant == other->_variant) || [_variant isEqual:other->_variant];
+}
+
+@end
+
+
+@implementation SwiffDisplayListCache
+
+- (id) init
+{
+    return [super initWithByteLimit:sDefaultByteLimit];
+}
+
+
+- (SwiffDisplayList *) displayListForPlacedObjects:(NSArray *)placedObjects variant:(id)variant colorModificationTransform:(const SwiffColorTransform *)colorModificationTransform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock
+{
+    SwiffDisplayListCacheEntry *probe = [[SwiffDisplayListCacheEntry alloc] init];
+    probe->_placedObjects = placedObjects;
+    probe->_variant = variant;
+
+    SwiffDisplayListCacheEntry *entry = [self memberEntry:probe];
+
+    if (entry) {
+        SwiffDisplayList *displayList = entry->_displayList;
+
+        BOOL sameColors = ([displayList colorModificationBlock] == colorModificationBlock) &&
+                          SwiffColorTransformEqualToTransform([displayList colorModificationTransform], colorModificationTransform);
+
+        if (sameColors && ![displayList isStale]) {
+            [self hitEntry:entry];
+            return displayList;
+        }
+
+        [self removeEntry:entry];
+    }
+
+    [self miss];
+    return nil;
+}
+
+
+- (void) addDisplayList:(SwiffDisplayList *)displayList forPlacedObjects:(NSArray *)placedObjects variant:(id)variant
+{
+    if (!displayList || !placedObjects) return;
+
+    SwiffDisplayListCacheEntry *entry = [[SwiffDisplayListCacheEntry alloc] init];
+    entry->_placedObjects = placedObjects;
+    entry->_variant = variant;
+    entry->_displayList = displayList;
+    entry->_byteCount = [displayList byteCount];
+
+    [self addEntry:entry];
+}
+
+
+- (void) removeAllDisplayLists
+{
+    [self removeAllEntries];
+}
+
+
+@end
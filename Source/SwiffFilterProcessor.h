@@ -0,0 +1,42 @@
+/*
+    SwiffFilterProcessor.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+
+
+// Applies SwiffFilter effects to premultiplied RGBA8 pixels (bytes in R, G, B, A order, row 0 at the top),
+// as used by the SwiffRasterizer and by the offscreen layers of SwiffRenderer.
+//
+// Filter distances and blur sizes are in movie pixels, and are multiplied by scale.  Blurs are
+// separable box blurs, run numberOfPasses times.  Pixels outside of the buffer are transparent.
+//
+
+// Returns the distance, in pixels, by which the result of filters may extend past the pixels they are applied to
+extern CGSize SwiffFilterListGetOutset(NSArray *filters, CGFloat scale);
+
+// Applies each SwiffFilter in filters, in order
+extern void SwiffFilterListApply(NSArray *filters, UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow, CGFloat scale);
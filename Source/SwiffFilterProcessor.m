@@ -0,0 +1,786 @@
+/*
+    SwiffFilterProcessor.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffFilterProcessor.h"
+
+#import "SwiffFilter.h"
+#import "SwiffGradient.h"
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#import <arm_neon.h>
+#define SWIFF_FILTER_SIMD_NEON 1
+#elif defined(__SSE2__)
+#import <emmintrin.h>
+#define SWIFF_FILTER_SIMD_SSE 1
+#endif
+
+
+// Blur sizes are capped as in Flash Player, which limits blurX and blurY to 255
+static const size_t sMaximumBlurRadius = 512;
+
+enum {
+    SwiffFilterShadowTableLength = 256
+};
+
+// The drop shadow, glow, and bevel filters (and their gradient variants) share one implementation: a "value"
+// plane is computed from the shifted and blurred source alpha, mapped through table, and composited
+typedef struct SwiffFilterShadow {
+    UInt8      table[SwiffFilterShadowTableLength * 4];   // Premultiplied RGBA for each value
+    CGFloat    blurX;
+    CGFloat    blurY;
+    NSUInteger passes;
+    CGFloat    angle;
+    CGFloat    distance;
+    CGFloat    strength;
+    BOOL       isInner;
+    BOOL       isKnockout;
+    BOOL       isOnTop;
+    BOOL       isBevel;      // The value is the difference of two shifts, 128 is no effect
+} SwiffFilterShadow;
+
+
+#pragma mark -
+#pragma mark Vector Helpers
+
+// A pixel as four floats in R, G, B, A order, with values from 0 to 255
+
+#if SWIFF_FILTER_SIMD_NEON
+
+typedef float32x4_t SwiffFilterFloat4;
+
+static inline SwiffFilterFloat4 sFloat4Make(float r, float g, float b, float a)
+{
+    float values[4] = { r, g, b, a };
+    return vld1q_f32(values);
+}
+
+static inline SwiffFilterFloat4 sFloat4Splat(float x)                                         { return vdupq_n_f32(x);      }
+static inline SwiffFilterFloat4 sFloat4Add(SwiffFilterFloat4 x, SwiffFilterFloat4 y)           { return vaddq_f32(x, y);     }
+static inline SwiffFilterFloat4 sFloat4Mul(SwiffFilterFloat4 x, SwiffFilterFloat4 y)           { return vmulq_f32(x, y);     }
+static inline SwiffFilterFloat4 sFloat4MulAdd(SwiffFilterFloat4 acc, SwiffFilterFloat4 x, float s) { return vmlaq_n_f32(acc, x, s); }
+static inline float             sFloat4GetAlpha(SwiffFilterFloat4 x)                           { return vgetq_lane_f32(x, 3); }
+
+static inline SwiffFilterFloat4 sFloat4LoadUInt32(const UInt32 *values)
+{
+    return vcvtq_f32_u32(vld1q_u32(values));
+}
+
+static inline SwiffFilterFloat4 sFloat4LoadRGBA8(const UInt8 *pixel)
+{
+    UInt32 rgba;
+    memcpy(&rgba, pixel, 4);
+
+    uint8x8_t bytes = vreinterpret_u8_u32(vdup_n_u32(rgba));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes))));
+}
+
+// Clamps to 0-255 and rounds
+static inline void sFloat4StoreRGBA8(UInt8 *pixel, SwiffFilterFloat4 x)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(0)), vdupq_n_f32(255));
+
+    uint16x4_t halfwords = vmovn_u32(vcvtnq_u32_f32(x));
+    uint8x8_t  bytes     = vmovn_u16(vcombine_u16(halfwords, halfwords));
+
+    UInt32 rgba = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    memcpy(pixel, &rgba, 4);
+}
+
+#elif SWIFF_FILTER_SIMD_SSE
+
+typedef __m128 SwiffFilterFloat4;
+
+static inline SwiffFilterFloat4 sFloat4Make(float r, float g, float b, float a)                    { return _mm_setr_ps(r, g, b, a); }
+static inline SwiffFilterFloat4 sFloat4Splat(float x)                                              { return _mm_set1_ps(x);          }
+static inline SwiffFilterFloat4 sFloat4Add(SwiffFilterFloat4 x, SwiffFilterFloat4 y)                { return _mm_add_ps(x, y);        }
+static inline SwiffFilterFloat4 sFloat4Mul(SwiffFilterFloat4 x, SwiffFilterFloat4 y)                { return _mm_mul_ps(x, y);        }
+static inline SwiffFilterFloat4 sFloat4MulAdd(SwiffFilterFloat4 acc, SwiffFilterFloat4 x, float s) { return _mm_add_ps(acc, _mm_mul_ps(x, _mm_set1_ps(s))); }
+static inline float             sFloat4GetAlpha(SwiffFilterFloat4 x)                                { return _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+static inline SwiffFilterFloat4 sFloat4LoadUInt32(const UInt32 *values)
+{
+    return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)values));
+}
+
+static inline SwiffFilterFloat4 sFloat4LoadRGBA8(const UInt8 *pixel)
+{
+    UInt32 rgba;
+    memcpy(&rgba, pixel, 4);
+
+    __m128i zero = _mm_setzero_si128();
+    __m128i x    = _mm_cvtsi32_si128((int)rgba);
+
+    x = _mm_unpacklo_epi8(x, zero);
+    x = _mm_unpacklo_epi16(x, zero);
+
+    return _mm_cvtepi32_ps(x);
+}
+
+// Clamps to 0-255 and rounds
+static inline void sFloat4StoreRGBA8(UInt8 *pixel, SwiffFilterFloat4 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(255));
+
+    __m128i i = _mm_cvtps_epi32(x);
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+
+    UInt32 rgba = (UInt32)_mm_cvtsi128_si32(i);
+    memcpy(pixel, &rgba, 4);
+}
+
+#else
+
+typedef struct SwiffFilterFloat4 {
+    float v[4];
+} SwiffFilterFloat4;
+
+static inline SwiffFilterFloat4 sFloat4Make(float r, float g, float b, float a)
+{
+    SwiffFilterFloat4 result = {{ r, g, b, a }};
+    return result;
+}
+
+static inline SwiffFilterFloat4 sFloat4Splat(float x)
+{
+    return sFloat4Make(x, x, x, x);
+}
+
+static inline SwiffFilterFloat4 sFloat4Add(SwiffFilterFloat4 x, SwiffFilterFloat4 y)
+{
+    return sFloat4Make(x.v[0] + y.v[0], x.v[1] + y.v[1], x.v[2] + y.v[2], x.v[3] + y.v[3]);
+}
+
+static inline SwiffFilterFloat4 sFloat4Mul(SwiffFilterFloat4 x, SwiffFilterFloat4 y)
+{
+    return sFloat4Make(x.v[0] * y.v[0], x.v[1] * y.v[1], x.v[2] * y.v[2], x.v[3] * y.v[3]);
+}
+
+static inline SwiffFilterFloat4 sFloat4MulAdd(SwiffFilterFloat4 acc, SwiffFilterFloat4 x, float s)
+{
+    return sFloat4Make(acc.v[0] + (x.v[0] * s), acc.v[1] + (x.v[1] * s), acc.v[2] + (x.v[2] * s), acc.v[3] + (x.v[3] * s));
+}
+
+static inline float sFloat4GetAlpha(SwiffFilterFloat4 x)
+{
+    return x.v[3];
+}
+
+static inline SwiffFilterFloat4 sFloat4LoadUInt32(const UInt32 *values)
+{
+    return sFloat4Make(values[0], values[1], values[2], values[3]);
+}
+
+static inline SwiffFilterFloat4 sFloat4LoadRGBA8(const UInt8 *pixel)
+{
+    return sFloat4Make(pixel[0], pixel[1], pixel[2], pixel[3]);
+}
+
+// Clamps to 0-255 and rounds
+static inline void sFloat4StoreRGBA8(UInt8 *pixel, SwiffFilterFloat4 x)
+{
+    for (NSInteger i = 0; i < 4; i++) {
+        float f = x.v[i];
+        pixel[i] = (f <= 0) ? 0 : ((f >= 255) ? 255 : (UInt8)(f + 0.5f));
+    }
+}
+
+#endif
+
+
+// sums[0..4) += add[0..4) - subtract[0..4)
+static inline void sSlide4(UInt32 *sums, const UInt8 *add, const UInt8 *subtract)
+{
+#if SWIFF_FILTER_SIMD_NEON
+    UInt32 a, s;
+    memcpy(&a, add, 4);
+    memcpy(&s, subtract, 4);
+
+    uint32x4_t a32 = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(a)))));
+    uint32x4_t s32 = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(s)))));
+
+    vst1q_u32(sums, vsubq_u32(vaddq_u32(vld1q_u32(sums), a32), s32));
+
+#elif SWIFF_FILTER_SIMD_SSE
+    UInt32 a, s;
+    memcpy(&a, add, 4);
+    memcpy(&s, subtract, 4);
+
+    __m128i zero = _mm_setzero_si128();
+    __m128i a32  = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)a), zero), zero);
+    __m128i s32  = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)s), zero), zero);
+    __m128i x    = _mm_loadu_si128((const __m128i *)sums);
+
+    _mm_storeu_si128((__m128i *)sums, _mm_sub_epi32(_mm_add_epi32(x, a32), s32));
+
+#else
+    for (NSInteger i = 0; i < 4; i++) {
+        sums[i] += add[i] - subtract[i];
+    }
+#endif
+}
+
+
+static inline void sStoreAverage4(UInt8 *out, const UInt32 *sums, float reciprocal)
+{
+    sFloat4StoreRGBA8(out, sFloat4Mul(sFloat4LoadUInt32(sums), sFloat4Splat(reciprocal)));
+}
+
+
+static void sSlideRow(UInt32 *sums, const UInt8 *add, const UInt8 *subtract, size_t length)
+{
+    size_t i = 0;
+
+    for ( ; (i + 4) <= length; i += 4) {
+        sSlide4(&sums[i], &add[i], &subtract[i]);
+    }
+
+    for ( ; i < length; i++) {
+        sums[i] += add[i] - subtract[i];
+    }
+}
+
+
+static void sStoreAverageRow(UInt8 *out, const UInt32 *sums, float reciprocal, size_t length)
+{
+    size_t i = 0;
+
+    for ( ; (i + 4) <= length; i += 4) {
+        sStoreAverage4(&out[i], &sums[i], reciprocal);
+    }
+
+    for ( ; i < length; i++) {
+        out[i] = (UInt8)((sums[i] * reciprocal) + 0.5f);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Blur
+
+static size_t sGetBlurRadius(CGFloat blur, CGFloat scale)
+{
+    CGFloat radius = floor((blur * scale) / 2);
+
+    if (radius <= 0) return 0;
+    return MIN((size_t)radius, sMaximumBlurRadius);
+}
+
+
+// Box blurs pixels (with channels bytes per pixel) passes times.  Each pass is a horizontal then a vertical
+// running sum, so the cost per pixel does not depend on the radius
+static void sBoxBlur(UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow, size_t channels, size_t radiusX, size_t radiusY, NSUInteger passes)
+{
+    if (!width || !height || !passes || (!radiusX && !radiusY)) return;
+
+    size_t rowLength    = width * channels;
+    size_t windowX      = (2 * radiusX) + 1;
+    size_t paddedLength = (width + windowX) * channels;
+
+    // padded is radiusX transparent pixels, a row, then radiusX + 1 transparent pixels
+    UInt8  *padded  = calloc(paddedLength, 1);
+    UInt8  *rows    = malloc(rowLength * height);
+    UInt8  *zeroRow = calloc(rowLength, 1);
+    UInt32 *sums    = malloc(rowLength * sizeof(UInt32));
+
+    float reciprocalX = 1.0f / windowX;
+    float reciprocalY = 1.0f / ((2 * radiusY) + 1);
+
+    for (NSUInteger pass = 0; pass < passes; pass++) {
+        if (radiusX) {
+            for (size_t y = 0; y < height; y++) {
+                UInt8 *row = pixels + (y * bytesPerRow);
+                memcpy(padded + (radiusX * channels), row, rowLength);
+
+                memset(sums, 0, channels * sizeof(UInt32));
+                for (size_t i = 0; i < (windowX * channels); i++) {
+                    sums[i % channels] += padded[i];
+                }
+
+                for (size_t x = 0; x < width; x++) {
+                    UInt8       *out      = row    + (x * channels);
+                    const UInt8 *add      = padded + ((x + windowX) * channels);
+                    const UInt8 *subtract = padded + (x * channels);
+
+                    if (channels == 4) {
+                        sStoreAverage4(out, sums, reciprocalX);
+                        sSlide4(sums, add, subtract);
+
+                    } else {
+                        for (size_t c = 0; c < channels; c++) {
+                            out[c] = (UInt8)((sums[c] * reciprocalX) + 0.5f);
+                            sums[c] += add[c] - subtract[c];
+                        }
+                    }
+                }
+            }
+        }
+
+        if (radiusY) {
+            for (size_t y = 0; y < height; y++) {
+                memcpy(rows + (y * rowLength), pixels + (y * bytesPerRow), rowLength);
+            }
+
+            memset(sums, 0, rowLength * sizeof(UInt32));
+            for (size_t y = 0; (y <= radiusY) && (y < height); y++) {
+                sSlideRow(sums, rows + (y * rowLength), zeroRow, rowLength);
+            }
+
+            for (size_t y = 0; y < height; y++) {
+                sStoreAverageRow(pixels + (y * bytesPerRow), sums, reciprocalY, rowLength);
+
+                const UInt8 *add      = ((y + radiusY + 1) < height) ? (rows + ((y + radiusY + 1) * rowLength)) : zeroRow;
+                const UInt8 *subtract = (y >= radiusY)               ? (rows + ((y - radiusY)     * rowLength)) : zeroRow;
+
+                sSlideRow(sums, add, subtract, rowLength);
+            }
+        }
+    }
+
+    free(padded);
+    free(rows);
+    free(zeroRow);
+    free(sums);
+}
+
+
+#pragma mark -
+#pragma mark Color Matrix and Convolution
+
+static inline SwiffFilterFloat4 sLoadUnpremultiplied(const UInt8 *pixel)
+{
+    float alpha = pixel[3];
+    float k     = alpha ? (255.0f / alpha) : 0;
+
+    return sFloat4Mul(sFloat4LoadRGBA8(pixel), sFloat4Make(k, k, k, 1));
+}
+
+
+static inline void sStorePremultiplied(UInt8 *pixel, SwiffFilterFloat4 color)
+{
+    float alpha = sFloat4GetAlpha(color);
+    float k     = (alpha <= 0) ? 0 : ((alpha >= 255) ? 1 : (alpha / 255.0f));
+
+    sFloat4StoreRGBA8(pixel, sFloat4Mul(color, sFloat4Make(k, k, k, 1)));
+}
+
+
+// matrix is the 4x5 row-major matrix of a SwiffColorMatrixFilter, applied to unpremultiplied 0-255 values
+static void sApplyColorMatrix(const float *m, UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow)
+{
+    SwiffFilterFloat4 columnR = sFloat4Make(m[0], m[5], m[10], m[15]);
+    SwiffFilterFloat4 columnG = sFloat4Make(m[1], m[6], m[11], m[16]);
+    SwiffFilterFloat4 columnB = sFloat4Make(m[2], m[7], m[12], m[17]);
+    SwiffFilterFloat4 columnA = sFloat4Make(m[3], m[8], m[13], m[18]);
+    SwiffFilterFloat4 offset  = sFloat4Make(m[4], m[9], m[14], m[19]);
+
+    for (size_t y = 0; y < height; y++) {
+        UInt8 *pixel = pixels + (y * bytesPerRow);
+
+        for (size_t x = 0; x < width; x++, pixel += 4) {
+            float alpha = pixel[3];
+            float k     = alpha ? (255.0f / alpha) : 0;
+
+            SwiffFilterFloat4 result = offset;
+            result = sFloat4MulAdd(result, columnR, pixel[0] * k);
+            result = sFloat4MulAdd(result, columnG, pixel[1] * k);
+            result = sFloat4MulAdd(result, columnB, pixel[2] * k);
+            result = sFloat4MulAdd(result, columnA, alpha);
+
+            sStorePremultiplied(pixel, result);
+        }
+    }
+}
+
+
+static void sApplyConvolution(SwiffConvolutionFilter *filter, UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow)
+{
+    size_t matrixWidth  = [filter matrixWidth];
+    size_t matrixHeight = [filter matrixHeight];
+    const float *matrix = [filter matrixValues];
+
+    if (!matrixWidth || !matrixHeight || !matrix) return;
+
+    float divisor    = [filter divisor];
+    float reciprocal = divisor ? (1.0f / divisor) : 1.0f;
+    BOOL  clamp      = [filter isClamp];
+    BOOL  preserves  = [filter preservesAlpha];
+
+    SwiffColor color = [filter color];
+    SwiffFilterFloat4 outside = sFloat4Make(color.red * 255, color.green * 255, color.blue * 255, color.alpha * 255);
+    SwiffFilterFloat4 bias    = sFloat4Splat([filter bias]);
+    SwiffFilterFloat4 rgbMask = sFloat4Make(1, 1, 1, 0);
+
+    // Unpremultiplied copy of pixels, surrounded by the edge handling of the filter
+    NSInteger originX      = matrixWidth  / 2;
+    NSInteger originY      = matrixHeight / 2;
+    size_t    paddedWidth  = width  + matrixWidth  - 1;
+    size_t    paddedHeight = height + matrixHeight - 1;
+
+    SwiffFilterFloat4 *padded = malloc(paddedWidth * paddedHeight * sizeof(SwiffFilterFloat4));
+
+    for (size_t py = 0; py < paddedHeight; py++) {
+        for (size_t px = 0; px < paddedWidth; px++) {
+            NSInteger sx = (NSInteger)px - originX;
+            NSInteger sy = (NSInteger)py - originY;
+            BOOL isInside = (sx >= 0) && (sy >= 0) && (sx < (NSInteger)width) && (sy < (NSInteger)height);
+
+            if (!isInside && clamp) {
+                sx = MAX(0, MIN(sx, (NSInteger)width  - 1));
+                sy = MAX(0, MIN(sy, (NSInteger)height - 1));
+                isInside = YES;
+            }
+
+            padded[(py * paddedWidth) + px] = isInside ? sLoadUnpremultiplied(pixels + (sy * bytesPerRow) + (sx * 4)) : outside;
+        }
+    }
+
+    for (size_t y = 0; y < height; y++) {
+        UInt8 *pixel = pixels + (y * bytesPerRow);
+
+        for (size_t x = 0; x < width; x++, pixel += 4) {
+            SwiffFilterFloat4 sum = sFloat4Splat(0);
+
+            for (size_t ky = 0; ky < matrixHeight; ky++) {
+                const SwiffFilterFloat4 *source = &padded[((y + ky) * paddedWidth) + x];
+                const float             *row    = &matrix[ky * matrixWidth];
+
+                for (size_t kx = 0; kx < matrixWidth; kx++) {
+                    sum = sFloat4MulAdd(sum, source[kx], row[kx]);
+                }
+            }
+
+            sum = sFloat4Add(sFloat4Mul(sum, sFloat4Splat(reciprocal)), bias);
+
+            if (preserves) {
+                sum = sFloat4Add(sFloat4Mul(sum, rgbMask), sFloat4Make(0, 0, 0, pixel[3]));
+            }
+
+            sStorePremultiplied(pixel, sum);
+        }
+    }
+
+    free(padded);
+}
+
+
+#pragma mark -
+#pragma mark Shadows, Glows, and Bevels
+
+static inline UInt32 sDiv255(UInt32 x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+
+static void sPremultiplyColor(SwiffColor color, CGFloat scale, UInt8 *outRGBA)
+{
+    CGFloat alpha = color.alpha * scale;
+
+    outRGBA[0] = (UInt8)((color.red   * alpha * 255) + 0.5);
+    outRGBA[1] = (UInt8)((color.green * alpha * 255) + 0.5);
+    outRGBA[2] = (UInt8)((color.blue  * alpha * 255) + 0.5);
+    outRGBA[3] = (UInt8)((alpha * 255) + 0.5);
+}
+
+
+// Fills the table of a shadow or glow, which is color with its alpha ramped by the value
+static void sFillColorTable(UInt8 *table, SwiffColor color)
+{
+    for (NSInteger i = 0; i < SwiffFilterShadowTableLength; i++) {
+        sPremultiplyColor(color, i / 255.0, &table[i * 4]);
+    }
+}
+
+
+// Fills the table of a bevel.  Values below 128 are shadow, values above are highlight
+static void sFillBevelTable(UInt8 *table, SwiffColor shadowColor, SwiffColor highlightColor)
+{
+    for (NSInteger i = 0; i < SwiffFilterShadowTableLength; i++) {
+        if (i < 128) {
+            sPremultiplyColor(shadowColor, (128 - i) / 128.0, &table[i * 4]);
+        } else {
+            sPremultiplyColor(highlightColor, (i - 128) / 127.0, &table[i * 4]);
+        }
+    }
+}
+
+
+// Returns NO if filter is not a shadow, glow, or bevel.  The table is only filled when shouldFillTable is YES
+static BOOL sMakeShadow(SwiffFilter *filter, SwiffFilterShadow *outShadow, BOOL shouldFillTable)
+{
+    memset(outShadow, 0, sizeof(SwiffFilterShadow));
+
+    if ([filter isKindOfClass:[SwiffDropShadowFilter class]]) {
+        SwiffDropShadowFilter *f = (SwiffDropShadowFilter *)filter;
+
+        outShadow->blurX      = [f blurX];
+        outShadow->blurY      = [f blurY];
+        outShadow->passes     = [f numberOfPasses];
+        outShadow->angle      = [f angle];
+        outShadow->distance   = [f distance];
+        outShadow->strength   = [f strength];
+        outShadow->isInner    = [f isInnerShadow];
+        outShadow->isKnockout = [f isKnockout];
+
+        if (shouldFillTable) sFillColorTable(outShadow->table, [f color]);
+
+    } else if ([filter isKindOfClass:[SwiffGlowFilter class]]) {
+        SwiffGlowFilter *f = (SwiffGlowFilter *)filter;
+
+        outShadow->blurX      = [f blurX];
+        outShadow->blurY      = [f blurY];
+        outShadow->passes     = [f numberOfPasses];
+        outShadow->strength   = [f strength];
+        outShadow->isInner    = [f isInnerGlow];
+        outShadow->isKnockout = [f isKnockout];
+
+        if (shouldFillTable) sFillColorTable(outShadow->table, [f color]);
+
+    } else if ([filter isKindOfClass:[SwiffBevelFilter class]]) {
+        SwiffBevelFilter *f = (SwiffBevelFilter *)filter;
+
+        outShadow->blurX      = [f blurX];
+        outShadow->blurY      = [f blurY];
+        outShadow->passes     = [f numberOfPasses];
+        outShadow->angle      = [f angle];
+        outShadow->distance   = [f distance];
+        outShadow->strength   = [f strength];
+        outShadow->isInner    = [f isInnerShadow];
+        outShadow->isKnockout = [f isKnockout];
+        outShadow->isOnTop    = [f isOnTop];
+        outShadow->isBevel    = YES;
+
+        if (shouldFillTable) sFillBevelTable(outShadow->table, [f shadowColor], [f highlightColor]);
+
+    } else if ([filter isKindOfClass:[SwiffGradientGlowFilter class]]) {
+        SwiffGradientGlowFilter *f = (SwiffGradientGlowFilter *)filter;
+
+        outShadow->blurX      = [f blurX];
+        outShadow->blurY      = [f blurY];
+        outShadow->passes     = [f numberOfPasses];
+        outShadow->angle      = [f angle];
+        outShadow->distance   = [f distance];
+        outShadow->strength   = [f strength];
+        outShadow->isInner    = [f isInnerGlow];
+        outShadow->isKnockout = [f isKnockout];
+        outShadow->isOnTop    = [f isOnTop];
+
+        if (shouldFillTable) [[f gradient] getRGBA8Table:outShadow->table length:SwiffFilterShadowTableLength composedColorTransform:NULL colorModificationBlock:NULL];
+
+    } else if ([filter isKindOfClass:[SwiffGradientBevelFilter class]]) {
+        SwiffGradientBevelFilter *f = (SwiffGradientBevelFilter *)filter;
+
+        outShadow->blurX      = [f blurX];
+        outShadow->blurY      = [f blurY];
+        outShadow->passes     = [f numberOfPasses];
+        outShadow->angle      = [f angle];
+        outShadow->distance   = [f distance];
+        outShadow->strength   = [f strength];
+        outShadow->isInner    = [f isInnerShadow];
+        outShadow->isKnockout = [f isKnockout];
+        outShadow->isOnTop    = [f isOnTop];
+        outShadow->isBevel    = YES;
+
+        if (shouldFillTable) [[f gradient] getRGBA8Table:outShadow->table length:SwiffFilterShadowTableLength composedColorTransform:NULL colorModificationBlock:NULL];
+
+    } else {
+        return NO;
+    }
+
+    return YES;
+}
+
+
+// out(x, y) = in(x - dx, y - dy), or fill where that is outside of in
+static void sShiftPlane(const UInt8 *in, UInt8 *out, size_t width, size_t height, NSInteger dx, NSInteger dy, UInt8 fill)
+{
+    NSInteger w = width, h = height;
+
+    NSInteger x0 = MAX(0, MIN(dx,     w));
+    NSInteger x1 = MAX(0, MIN(w + dx, w));
+
+    for (NSInteger y = 0; y < h; y++) {
+        UInt8    *outRow = out + (y * w);
+        NSInteger sy     = y - dy;
+
+        if ((sy < 0) || (sy >= h) || (x0 >= x1)) {
+            memset(outRow, fill, w);
+            continue;
+        }
+
+        memset(outRow, fill, x0);
+        memcpy(outRow + x0, in + (sy * w) + (x0 - dx), x1 - x0);
+        memset(outRow + x1, fill, w - x1);
+    }
+}
+
+
+static void sApplyShadow(const SwiffFilterShadow *shadow, UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow, CGFloat scale)
+{
+    size_t   count   = width * height;
+    size_t   radiusX = sGetBlurRadius(shadow->blurX, scale);
+    size_t   radiusY = sGetBlurRadius(shadow->blurY, scale);
+    NSInteger dx     = lround(cos(shadow->angle) * shadow->distance * scale);
+    NSInteger dy     = lround(sin(shadow->angle) * shadow->distance * scale);
+    CGFloat  strength = shadow->strength;
+
+    if (strength <= 0) return;
+
+    UInt8 *alpha = malloc(count);
+    UInt8 *value = malloc(count);
+
+    for (size_t y = 0; y < height; y++) {
+        const UInt8 *row = pixels + (y * bytesPerRow);
+
+        for (size_t x = 0; x < width; x++) {
+            alpha[(y * width) + x] = row[(x * 4) + 3];
+        }
+    }
+
+    if (shadow->isBevel) {
+        // The highlight faces the light, which comes from the opposite direction of the shadow
+        UInt8 *lit = malloc(count);
+
+        sShiftPlane(alpha, lit,   width, height, -dx, -dy, 0);
+        sShiftPlane(alpha, value, width, height,  dx,  dy, 0);
+
+        sBoxBlur(lit,   width, height, width, 1, radiusX, radiusY, shadow->passes);
+        sBoxBlur(value, width, height, width, 1, radiusX, radiusY, shadow->passes);
+
+        for (size_t i = 0; i < count; i++) {
+            CGFloat v = 128 + (((CGFloat)lit[i] - (CGFloat)value[i]) * strength * 0.5);
+            value[i] = (v <= 0) ? 0 : ((v >= 255) ? 255 : (UInt8)(v + 0.5));
+        }
+
+        free(lit);
+
+    } else {
+        sShiftPlane(alpha, value, width, height, dx, dy, 0);
+
+        // Inner shadows and glows are cast by the transparent area, including everything outside of the buffer
+        if (shadow->isInner) {
+            for (size_t i = 0; i < count; i++) {
+                value[i] = 255 - value[i];
+            }
+        }
+
+        sBoxBlur(value, width, height, width, 1, radiusX, radiusY, shadow->passes);
+
+        for (size_t i = 0; i < count; i++) {
+            CGFloat v = value[i] * strength;
+            value[i] = (v >= 255) ? 255 : (UInt8)(v + 0.5);
+        }
+    }
+
+    for (size_t y = 0; y < height; y++) {
+        UInt8       *s = pixels + (y * bytesPerRow);
+        const UInt8 *v = value  + (y * width);
+
+        for (size_t x = 0; x < width; x++, s += 4) {
+            const UInt8 *c  = &shadow->table[v[x] * 4];
+            UInt32       sa = s[3];
+            UInt32       ca = c[3];
+
+            for (NSInteger channel = 0; channel < 4; channel++) {
+                UInt32 result;
+
+                if (shadow->isOnTop) {
+                    // Effect over the source
+                    result = c[channel] + (shadow->isKnockout ? 0 : sDiv255(s[channel] * (255 - ca)));
+
+                } else if (shadow->isInner) {
+                    // Effect atop the source
+                    result = sDiv255(c[channel] * sa) + (shadow->isKnockout ? 0 : sDiv255(s[channel] * (255 - ca)));
+
+                } else {
+                    // Source over the effect
+                    result = sDiv255(c[channel] * (255 - sa)) + (shadow->isKnockout ? 0 : s[channel]);
+                }
+
+                s[channel] = (result > 255) ? 255 : result;
+            }
+        }
+    }
+
+    free(alpha);
+    free(value);
+}
+
+
+#pragma mark -
+#pragma mark Public Functions
+
+CGSize SwiffFilterListGetOutset(NSArray *filters, CGFloat scale)
+{
+    CGSize result = CGSizeZero;
+
+    for (SwiffFilter *filter in filters) {
+        SwiffFilterShadow shadow;
+
+        if ([filter isKindOfClass:[SwiffBlurFilter class]]) {
+            SwiffBlurFilter *blur = (SwiffBlurFilter *)filter;
+
+            result.width  += sGetBlurRadius([blur blurX], scale) * [blur numberOfPasses];
+            result.height += sGetBlurRadius([blur blurY], scale) * [blur numberOfPasses];
+
+        } else if (sMakeShadow(filter, &shadow, NO)) {
+            result.width  += (sGetBlurRadius(shadow.blurX, scale) * shadow.passes) + ceil(fabs(cos(shadow.angle) * shadow.distance * scale));
+            result.height += (sGetBlurRadius(shadow.blurY, scale) * shadow.passes) + ceil(fabs(sin(shadow.angle) * shadow.distance * scale));
+        }
+    }
+
+    return result;
+}
+
+
+void SwiffFilterListApply(NSArray *filters, UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow, CGFloat scale)
+{
+    if (!pixels || !width || !height) return;
+
+    for (SwiffFilter *filter in filters) {
+        SwiffFilterShadow shadow;
+
+        if ([filter isKindOfClass:[SwiffBlurFilter class]]) {
+            SwiffBlurFilter *blur = (SwiffBlurFilter *)filter;
+            size_t radiusX = sGetBlurRadius([blur blurX], scale);
+            size_t radiusY = sGetBlurRadius([blur blurY], scale);
+
+            sBoxBlur(pixels, width, height, bytesPerRow, 4, radiusX, radiusY, [blur numberOfPasses]);
+
+        } else if ([filter isKindOfClass:[SwiffColorMatrixFilter class]]) {
+            sApplyColorMatrix([(SwiffColorMatrixFilter *)filter matrixValues], pixels, width, height, bytesPerRow);
+
+        } else if ([filter isKindOfClass:[SwiffConvolutionFilter class]]) {
+            sApplyConvolution((SwiffConvolutionFilter *)filter, pixels, width, height, bytesPerRow);
+
+        } else if (sMakeShadow(filter, &shadow, YES)) {
+            sApplyShadow(&shadow, pixels, width, height, bytesPerRow, scale);
+        }
+    }
+}
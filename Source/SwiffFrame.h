@@ -54,4 +54,8 @@
 @property (nonatomic, strong, readonly) NSArray *placedObjects;
 @property (nonatomic, strong, readonly) NSArray *placedObjectsWithNames;
 
+// Depths at which an instance was placed, replaced, or removed since the previous frame of the timeline
+// (see -[SwiffPlacedObject instanceID]).  nil when there are none
+@property (nonatomic, strong, readonly) NSIndexSet *changedInstanceDepths;
+
 @end
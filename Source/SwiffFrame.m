@@ -47,9 +47,11 @@
                         soundEvents: (NSArray *) soundEvents
                         streamSound: (SwiffSoundDefinition *) streamSound
                         streamBlock: (SwiffSoundStreamBlock *) streamBlock
+              changedInstanceDepths: (NSIndexSet *) changedInstanceDepths
 {
     if ((self = [super init])) {
         _placedObjects = placedObjects;
+        _changedInstanceDepths = changedInstanceDepths;
         _soundEvents   = soundEvents;
         _streamSound   = streamSound;
         _streamBlock   = streamBlock;
@@ -50,8 +50,15 @@ typedef NS_ENUM(NSInteger, SwiffGradientInterpolationMode) {
 @property (nonatomic, readonly, assign) NSInteger recordCount;
 - (void) getColor:(SwiffColor *)outColor ratio:(CGFloat *)outRatio forRecord:(NSUInteger)index;
 
+// The gradients and tables below are prepared once per set of effective colors (the record colors after
+// the color transform and colorModificationBlock are applied) and kept in a small per-gradient cache.
+// A gradient drawn with the same effective colors on every frame is therefore only built once.
 - (CGGradientRef) copyCGGradientWithColorTransformStack:(CFArrayRef)stack CF_RETURNS_RETAINED;
 - (CGGradientRef) copyCGGradientWithColorTransformStack:(CFArrayRef)stack colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock CF_RETURNS_RETAINED;
+- (CGGradientRef) copyCGGradientWithComposedColorTransform:(const SwiffComposedColorTransform *)transform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock CF_RETURNS_RETAINED;
+
+// Fills table with length premultiplied RGBA8 entries, sampled evenly from ratio 0 to ratio 1
+- (void) getRGBA8Table:(UInt8 *)table length:(NSUInteger)length composedColorTransform:(const SwiffComposedColorTransform *)transform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock;
 
 @property (nonatomic, readonly, assign) SwiffGradientSpreadMode spreadMode;
 @property (nonatomic, readonly, assign) SwiffGradientInterpolationMode interpolationMode;
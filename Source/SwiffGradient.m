@@ -30,9 +30,104 @@
 #import <SwiffUtils.h>
 
 
+enum {
+    SwiffGradientCacheCapacity = 4
+};
+
+// A prepared gradient for one set of effective colors, that is, the record colors
+// after the color transform stack and colorModificationBlock are applied
+typedef struct {
+    NSUInteger    hash;
+    SwiffColor    colors[16];
+    CGGradientRef gradient;
+    UInt8        *table;
+    NSUInteger    tableLength;
+} SwiffGradientCacheEntry;
+
+
+static CGGradientRef sCreateCGGradient(const SwiffColor *colors, const CGFloat *ratios, NSInteger count)
+{
+    CGColorSpaceRef   colorSpace = CGColorSpaceCreateDeviceRGB();
+    CFMutableArrayRef cgColors   = CFArrayCreateMutable(NULL, count, &kCFTypeArrayCallBacks);
+
+    for (NSInteger i = 0; i < count; i++) {
+        CGColorRef cgColor = CGColorCreate(colorSpace, &colors[i].red);
+        CFArrayAppendValue(cgColors, cgColor);
+        CGColorRelease(cgColor);
+    }
+    
+    CGGradientRef result = CGGradientCreateWithColors(colorSpace, cgColors, ratios);
+
+    if (cgColors)   CFRelease(cgColors);
+    if (colorSpace) CFRelease(colorSpace);
+
+    return result;
+}
+
+
+// Fills table with length premultiplied RGBA8 entries, sampled evenly from ratio 0 to ratio 1
+static void sFillRGBA8Table(const SwiffColor *colors, const CGFloat *ratios, NSInteger count, UInt8 *table, NSUInteger length)
+{
+    if (count == 0) {
+        memset(table, 0, length * 4);
+        return;
+    }
+
+    NSInteger record = 0;
+
+    for (NSUInteger i = 0; i < length; i++) {
+        CGFloat position = (CGFloat)i / (length - 1);
+
+        while ((record < count) && (ratios[record] < position)) {
+            record++;
+        }
+
+        // Like CGGradient, interpolate unpremultiplied components and pad beyond the first and last records
+        SwiffColor color;
+        if (record == 0) {
+            color = colors[0];
+        } else if (record == count) {
+            color = colors[count - 1];
+        } else {
+            SwiffColor from  = colors[record - 1];
+            SwiffColor to    = colors[record];
+            CGFloat    range = ratios[record] - ratios[record - 1];
+            CGFloat    t     = (range > 0) ? ((position - ratios[record - 1]) / range) : 1.0;
+
+            color.red   = from.red   + ((to.red   - from.red)   * t);
+            color.green = from.green + ((to.green - from.green) * t);
+            color.blue  = from.blue  + ((to.blue  - from.blue)  * t);
+            color.alpha = from.alpha + ((to.alpha - from.alpha) * t);
+        }
+
+        CGFloat alpha = MAX(0, MIN(color.alpha, 1));
+
+        table[(i * 4) + 0] = (UInt8)lround(MAX(0, MIN(color.red,   1)) * alpha * 255);
+        table[(i * 4) + 1] = (UInt8)lround(MAX(0, MIN(color.green, 1)) * alpha * 255);
+        table[(i * 4) + 2] = (UInt8)lround(MAX(0, MIN(color.blue,  1)) * alpha * 255);
+        table[(i * 4) + 3] = (UInt8)lround(alpha * 255);
+    }
+}
+
+
+static void sFreeCacheEntry(SwiffGradientCacheEntry *entry)
+{
+    CGGradientRelease(entry->gradient);
+    free(entry->table);
+
+    entry->gradient = NULL;
+    entry->table = NULL;
+    entry->tableLength = 0;
+}
+
+
 @implementation SwiffGradient {
-    CGFloat       _ratios[15];
-    SwiffColor    _colors[15];
+    CGFloat    _ratios[16];
+    SwiffColor _colors[16];
+
+    // Most recently used first
+    SwiffGradientCacheEntry _cache[SwiffGradientCacheCapacity];
+    NSUInteger              _cacheCount;
 }
 
 
@@ -105,35 +200,108 @@
 }
 
 
-- (CGGradientRef) copyCGGradientWithColorTransformStack:(CFArrayRef)stack
+- (void) dealloc
 {
-    return [self copyCGGradientWithColorTransformStack:stack colorModificationBlock:NULL];
+    for (NSUInteger i = 0; i < _cacheCount; i++) {
+        sFreeCacheEntry(&_cache[i]);
+    }
 }
 
 
-- (CGGradientRef) copyCGGradientWithColorTransformStack:(CFArrayRef)stack colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock
+// Returns the cache entry for the effective colors, moved to the front of the cache.  The caller must hold @synchronized(self)
+- (SwiffGradientCacheEntry *) _cacheEntryWithComposedColorTransform:(const SwiffComposedColorTransform *)transform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock
 {
-    CGColorSpaceRef   colorSpace = CGColorSpaceCreateDeviceRGB();
-    CFMutableArrayRef colors     = CFArrayCreateMutable(NULL, _recordCount, &kCFTypeArrayCallBacks);
+    SwiffGradientCacheEntry key;
+    memset(&key, 0, sizeof(SwiffGradientCacheEntry));
 
     for (NSInteger i = 0; i < _recordCount; i++) {
-        SwiffColor color = SwiffColorApplyColorTransformStack(_colors[i], stack);
-    
+        SwiffColor color = SwiffColorApplyComposedColorTransform(_colors[i], transform);
+
         if (colorModificationBlock) {
             colorModificationBlock(&color);
         }
-    
-        CGColorRef cgColor = CGColorCreate(colorSpace, &color.red);
-        CFArrayAppendValue(colors, cgColor);
-        CGColorRelease(cgColor);
+
+        key.colors[i] = color;
     }
-    
-    CGGradientRef result = CGGradientCreateWithColors(colorSpace, colors, _ratios);
 
-    if (colors)     CFRelease(colors);
-    if (colorSpace) CFRelease(colorSpace);
+    // FNV-1a over the effective colors
+    const UInt8 *bytes = (const UInt8 *)key.colors;
+    size_t length = sizeof(SwiffColor) * _recordCount;
 
-    return result;
+    key.hash = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+        key.hash = (key.hash ^ bytes[i]) * 16777619U;
+    }
+
+    NSUInteger index = 0;
+    while ((index < _cacheCount) && ((_cache[index].hash != key.hash) || memcmp(_cache[index].colors, key.colors, length))) {
+        index++;
+    }
+
+    if (index == _cacheCount) {
+        if (_cacheCount < SwiffGradientCacheCapacity) {
+            _cacheCount++;
+        } else {
+            index = SwiffGradientCacheCapacity - 1;
+            sFreeCacheEntry(&_cache[index]);
+        }
+
+        _cache[index] = key;
+    }
+
+    if (index > 0) {
+        SwiffGradientCacheEntry entry = _cache[index];
+        memmove(&_cache[1], &_cache[0], index * sizeof(SwiffGradientCacheEntry));
+        _cache[0] = entry;
+    }
+
+    return &_cache[0];
+}
+
+
+- (CGGradientRef) copyCGGradientWithColorTransformStack:(CFArrayRef)stack
+{
+    return [self copyCGGradientWithColorTransformStack:stack colorModificationBlock:NULL];
+}
+
+
+- (CGGradientRef) copyCGGradientWithColorTransformStack:(CFArrayRef)stack colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock
+{
+    SwiffComposedColorTransform transform = SwiffComposedColorTransformMakeWithStack(stack);
+    return [self copyCGGradientWithComposedColorTransform:&transform colorModificationBlock:colorModificationBlock];
+}
+
+
+- (CGGradientRef) copyCGGradientWithComposedColorTransform:(const SwiffComposedColorTransform *)transform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock
+{
+    @synchronized (self) {
+        SwiffGradientCacheEntry *entry = [self _cacheEntryWithComposedColorTransform:transform colorModificationBlock:colorModificationBlock];
+
+        if (!entry->gradient) {
+            entry->gradient = sCreateCGGradient(entry->colors, _ratios, _recordCount);
+        }
+
+        return CGGradientRetain(entry->gradient);
+    }
+}
+
+
+- (void) getRGBA8Table:(UInt8 *)table length:(NSUInteger)length composedColorTransform:(const SwiffComposedColorTransform *)transform colorModificationBlock:(SwiffColorModificationBlock)colorModificationBlock
+{
+    if (!table || (length < 2)) return;
+
+    @synchronized (self) {
+        SwiffGradientCacheEntry *entry = [self _cacheEntryWithComposedColorTransform:transform colorModificationBlock:colorModificationBlock];
+
+        if (entry->tableLength != length) {
+            entry->table = realloc(entry->table, length * 4);
+            entry->tableLength = length;
+
+            sFillRGBA8Table(entry->colors, _ratios, _recordCount, entry->table, length);
+        }
+
+        memcpy(table, entry->table, length * 4);
+    }
 }
 
 
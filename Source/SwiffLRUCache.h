@@ -0,0 +1,71 @@
+/*
+    SwiffLRUCache.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+
+
+// The least-recently-used bookkeeping shared by SwiffBitmapCache and SwiffDisplayListCache.
+// Entries are kept in a set, compared with -isEqual:, and linked most recently used first.
+// Once the sum of their byteCount is over byteLimit, the least recently used ones are removed.
+//
+// Subclasses define the entries and the lookup and add methods built on the ones below.
+//
+// Not thread-safe, use from one thread at a time.
+//
+@interface SwiffLRUCacheEntry : NSObject {
+@public
+    __unsafe_unretained SwiffLRUCacheEntry *_previous;
+    __unsafe_unretained SwiffLRUCacheEntry *_next;
+    NSUInteger _byteCount;  // Set before -addEntry:
+}
+@end
+
+
+@interface SwiffLRUCache : NSObject
+
+- (id) initWithByteLimit:(NSUInteger)byteLimit;
+
+// Returns the entry equal to probe, or nil.  Neither is counted, use -hitEntry: or -miss
+- (id) memberEntry:(SwiffLRUCacheEntry *)probe;
+
+// Marks entry as the most recently used, and counts a hit
+- (void) hitEntry:(SwiffLRUCacheEntry *)entry;
+- (void) miss;
+
+// Replaces any entry equal to entry.  Entries larger than byteLimit are not added
+- (void) addEntry:(SwiffLRUCacheEntry *)entry;
+
+- (void) removeEntry:(SwiffLRUCacheEntry *)entry;
+- (void) removeAllEntries;
+
+@property (nonatomic, assign) NSUInteger byteLimit;
+@property (nonatomic, assign, readonly) NSUInteger byteCount;
+
+@property (nonatomic, assign, readonly) NSUInteger hitCount;
+@property (nonatomic, assign, readonly) NSUInteger missCount;
+
+@end
@@ -0,0 +1,158 @@
+/*
+    SwiffLRUCache.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffLRUCache.h"
+
+
+@implementation SwiffLRUCacheEntry
+@end
+
+
+@implementation SwiffLRUCache {
+    NSMutableSet *_entries;
+
+    // Most recently used first
+    __unsafe_unretained SwiffLRUCacheEntry *_head;
+    __unsafe_unretained SwiffLRUCacheEntry *_tail;
+}
+
+
+- (id) initWithByteLimit:(NSUInteger)byteLimit
+{
+    if ((self = [super init])) {
+        _entries = [[NSMutableSet alloc] init];
+        _byteLimit = byteLimit;
+    }
+
+    return self;
+}
+
+
+#pragma mark -
+#pragma mark Private Methods
+
+- (void) _unlinkEntry:(SwiffLRUCacheEntry *)entry
+{
+    if (entry->_previous) entry->_previous->_next = entry->_next;
+    else                  _head = entry->_next;
+
+    if (entry->_next) entry->_next->_previous = entry->_previous;
+    else              _tail = entry->_previous;
+
+    entry->_previous = entry->_next = nil;
+}
+
+
+- (void) _linkEntryAtHead:(SwiffLRUCacheEntry *)entry
+{
+    entry->_previous = nil;
+    entry->_next = _head;
+
+    if (_head) _head->_previous = entry;
+    else       _tail = entry;
+
+    _head = entry;
+}
+
+
+- (void) _evictToByteLimit
+{
+    while (_tail && (_byteCount > _byteLimit)) {
+        [self removeEntry:_tail];
+    }
+}
+
+
+#pragma mark -
+#pragma mark Public Methods
+
+- (id) memberEntry:(SwiffLRUCacheEntry *)probe
+{
+    return [_entries member:probe];
+}
+
+
+- (void) hitEntry:(SwiffLRUCacheEntry *)entry
+{
+    if (entry != _head) {
+        [self _unlinkEntry:entry];
+        [self _linkEntryAtHead:entry];
+    }
+
+    _hitCount++;
+}
+
+
+- (void) miss
+{
+    _missCount++;
+}
+
+
+- (void) addEntry:(SwiffLRUCacheEntry *)entry
+{
+    SwiffLRUCacheEntry *existing = [_entries member:entry];
+    if (existing) {
+        [self removeEntry:existing];
+    }
+
+    // Never add an entry which would evict everything else and still not fit
+    if (entry->_byteCount > _byteLimit) return;
+
+    [_entries addObject:entry];
+    [self _linkEntryAtHead:entry];
+    _byteCount += entry->_byteCount;
+
+    [self _evictToByteLimit];
+}
+
+
+- (void) removeEntry:(SwiffLRUCacheEntry *)entry
+{
+    _byteCount -= entry->_byteCount;
+
+    [self _unlinkEntry:entry];
+    [_entries removeObject:entry];
+}
+
+
+- (void) removeAllEntries
+{
+    [_entries removeAllObjects];
+    _head = _tail = nil;
+    _byteCount = 0;
+}
+
+
+- (void) setByteLimit:(NSUInteger)byteLimit
+{
+    _byteLimit = byteLimit;
+    [self _evictToByteLimit];
+}
+
+
+@end
@@ -0,0 +1,57 @@
+/*
+    SwiffLZMA.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+
+
+// LZMA, as used by 'ZWS' files.  A ZWS file stores its 5 LZMA property bytes
+// after the 12 byte header, followed by the raw stream (no end marker required)
+//
+enum {
+    SwiffLZMAPropertiesLength = 5
+};
+
+typedef struct SwiffLZMADecoder SwiffLZMADecoder;
+
+// The decoder writes directly into outBuffer, which also serves as the dictionary
+extern SwiffLZMADecoder *SwiffLZMADecoderCreate(const UInt8 *properties, UInt8 *outBuffer, NSUInteger outLength);
+extern void SwiffLZMADecoderFree(SwiffLZMADecoder *decoder);
+
+// Decodes as much as possible, buffering any partial symbol until more bytes arrive.  Returns NO on corrupt input
+extern BOOL SwiffLZMADecoderAppendBytes(SwiffLZMADecoder *decoder, const UInt8 *bytes, NSUInteger length);
+
+// Notes that no more input will arrive, and decodes the buffered bytes.  The compressed length stored in a
+// ZWS header is not trusted for this, as some writers store an incorrect one.  Returns NO on corrupt input
+extern BOOL SwiffLZMADecoderFinish(SwiffLZMADecoder *decoder);
+
+extern NSUInteger SwiffLZMADecoderGetOutputLength(SwiffLZMADecoder *decoder);
+extern BOOL SwiffLZMADecoderIsFinished(SwiffLZMADecoder *decoder);
+
+extern BOOL SwiffLZMADecode(const UInt8 *properties, const UInt8 *inBuffer, NSUInteger inLength, UInt8 *outBuffer, NSUInteger outLength);
+
+// Returns a malloc'd buffer which the caller must free(), or NULL on failure
+extern UInt8 *SwiffLZMAEncode(const UInt8 *inBuffer, NSUInteger inLength, UInt8 *outProperties, NSUInteger *outLength);
@@ -0,0 +1,927 @@
+/*
+    SwiffLZMA.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffLZMA.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+enum {
+    kNumBitModelTotalBits = 11,
+    kBitModelTotal        = (1 << kNumBitModelTotalBits),
+    kNumMoveBits          = 5,
+    kTopValue             = (1 << 24),
+
+    kNumStates            = 12,
+    kNumPosBitsMax        = 4,
+    kNumLenToPosStates    = 4,
+    kNumAlignBits         = 4,
+    kStartPosModelIndex   = 4,
+    kEndPosModelIndex     = 14,
+    kNumFullDistances     = (1 << (kEndPosModelIndex >> 1)),
+    kMatchMinLen          = 2,
+    kMatchMaxLen          = 273,
+
+    // No single symbol consumes more input than this
+    kRequiredInput        = 32
+};
+
+
+typedef UInt16 SwiffLZMAProbability;
+
+typedef struct SwiffLZMALengthModel {
+    SwiffLZMAProbability choice;
+    SwiffLZMAProbability choice2;
+    SwiffLZMAProbability low[1 << kNumPosBitsMax][1 << 3];
+    SwiffLZMAProbability mid[1 << kNumPosBitsMax][1 << 3];
+    SwiffLZMAProbability high[1 << 8];
+} SwiffLZMALengthModel;
+
+
+typedef struct SwiffLZMAModel {
+    SwiffLZMAProbability isMatch[kNumStates << kNumPosBitsMax];
+    SwiffLZMAProbability isRep[kNumStates];
+    SwiffLZMAProbability isRepG0[kNumStates];
+    SwiffLZMAProbability isRepG1[kNumStates];
+    SwiffLZMAProbability isRepG2[kNumStates];
+    SwiffLZMAProbability isRep0Long[kNumStates << kNumPosBitsMax];
+    SwiffLZMAProbability posSlot[kNumLenToPosStates][1 << 6];
+    SwiffLZMAProbability posSpecial[1 + kNumFullDistances - kEndPosModelIndex];
+    SwiffLZMAProbability align[1 << kNumAlignBits];
+    SwiffLZMALengthModel length;
+    SwiffLZMALengthModel repLength;
+
+    // Everything above is a probability, initialized by sModelInit()
+    SwiffLZMAProbability *literal;
+
+    UInt32 state;
+    UInt32 reps[4];
+    UInt8  lc;
+    UInt8  lp;
+    UInt8  pb;
+} SwiffLZMAModel;
+
+
+struct SwiffLZMADecoder {
+    SwiffLZMAModel model;
+    UInt32         range;
+    UInt32         code;
+
+    UInt8         *input;
+    NSUInteger     inputPosition;
+    NSUInteger     inputLength;
+    NSUInteger     inputCapacity;
+
+    UInt8         *output;
+    NSUInteger     outputPosition;
+    NSUInteger     outputLength;
+
+    Boolean        didInitRange;
+    Boolean        didOverrun;
+    Boolean        isInputFinished;
+    Boolean        isFinished;
+    Boolean        isValid;
+};
+
+
+typedef struct SwiffLZMAEncoder {
+    SwiffLZMAModel model;
+    UInt64         low;
+    UInt32         range;
+    UInt8          cache;
+    UInt64         cacheSize;
+
+    UInt8         *output;
+    NSUInteger     outputLength;
+    NSUInteger     outputCapacity;
+    Boolean        didFail;
+} SwiffLZMAEncoder;
+
+
+#pragma mark -
+#pragma mark Model
+
+static BOOL sModelInit(SwiffLZMAModel *model, const UInt8 *properties)
+{
+    UInt32 d = properties[0];
+    if (d >= (9 * 5 * 5)) return NO;
+
+    model->lc = d % 9;  d /= 9;
+    model->lp = d % 5;
+    model->pb = d / 5;
+
+    if (model->pb > kNumPosBitsMax) return NO;
+
+    NSUInteger literalCount = 0x300 << (model->lc + model->lp);
+    model->literal = malloc(literalCount * sizeof(SwiffLZMAProbability));
+    if (!model->literal) return NO;
+
+    SwiffLZMAProbability *probabilities = (SwiffLZMAProbability *)model;
+    NSUInteger count = offsetof(SwiffLZMAModel, literal) / sizeof(SwiffLZMAProbability);
+
+    for (NSUInteger i = 0; i < count; i++) {
+        probabilities[i] = kBitModelTotal >> 1;
+    }
+
+    for (NSUInteger i = 0; i < literalCount; i++) {
+        model->literal[i] = kBitModelTotal >> 1;
+    }
+
+    model->state = 0;
+    bzero(model->reps, sizeof(model->reps));
+
+    return YES;
+}
+
+
+static inline UInt32 sStateAfterLiteral(UInt32 state)
+{
+    return (state < 4) ? 0 : ((state < 10) ? (state - 3) : (state - 6));
+}
+
+static inline UInt32 sStateAfterMatch(UInt32 state)    { return (state < 7) ? 7  : 10; }
+static inline UInt32 sStateAfterRep(UInt32 state)      { return (state < 7) ? 8  : 11; }
+static inline UInt32 sStateAfterShortRep(UInt32 state) { return (state < 7) ? 9  : 11; }
+
+
+static inline SwiffLZMAProbability *sGetLiteralProbabilities(SwiffLZMAModel *model, NSUInteger position, UInt8 previousByte)
+{
+    NSUInteger literalState = ((position & ((1 << model->lp) - 1)) << model->lc) + (previousByte >> (8 - model->lc));
+    return &model->literal[0x300 * literalState];
+}
+
+
+#pragma mark -
+#pragma mark Decoder
+
+static inline UInt8 sDecoderReadByte(SwiffLZMADecoder *decoder)
+{
+    if (decoder->inputPosition < decoder->inputLength) {
+        return decoder->input[decoder->inputPosition++];
+    }
+
+    decoder->didOverrun = YES;
+    return 0;
+}
+
+
+static inline void sDecoderNormalize(SwiffLZMADecoder *decoder)
+{
+    if (decoder->range < kTopValue) {
+        decoder->range <<= 8;
+        decoder->code = (decoder->code << 8) | sDecoderReadByte(decoder);
+    }
+}
+
+
+static inline UInt32 sDecodeBit(SwiffLZMADecoder *decoder, SwiffLZMAProbability *probability)
+{
+    UInt32 p      = *probability;
+    UInt32 bound  = (decoder->range >> kNumBitModelTotalBits) * p;
+    UInt32 symbol;
+
+    if (decoder->code < bound) {
+        *probability = p + ((kBitModelTotal - p) >> kNumMoveBits);
+        decoder->range = bound;
+        symbol = 0;
+    } else {
+        *probability = p - (p >> kNumMoveBits);
+        decoder->code  -= bound;
+        decoder->range -= bound;
+        symbol = 1;
+    }
+
+    sDecoderNormalize(decoder);
+
+    return symbol;
+}
+
+
+static UInt32 sDecodeDirectBits(SwiffLZMADecoder *decoder, UInt32 numberOfBits)
+{
+    UInt32 result = 0;
+
+    while (numberOfBits--) {
+        decoder->range >>= 1;
+        decoder->code   -= decoder->range;
+
+        UInt32 t = 0 - (decoder->code >> 31);
+        decoder->code += decoder->range & t;
+
+        sDecoderNormalize(decoder);
+
+        result = (result << 1) + (t + 1);
+    }
+
+    return result;
+}
+
+
+static UInt32 sDecodeBitTree(SwiffLZMADecoder *decoder, SwiffLZMAProbability *probabilities, UInt32 numberOfBits)
+{
+    UInt32 m = 1;
+
+    for (UInt32 i = 0; i < numberOfBits; i++) {
+        m = (m << 1) + sDecodeBit(decoder, &probabilities[m]);
+    }
+
+    return m - (1 << numberOfBits);
+}
+
+
+static UInt32 sDecodeReverseBitTree(SwiffLZMADecoder *decoder, SwiffLZMAProbability *probabilities, UInt32 numberOfBits)
+{
+    UInt32 m = 1;
+    UInt32 symbol = 0;
+
+    for (UInt32 i = 0; i < numberOfBits; i++) {
+        UInt32 bit = sDecodeBit(decoder, &probabilities[m]);
+        m = (m << 1) + bit;
+        symbol |= (bit << i);
+    }
+
+    return symbol;
+}
+
+
+static UInt32 sDecodeLength(SwiffLZMADecoder *decoder, SwiffLZMALengthModel *length, UInt32 posState)
+{
+    if (!sDecodeBit(decoder, &length->choice)) {
+        return sDecodeBitTree(decoder, length->low[posState], 3);
+    } else if (!sDecodeBit(decoder, &length->choice2)) {
+        return 8 + sDecodeBitTree(decoder, length->mid[posState], 3);
+    } else {
+        return 16 + sDecodeBitTree(decoder, length->high, 8);
+    }
+}
+
+
+static UInt32 sDecodeDistance(SwiffLZMADecoder *decoder, UInt32 length)
+{
+    SwiffLZMAModel *model = &decoder->model;
+
+    UInt32 lenState = MIN(length, kNumLenToPosStates - 1);
+    UInt32 posSlot  = sDecodeBitTree(decoder, model->posSlot[lenState], 6);
+
+    if (posSlot < kStartPosModelIndex) {
+        return posSlot;
+    }
+
+    UInt32 numberOfDirectBits = (posSlot >> 1) - 1;
+    UInt32 distance = (2 | (posSlot & 1)) << numberOfDirectBits;
+
+    if (posSlot < kEndPosModelIndex) {
+        distance += sDecodeReverseBitTree(decoder, model->posSpecial + distance - posSlot, numberOfDirectBits);
+    } else {
+        distance += sDecodeDirectBits(decoder, numberOfDirectBits - kNumAlignBits) << kNumAlignBits;
+        distance += sDecodeReverseBitTree(decoder, model->align, kNumAlignBits);
+    }
+
+    return distance;
+}
+
+
+// Decodes one literal or match.  Returns NO on corrupt input
+static BOOL sDecodeSymbol(SwiffLZMADecoder *decoder)
+{
+    SwiffLZMAModel *model  = &decoder->model;
+    UInt8          *output = decoder->output;
+    NSUInteger      position = decoder->outputPosition;
+
+    UInt32 state    = model->state;
+    UInt32 posState = position & ((1 << model->pb) - 1);
+    UInt32 *reps    = model->reps;
+
+    if (!sDecodeBit(decoder, &model->isMatch[(state << kNumPosBitsMax) + posState])) {
+        UInt8 previousByte = position ? output[position - 1] : 0;
+        SwiffLZMAProbability *probabilities = sGetLiteralProbabilities(model, position, previousByte);
+        UInt32 symbol = 1;
+
+        if (state >= 7) {
+            UInt32 matchByte = output[position - reps[0] - 1];
+
+            do {
+                UInt32 matchBit = (matchByte >> 7) & 1;
+                matchByte <<= 1;
+
+                UInt32 bit = sDecodeBit(decoder, &probabilities[((1 + matchBit) << 8) + symbol]);
+                symbol = (symbol << 1) | bit;
+
+                if (matchBit != bit) break;
+            } while (symbol < 0x100);
+        }
+
+        while (symbol < 0x100) {
+            symbol = (symbol << 1) | sDecodeBit(decoder, &probabilities[symbol]);
+        }
+
+        output[decoder->outputPosition++] = (UInt8)(symbol - 0x100);
+        model->state = sStateAfterLiteral(state);
+
+        return YES;
+    }
+
+    UInt32 length;
+
+    if (sDecodeBit(decoder, &model->isRep[state])) {
+        if (position == 0) return NO;
+
+        if (!sDecodeBit(decoder, &model->isRepG0[state])) {
+            if (!sDecodeBit(decoder, &model->isRep0Long[(state << kNumPosBitsMax) + posState])) {
+                model->state = sStateAfterShortRep(state);
+                output[decoder->outputPosition++] = output[position - reps[0] - 1];
+                return YES;
+            }
+
+        } else {
+            UInt32 distance;
+
+            if (!sDecodeBit(decoder, &model->isRepG1[state])) {
+                distance = reps[1];
+            } else {
+                if (!sDecodeBit(decoder, &model->isRepG2[state])) {
+                    distance = reps[2];
+                } else {
+                    distance = reps[3];
+                    reps[3] = reps[2];
+                }
+
+                reps[2] = reps[1];
+            }
+
+            reps[1] = reps[0];
+            reps[0] = distance;
+        }
+
+        length = sDecodeLength(decoder, &model->repLength, posState);
+        model->state = sStateAfterRep(state);
+
+    } else {
+        reps[3] = reps[2];
+        reps[2] = reps[1];
+        reps[1] = reps[0];
+
+        length = sDecodeLength(decoder, &model->length, posState);
+        model->state = sStateAfterMatch(state);
+        reps[0] = sDecodeDistance(decoder, length);
+
+        // End marker
+        if (reps[0] == 0xFFFFFFFF) {
+            decoder->isFinished = YES;
+            return YES;
+        }
+
+        if (reps[0] >= position) return NO;
+    }
+
+    length += kMatchMinLen;
+    if (length > (decoder->outputLength - position)) return NO;
+
+    const UInt8 *from = output + position - reps[0] - 1;
+    UInt8       *to   = output + position;
+
+    for (UInt32 i = 0; i < length; i++) {
+        to[i] = from[i];
+    }
+
+    decoder->outputPosition += length;
+
+    return YES;
+}
+
+
+static void sDecoderRun(SwiffLZMADecoder *decoder)
+{
+    BOOL isLastInput = decoder->isInputFinished;
+
+    if (!decoder->didInitRange) {
+        if (!isLastInput && ((decoder->inputLength - decoder->inputPosition) < 5)) return;
+
+        decoder->range = 0xFFFFFFFF;
+        decoder->code  = 0;
+
+        if (sDecoderReadByte(decoder) != 0) {
+            decoder->isValid = NO;
+            return;
+        }
+
+        for (NSInteger i = 0; i < 4; i++) {
+            decoder->code = (decoder->code << 8) | sDecoderReadByte(decoder);
+        }
+
+        if (decoder->code == decoder->range) {
+            decoder->isValid = NO;
+            return;
+        }
+
+        decoder->didInitRange = YES;
+    }
+
+    while (!decoder->isFinished && (decoder->outputPosition < decoder->outputLength)) {
+        if (!isLastInput && ((decoder->inputLength - decoder->inputPosition) < kRequiredInput)) {
+            break;
+        }
+
+        if (!sDecodeSymbol(decoder) || decoder->didOverrun) {
+            decoder->isValid = NO;
+            return;
+        }
+    }
+
+    if (decoder->outputPosition == decoder->outputLength) {
+        decoder->isFinished = YES;
+    }
+}
+
+
+SwiffLZMADecoder *SwiffLZMADecoderCreate(const UInt8 *properties, UInt8 *outBuffer, NSUInteger outLength)
+{
+    SwiffLZMADecoder *decoder = calloc(1, sizeof(SwiffLZMADecoder));
+    if (!decoder) return NULL;
+
+    if (!sModelInit(&decoder->model, properties)) {
+        free(decoder);
+        return NULL;
+    }
+
+    decoder->output        = outBuffer;
+    decoder->outputLength  = outLength;
+    decoder->isValid       = YES;
+
+    return decoder;
+}
+
+
+void SwiffLZMADecoderFree(SwiffLZMADecoder *decoder)
+{
+    if (!decoder) return;
+
+    free(decoder->model.literal);
+    free(decoder->input);
+    free(decoder);
+}
+
+
+BOOL SwiffLZMADecoderAppendBytes(SwiffLZMADecoder *decoder, const UInt8 *bytes, NSUInteger length)
+{
+    if (!decoder->isValid) return NO;
+    if (decoder->isFinished) return YES;
+
+    // Keep only the bytes of a partially available symbol, then append
+    NSUInteger pending = decoder->inputLength - decoder->inputPosition;
+
+    if (pending && decoder->inputPosition) {
+        memmove(decoder->input, decoder->input + decoder->inputPosition, pending);
+    }
+
+    decoder->inputPosition = 0;
+    decoder->inputLength   = pending;
+
+    if ((pending + length) > decoder->inputCapacity) {
+        NSUInteger capacity = MAX(pending + length, decoder->inputCapacity * 2);
+        UInt8 *input = realloc(decoder->input, capacity);
+
+        if (!input) {
+            decoder->isValid = NO;
+            return NO;
+        }
+
+        decoder->input = input;
+        decoder->inputCapacity = capacity;
+    }
+
+    memcpy(decoder->input + pending, bytes, length);
+    decoder->inputLength += length;
+
+    sDecoderRun(decoder);
+
+    return decoder->isValid;
+}
+
+
+BOOL SwiffLZMADecoderFinish(SwiffLZMADecoder *decoder)
+{
+    if (!decoder->isValid) return NO;
+    if (decoder->isFinished) return YES;
+
+    decoder->isInputFinished = YES;
+    sDecoderRun(decoder);
+
+    return decoder->isValid;
+}
+
+
+NSUInteger SwiffLZMADecoderGetOutputLength(SwiffLZMADecoder *decoder)
+{
+    return decoder->outputPosition;
+}
+
+
+BOOL SwiffLZMADecoderIsFinished(SwiffLZMADecoder *decoder)
+{
+    return decoder->isFinished;
+}
+
+
+BOOL SwiffLZMADecode(const UInt8 *properties, const UInt8 *inBuffer, NSUInteger inLength, UInt8 *outBuffer, NSUInteger outLength)
+{
+    SwiffLZMADecoder *decoder = SwiffLZMADecoderCreate(properties, outBuffer, outLength);
+    if (!decoder) return NO;
+
+    // Decode straight from inBuffer rather than copying it into the input buffer
+    decoder->input           = (UInt8 *)inBuffer;
+    decoder->inputLength     = inLength;
+    decoder->isInputFinished = YES;
+
+    sDecoderRun(decoder);
+
+    BOOL result = decoder->isValid && (decoder->outputPosition == outLength);
+
+    decoder->input = NULL;
+    SwiffLZMADecoderFree(decoder);
+
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Encoder
+
+static void sEncoderWriteByte(SwiffLZMAEncoder *encoder, UInt8 byte)
+{
+    if (encoder->outputLength == encoder->outputCapacity) {
+        NSUInteger capacity = encoder->outputCapacity ? (encoder->outputCapacity * 2) : (64 * 1024);
+        UInt8 *output = realloc(encoder->output, capacity);
+
+        if (!output) {
+            encoder->didFail = YES;
+            return;
+        }
+
+        encoder->output = output;
+        encoder->outputCapacity = capacity;
+    }
+
+    encoder->output[encoder->outputLength++] = byte;
+}
+
+
+static void sEncoderShiftLow(SwiffLZMAEncoder *encoder)
+{
+    if (((UInt32)encoder->low < 0xFF000000) || ((encoder->low >> 32) != 0)) {
+        UInt8 carry = (UInt8)(encoder->low >> 32);
+        UInt8 temp  = encoder->cache;
+
+        do {
+            sEncoderWriteByte(encoder, (UInt8)(temp + carry));
+            temp = 0xFF;
+        } while (--encoder->cacheSize != 0);
+
+        encoder->cache = (UInt8)((UInt32)encoder->low >> 24);
+    }
+
+    encoder->cacheSize++;
+    encoder->low = (UInt32)encoder->low << 8;
+}
+
+
+static inline void sEncodeBit(SwiffLZMAEncoder *encoder, SwiffLZMAProbability *probability, UInt32 bit)
+{
+    UInt32 p     = *probability;
+    UInt32 bound = (encoder->range >> kNumBitModelTotalBits) * p;
+
+    if (!bit) {
+        encoder->range = bound;
+        *probability = p + ((kBitModelTotal - p) >> kNumMoveBits);
+    } else {
+        encoder->low   += bound;
+        encoder->range -= bound;
+        *probability = p - (p >> kNumMoveBits);
+    }
+
+    while (encoder->range < kTopValue) {
+        encoder->range <<= 8;
+        sEncoderShiftLow(encoder);
+    }
+}
+
+
+static void sEncodeDirectBits(SwiffLZMAEncoder *encoder, UInt32 value, UInt32 numberOfBits)
+{
+    while (numberOfBits--) {
+        encoder->range >>= 1;
+        encoder->low += encoder->range & (0 - ((value >> numberOfBits) & 1));
+
+        while (encoder->range < kTopValue) {
+            encoder->range <<= 8;
+            sEncoderShiftLow(encoder);
+        }
+    }
+}
+
+
+static void sEncodeBitTree(SwiffLZMAEncoder *encoder, SwiffLZMAProbability *probabilities, UInt32 numberOfBits, UInt32 symbol)
+{
+    UInt32 m = 1;
+
+    while (numberOfBits--) {
+        UInt32 bit = (symbol >> numberOfBits) & 1;
+        sEncodeBit(encoder, &probabilities[m], bit);
+        m = (m << 1) | bit;
+    }
+}
+
+
+static void sEncodeReverseBitTree(SwiffLZMAEncoder *encoder, SwiffLZMAProbability *probabilities, UInt32 numberOfBits, UInt32 symbol)
+{
+    UInt32 m = 1;
+
+    while (numberOfBits--) {
+        UInt32 bit = symbol & 1;
+        symbol >>= 1;
+        sEncodeBit(encoder, &probabilities[m], bit);
+        m = (m << 1) | bit;
+    }
+}
+
+
+static void sEncodeLength(SwiffLZMAEncoder *encoder, SwiffLZMALengthModel *model, UInt32 length, UInt32 posState)
+{
+    if (length < 8) {
+        sEncodeBit(encoder, &model->choice, 0);
+        sEncodeBitTree(encoder, model->low[posState], 3, length);
+    } else if (length < 16) {
+        sEncodeBit(encoder, &model->choice, 1);
+        sEncodeBit(encoder, &model->choice2, 0);
+        sEncodeBitTree(encoder, model->mid[posState], 3, length - 8);
+    } else {
+        sEncodeBit(encoder, &model->choice, 1);
+        sEncodeBit(encoder, &model->choice2, 1);
+        sEncodeBitTree(encoder, model->high, 8, length - 16);
+    }
+}
+
+
+static void sEncodeDistance(SwiffLZMAEncoder *encoder, UInt32 distance, UInt32 length)
+{
+    SwiffLZMAModel *model = &encoder->model;
+
+    UInt32 lenState = MIN(length, kNumLenToPosStates - 1);
+    UInt32 posSlot;
+
+    if (distance < kStartPosModelIndex) {
+        posSlot = distance;
+    } else {
+        UInt32 n = 31 - __builtin_clz(distance);
+        posSlot = (n << 1) | ((distance >> (n - 1)) & 1);
+    }
+
+    sEncodeBitTree(encoder, model->posSlot[lenState], 6, posSlot);
+
+    if (posSlot >= kStartPosModelIndex) {
+        UInt32 numberOfDirectBits = (posSlot >> 1) - 1;
+        UInt32 base    = (2 | (posSlot & 1)) << numberOfDirectBits;
+        UInt32 reduced = distance - base;
+
+        if (posSlot < kEndPosModelIndex) {
+            sEncodeReverseBitTree(encoder, model->posSpecial + base - posSlot, numberOfDirectBits, reduced);
+        } else {
+            sEncodeDirectBits(encoder, reduced >> kNumAlignBits, numberOfDirectBits - kNumAlignBits);
+            sEncodeReverseBitTree(encoder, model->align, kNumAlignBits, reduced & ((1 << kNumAlignBits) - 1));
+        }
+    }
+}
+
+
+static void sEncodeLiteral(SwiffLZMAEncoder *encoder, const UInt8 *inBuffer, NSUInteger position)
+{
+    SwiffLZMAModel *model = &encoder->model;
+
+    UInt8  previousByte = position ? inBuffer[position - 1] : 0;
+    UInt32 byte         = inBuffer[position];
+    UInt32 symbol       = 1;
+
+    SwiffLZMAProbability *probabilities = sGetLiteralProbabilities(model, position, previousByte);
+
+    if (model->state >= 7) {
+        UInt32 matchByte = inBuffer[position - model->reps[0] - 1];
+        BOOL   isMatched = YES;
+
+        for (NSInteger i = 7; i >= 0; i--) {
+            UInt32 bit = (byte >> i) & 1;
+
+            if (isMatched) {
+                UInt32 matchBit = (matchByte >> i) & 1;
+                sEncodeBit(encoder, &probabilities[((1 + matchBit) << 8) + symbol], bit);
+                isMatched = (matchBit == bit);
+            } else {
+                sEncodeBit(encoder, &probabilities[symbol], bit);
+            }
+
+            symbol = (symbol << 1) | bit;
+        }
+
+    } else {
+        for (NSInteger i = 7; i >= 0; i--) {
+            UInt32 bit = (byte >> i) & 1;
+            sEncodeBit(encoder, &probabilities[symbol], bit);
+            symbol = (symbol << 1) | bit;
+        }
+    }
+
+    model->state = sStateAfterLiteral(model->state);
+}
+
+
+static inline UInt32 sGetMatchLength(const UInt8 *a, const UInt8 *b, UInt32 maxLength)
+{
+    UInt32 length = 0;
+    while ((length < maxLength) && (a[length] == b[length])) length++;
+    return length;
+}
+
+
+static inline UInt32 sHash3(const UInt8 *bytes)
+{
+    return ((bytes[0] | (bytes[1] << 8) | (bytes[2] << 16)) * 2654435761U) >> 16;
+}
+
+
+UInt8 *SwiffLZMAEncode(const UInt8 *inBuffer, NSUInteger inLength, UInt8 *outProperties, NSUInteger *outLength)
+{
+    enum {
+        kHashSize      = (1 << 16),
+        kMaxChainDepth = 48
+    };
+
+    // lc=3, lp=0, pb=2 (the defaults of most LZMA encoders)
+    UInt8 properties[SwiffLZMAPropertiesLength];
+    UInt32 dictionarySize = (1 << 16);
+
+    while ((dictionarySize < inLength) && (dictionarySize < (1 << 26))) {
+        dictionarySize <<= 1;
+    }
+
+    properties[0] = (2 * 5 + 0) * 9 + 3;
+    properties[1] = (dictionarySize      ) & 0xFF;
+    properties[2] = (dictionarySize >>  8) & 0xFF;
+    properties[3] = (dictionarySize >> 16) & 0xFF;
+    properties[4] = (dictionarySize >> 24) & 0xFF;
+
+    SwiffLZMAEncoder *encoder = calloc(1, sizeof(SwiffLZMAEncoder));
+    UInt32 *head  = calloc(kHashSize, sizeof(UInt32));
+    UInt32 *chain = malloc(MAX(inLength, 1) * sizeof(UInt32));
+
+    if (!encoder || !head || !chain || !sModelInit(&encoder->model, properties)) {
+        if (encoder) free(encoder->model.literal);
+        free(encoder);
+        free(head);
+        free(chain);
+        return NULL;
+    }
+
+    SwiffLZMAModel *model = &encoder->model;
+    UInt32 *reps = model->reps;
+
+    encoder->range     = 0xFFFFFFFF;
+    encoder->cacheSize = 1;
+
+    // Positions are stored +1 in head and chain, 0 terminates a chain
+    #define INSERT_HASH(P) do { \
+        if (((P) + 3) <= inLength) { \
+            UInt32 h = sHash3(inBuffer + (P)); \
+            chain[(P)] = head[h]; \
+            head[h] = (UInt32)(P) + 1; \
+        } \
+    } while (0)
+
+    NSUInteger position = 0;
+
+    while (position < inLength) {
+        UInt32 posState  = position & ((1 << model->pb) - 1);
+        UInt32 state     = model->state;
+        UInt32 maxLength = (UInt32)MIN(inLength - position, kMatchMaxLen);
+
+        // Greedy parse: prefer rep0, then the longest match found along the hash chain
+        UInt32 repLength = 0;
+        if (position > reps[0] && maxLength >= kMatchMinLen) {
+            repLength = sGetMatchLength(inBuffer + position, inBuffer + position - reps[0] - 1, maxLength);
+        }
+
+        UInt32 mainLength   = 0;
+        UInt32 mainDistance = 0;
+
+        if (maxLength >= 3) {
+            UInt32 candidate = head[sHash3(inBuffer + position)];
+            NSInteger depth = kMaxChainDepth;
+
+            while (candidate && depth--) {
+                NSUInteger from = candidate - 1;
+                if ((position - from) > dictionarySize) break;
+
+                UInt32 length = sGetMatchLength(inBuffer + position, inBuffer + from, maxLength);
+
+                if (length > mainLength) {
+                    mainLength   = length;
+                    mainDistance = (UInt32)(position - from - 1);
+                    if (length == maxLength) break;
+                }
+
+                candidate = chain[from];
+            }
+
+            // Short matches at long distances cost more than literals
+            if ((mainLength == 3) && (mainDistance >= (1 << 14))) {
+                mainLength = 0;
+            }
+        }
+
+        UInt32 length = 1;
+
+        if ((repLength >= kMatchMinLen) && ((repLength + 1) >= mainLength)) {
+            length = repLength;
+
+            sEncodeBit(encoder, &model->isMatch[(state << kNumPosBitsMax) + posState], 1);
+            sEncodeBit(encoder, &model->isRep[state], 1);
+            sEncodeBit(encoder, &model->isRepG0[state], 0);
+            sEncodeBit(encoder, &model->isRep0Long[(state << kNumPosBitsMax) + posState], 1);
+            sEncodeLength(encoder, &model->repLength, length - kMatchMinLen, posState);
+
+            model->state = sStateAfterRep(state);
+
+        } else if (mainLength >= 3) {
+            length = mainLength;
+
+            sEncodeBit(encoder, &model->isMatch[(state << kNumPosBitsMax) + posState], 1);
+            sEncodeBit(encoder, &model->isRep[state], 0);
+            sEncodeLength(encoder, &model->length, length - kMatchMinLen, posState);
+            sEncodeDistance(encoder, mainDistance, length - kMatchMinLen);
+
+            reps[3] = reps[2];
+            reps[2] = reps[1];
+            reps[1] = reps[0];
+            reps[0] = mainDistance;
+
+            model->state = sStateAfterMatch(state);
+
+        } else {
+            sEncodeBit(encoder, &model->isMatch[(state << kNumPosBitsMax) + posState], 0);
+            sEncodeLiteral(encoder, inBuffer, position);
+        }
+
+        for (UInt32 i = 0; i < length; i++) {
+            INSERT_HASH(position + i);
+        }
+
+        position += length;
+    }
+
+    #undef INSERT_HASH
+
+    for (NSInteger i = 0; i < 5; i++) {
+        sEncoderShiftLow(encoder);
+    }
+
+    UInt8 *result = encoder->output;
+
+    if (encoder->didFail) {
+        free(result);
+        result = NULL;
+    } else {
+        memcpy(outProperties, properties, SwiffLZMAPropertiesLength);
+        *outLength = encoder->outputLength;
+    }
+
+    free(model->literal);
+    free(encoder);
+    free(head);
+    free(chain);
+
+    return result;
+}
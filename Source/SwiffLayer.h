@@ -51,6 +51,7 @@
 @property (nonatomic, assign) BOOL drawsBackground;
 
 @property (nonatomic, strong) SwiffColorModificationBlock colorModificationBlock;
+@property (nonatomic, assign) SwiffColorTransform *colorModificationTransform;
 @property (nonatomic, assign) CGFloat hairlineWidth;
 @property (nonatomic, assign) CGFloat fillHairlineWidth;
 
@@ -58,6 +59,7 @@
 @property (nonatomic, assign) BOOL shouldSmoothFonts;
 @property (nonatomic, assign) BOOL shouldSubpixelPositionFonts;
 @property (nonatomic, assign) BOOL shouldSubpixelQuantizeFonts;
+@property (nonatomic, assign) BOOL shouldCacheSlidingSprites;
 @property (nonatomic, assign) BOOL shouldFlattenSublayers;
 @property (nonatomic, assign) BOOL shouldDrawDebugColors;
 
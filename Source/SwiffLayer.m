@@ -27,6 +27,8 @@
 
 #import "SwiffLayer.h"
 
+#import "SwiffDisplayList.h"
+#import "SwiffDisplayListCache.h"
 #import "SwiffFrame.h"
 #import "SwiffMovie.h"
 #import "SwiffPlacedObject.h"
@@ -34,6 +36,7 @@
 #import "SwiffRenderer.h"
 #import "SwiffSoundPlayer.h"
 #import "SwiffSparseArray.h"
+#import "SwiffTimeline.h"
 #import "SwiffUtils.h"
 #import "SwiffView.h"
 
@@ -60,7 +63,7 @@ static NSString * const SwiffRenderTranslationYKey = @"SwiffRenderTranslationY";
     BOOL               _interpolateCurrentFrame;
 }
 
-@dynamic colorModificationBlock;
+@dynamic colorModificationBlock, colorModificationTransform;
 @synthesize swiffLayerDelegate = _delegate;
 
 
@@ -80,12 +83,14 @@ static NSString * const SwiffRenderTranslationYKey = @"SwiffRenderTranslationY";
         _movie = movie;
 
         _renderer = movie ? [[SwiffRenderer alloc] initWithMovie:movie] : nil;
+        [_renderer setBitmapCache:[movie bitmapCache]];
         
         _contentLayer = [[CALayer alloc] init];
         [_contentLayer setDelegate:self];
         [self addSublayer:_contentLayer];
 
         _playhead = movie ? [[SwiffPlayhead alloc] initWithMovie:movie delegate:self] : nil;
+        [_renderer setTimeline:[_playhead timeline]];
         [_playhead gotoFrameWithIndex:0 play:NO];
         
         [_contentLayer setNeedsDisplay];
@@ -101,6 +106,10 @@ static NSString * const SwiffRenderTranslationYKey = @"SwiffRenderTranslationY";
 
     [_playhead invalidateTimers];
     [_playhead setDelegate:nil];
+
+    if ([_renderer colorModificationBlock]) {
+        [[_movie displayListCache] removeAllDisplayLists];
+    }
 }
 
 
@@ -465,6 +474,31 @@ static BOOL sShouldUseSameLayer(SwiffPlacedObject *a, SwiffPlacedObject *b)
 }
 
 
+// Sprite instances animate within placed objects of the current frame which did not change
+- (void) _invalidateSteppedSpriteInstances
+{
+    SwiffTimeline  *timeline        = [_playhead timeline];
+    NSMutableArray *rectInvalidates = nil;
+
+    for (SwiffPlacedObject *placedObject in [_currentFrame placedObjects]) {
+        if (![[timeline timelineForPlacedObject:placedObject] didChange]) continue;
+
+        CALayer *sublayer = SwiffSparseArrayGetObjectAtIndex(_sublayers, placedObject->_depth);
+
+        if (sublayer) {
+            [sublayer setNeedsDisplay];
+        } else {
+            if (!rectInvalidates) rectInvalidates = [[NSMutableArray alloc] init];
+            [rectInvalidates addObject:placedObject];
+        }
+    }
+
+    if (rectInvalidates) {
+        [self _invalidatePlacedObjects:rectInvalidates];
+    }
+}
+
+
 - (void) _transitionToFrame:(SwiffFrame *)newFrame fromFrame:(SwiffFrame *)oldFrame
 {
     SwiffLog(@"View", @"%@ -> %@", oldFrame, newFrame);
@@ -614,16 +648,42 @@ static BOOL sShouldUseSameLayer(SwiffPlacedObject *a, SwiffPlacedObject *b)
 
         NSArray *placedObjects = [frame placedObjects];
         NSMutableArray *filteredObjects = nil;
+        NSMutableIndexSet *sublayerDepths = nil;
         
         if (_sublayerCount) {
             filteredObjects = [[NSMutableArray alloc] initWithCapacity:[placedObjects count]];
+            sublayerDepths  = [[NSMutableIndexSet alloc] init];
             
             for (SwiffPlacedObject *object in placedObjects) {
                 UInt16 depth = object->_depth;
                 if (!SwiffSparseArrayGetObjectAtIndex(_sublayers, depth)) {
                     [filteredObjects addObject:object];
+                } else {
+                    [sublayerDepths addIndex:depth];
                 }
             }
+
+            if (![sublayerDepths count]) sublayerDepths = nil;
+        }
+
+        // The display list is keyed by the frame's placed objects, plus the depths drawn by sublayers,
+        // the current frames of the sprite instances, and the renderer settings which decide whether
+        // layers are recorded for the bitmap cache.  The cache is shared by all layers of the movie
+        NSData   *childFrames = [[_playhead timeline] childFramesSignature];
+        NSNumber *settings    = @(([_renderer bitmapCache] ? 1 : 0) | ([_renderer shouldCacheSlidingSprites] ? 2 : 0));
+
+        id variant = [[NSArray alloc] initWithObjects:
+            settings,
+            (sublayerDepths ? (id)sublayerDepths : (id)[NSNull null]),
+            (childFrames    ? (id)childFrames    : (id)[NSNull null]),
+            nil];
+
+        SwiffDisplayListCache *cache = [_movie displayListCache];
+        SwiffDisplayList *displayList = [cache displayListForPlacedObjects:placedObjects variant:variant colorModificationTransform:[_renderer colorModificationTransform] colorModificationBlock:[_renderer colorModificationBlock]];
+
+        if (!displayList) {
+            displayList = [_renderer displayListForPlacedObjects:(filteredObjects ? filteredObjects : placedObjects)];
+            [cache addDisplayList:displayList forPlacedObjects:placedObjects variant:variant];
         }
 
         CGContextSaveGState(context);
@@ -640,7 +700,7 @@ static BOOL sShouldUseSameLayer(SwiffPlacedObject *a, SwiffPlacedObject *b)
 
         [_renderer setScaleFactorHint:[self contentsScale]];
         [_renderer setBaseAffineTransform:&_scaledAffineTransform];
-        [_renderer renderPlacedObjects:(filteredObjects ? filteredObjects : placedObjects) inContext:context];
+        [_renderer renderDisplayList:displayList inContext:context];
 
         CGContextRestoreGState(context);
         
@@ -798,6 +858,10 @@ static BOOL sShouldUseSameLayer(SwiffPlacedObject *a, SwiffPlacedObject *b)
 
         [_delegate layer:self didUpdateCurrentFrame:_currentFrame];
     }
+
+    if (step) {
+        [self _invalidateSteppedSpriteInstances];
+    }
 }
 
 
@@ -864,11 +928,23 @@ static BOOL sShouldUseSameLayer(SwiffPlacedObject *a, SwiffPlacedObject *b)
 
 - (void) setColorModificationBlock:(SwiffColorModificationBlock)block
 {
+    // Display lists refer to the block without retaining it, see -[SwiffRenderer setColorModificationBlock:]
+    if ((block != [_renderer colorModificationBlock]) && [_renderer colorModificationBlock]) {
+        [[_movie displayListCache] removeAllDisplayLists];
+    }
+
     [_renderer setColorModificationBlock:block];
     [self _setNeedsRedisplay];
 }
 
 
+- (void) setColorModificationTransform:(SwiffColorTransform *)transform
+{
+    [_renderer setColorModificationTransform:transform];
+    [self _setNeedsRedisplay];
+}
+
+
 - (void) setHairlineWidth:(CGFloat)width
 {
     if (width != [_renderer hairlineWidth]) {
@@ -923,6 +999,15 @@ static BOOL sShouldUseSameLayer(SwiffPlacedObject *a, SwiffPlacedObject *b)
 }
 
 
+- (void) setShouldCacheSlidingSprites:(BOOL)yn
+{
+    if (yn != [_renderer shouldCacheSlidingSprites]) {
+        [_renderer setShouldCacheSlidingSprites:yn];
+        [self _setNeedsRedisplay];
+    }
+}
+
+
 - (void) setShouldFlattenSublayers:(BOOL)shouldFlattenSublayers
 {
     if (shouldFlattenSublayers != _shouldFlattenSublayers) {
@@ -938,11 +1023,18 @@ static BOOL sShouldUseSameLayer(SwiffPlacedObject *a, SwiffPlacedObject *b)
 }
 
 
+- (SwiffColorTransform *) colorModificationTransform
+{
+    return [_renderer colorModificationTransform];
+}
+
+
 - (CGFloat) hairlineWidth               { return [_renderer hairlineWidth];               }
 - (CGFloat) fillHairlineWidth           { return [_renderer fillHairlineWidth];           }
 - (BOOL)    shouldAntialias             { return [_renderer shouldAntialias];             }
 - (BOOL)    shouldSmoothFonts           { return [_renderer shouldSmoothFonts];           }
 - (BOOL)    shouldSubpixelPositionFonts { return [_renderer shouldSubpixelPositionFonts]; }
 - (BOOL)    shouldSubpixelQuantizeFonts { return [_renderer shouldSubpixelQuantizeFonts]; }
+- (BOOL)    shouldCacheSlidingSprites   { return [_renderer shouldCacheSlidingSprites];   }
 
 @end
@@ -31,14 +31,44 @@
 
 @class SwiffBitmapDefinition, SwiffDynamicTextDefinition, SwiffFontDefinition,
        SwiffShapeDefinition, SwiffStaticTextDefinition, SwiffSoundDefinition,
-       SwiffSparseArray;
+       SwiffSparseArray, SwiffDisplayListCache, SwiffBitmapCache;
 
-@protocol SwiffMovieDecoder;
+@protocol SwiffMovieDecoder, SwiffMovieLoadingDelegate;
+
+
+typedef NS_OPTIONS(NSUInteger, SwiffMovieReadingOptions) {
+    SwiffMovieReadingOptionsNone = 0,
+
+    // Memory-maps the file.  Bitmap, JPEG table, and sound data is kept as slices of the
+    // mapping (or of the inflated buffer for CWS files) rather than as copies, which allows
+    // the kernel to evict clean pages under memory pressure
+    SwiffMovieReadingMapped = 1 << 0,
+
+    // Only records a directory of definition tags at load time.  Each definition is decoded
+    // the first time it is requested.  The movie data is retained for the lifetime of the movie.
+    // Definitions must then only be requested from one thread at a time
+    SwiffMovieReadingLazyDefinitions = 1 << 1,
+
+    // Decodes shape, bitmap, font and sound definitions on all cores at load time.  All
+    // definitions are available once the initializer returns.  Ignored when combined with
+    // SwiffMovieReadingLazyDefinitions
+    SwiffMovieReadingParallelDefinitions = 1 << 2
+};
 
 
 @interface SwiffMovie : SwiffSpriteDefinition
 
 - (id) initWithData:(NSData *)data;
+- (id) initWithData:(NSData *)data options:(SwiffMovieReadingOptions)options;
+- (id) initWithContentsOfFile:(NSString *)path options:(SwiffMovieReadingOptions)options;
+
+// Incremental loading.  Call -appendData: as chunks arrive (from disk or a socket), then -finishLoading.
+// Definitions and frames are available as soon as their tags are complete; -frames only contains
+// the frames loaded so far.  Must be called on the thread which uses the movie.
+//
+- (id) initWithLoadingDelegate:(id<SwiffMovieLoadingDelegate>)loadingDelegate;
+- (void) appendData:(NSData *)data;
+- (void) finishLoading;
 
 - (id<SwiffDefinition>) definitionWithLibraryID:(UInt16)libraryID;
 
@@ -58,6 +88,26 @@
 @property (nonatomic, assign) SwiffColor backgroundColor;
 @property (nonatomic, assign, readonly) SwiffColor *backgroundColorPointer;
 
+@property (nonatomic, weak) id<SwiffMovieLoadingDelegate> loadingDelegate;
+@property (nonatomic, assign, readonly, getter=isLoading) BOOL loading;
+
+// Display lists of frames rendered by SwiffLayer, shared by all layers showing this movie
+@property (nonatomic, strong, readonly) SwiffDisplayListCache *displayListCache;
+
+// Rasterized placed objects drawn by the renderers of SwiffLayer, shared by all layers showing this movie
+@property (nonatomic, strong, readonly) SwiffBitmapCache *bitmapCache;
+
+@end
+
+
+@protocol SwiffMovieLoadingDelegate <NSObject>
+@optional
+- (void) movieDidLoadHeader:(SwiffMovie *)movie;
+- (void) movie:(SwiffMovie *)movie didLoadFramesThroughIndex1:(NSUInteger)frameIndex1;
+- (void) movieDidFinishLoading:(SwiffMovie *)movie;
 @end
 
 extern id<SwiffDefinition> SwiffMovieGetDefinition(SwiffMovie *movie, UInt16 libraryID);
+
+// Returns the class of the definition without decoding it
+extern Class SwiffMovieGetDefinitionClass(SwiffMovie *movie, UInt16 libraryID);
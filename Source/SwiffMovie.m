@@ -28,7 +28,9 @@
 
 #import "SwiffMovie.h"
 
+#import "SwiffBitmapCache.h"
 #import "SwiffBitmapDefinition.h"
+#import "SwiffDisplayListCache.h"
 #import "SwiffDynamicTextDefinition.h"
 #import "SwiffFontDefinition.h"
 #import "SwiffParser.h"
@@ -47,6 +49,66 @@ static NSString * const SwiffMovieJPEGTablesDataKey = @"SwiffMovieJPEGTablesData
 static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEGTablesData";
 
 
+// An entry in the tag directory of a movie loaded with SwiffMovieReadingLazyDefinitions
+typedef struct SwiffMovieTagDirectoryEntry {
+    UInt32 offset;      // Offset of the RECORDHEADER, see SwiffParserGetCurrentTagOffset()
+    UInt32 length;      // Length of the tag body
+    UInt16 libraryID;
+    UInt8  tag;
+    UInt8  version;
+    UInt32 next1;       // 1-based index of the next entry with the same libraryID, or 0
+} SwiffMovieTagDirectoryEntry;
+
+
+static BOOL sIsDeferrableTag(SwiffTag tag)
+{
+    return (tag == SwiffTagDefineShape)         ||
+           (tag == SwiffTagDefineBits)          ||
+           (tag == SwiffTagDefineBitsLossless)  ||
+           (tag == SwiffTagDefineSound)         ||
+           (tag == SwiffTagDefineSprite)        ||
+           (tag == SwiffTagDefineFont)          ||
+           (tag == SwiffTagDefineFontInfo)      ||
+           (tag == SwiffTagDefineFontName)      ||
+           (tag == SwiffTagDefineFontAlignZones)||
+           (tag == SwiffTagDefineText)          ||
+           (tag == SwiffTagDefineEditText);
+}
+
+
+// Tags which decode without looking up other definitions, and hence may be decoded on a worker thread
+static BOOL sIsIndependentTag(SwiffTag tag)
+{
+    return (tag == SwiffTagDefineShape)         ||
+           (tag == SwiffTagDefineBits)          ||
+           (tag == SwiffTagDefineBitsLossless)  ||
+           (tag == SwiffTagDefineSound)         ||
+           (tag == SwiffTagDefineFont)          ||
+           (tag == SwiffTagDefineFontInfo)      ||
+           (tag == SwiffTagDefineFontName)      ||
+           (tag == SwiffTagDefineFontAlignZones);
+}
+
+
+static Class sGetDefinitionClassForTag(SwiffTag tag)
+{
+    switch (tag) {
+    case SwiffTagDefineShape:           return [SwiffShapeDefinition class];
+    case SwiffTagDefineBits:
+    case SwiffTagDefineBitsLossless:    return [SwiffBitmapDefinition class];
+    case SwiffTagDefineSound:           return [SwiffSoundDefinition class];
+    case SwiffTagDefineSprite:          return [SwiffSpriteDefinition class];
+    case SwiffTagDefineFont:
+    case SwiffTagDefineFontInfo:
+    case SwiffTagDefineFontName:
+    case SwiffTagDefineFontAlignZones:  return [SwiffFontDefinition class];
+    case SwiffTagDefineText:            return [SwiffStaticTextDefinition class];
+    case SwiffTagDefineEditText:        return [SwiffDynamicTextDefinition class];
+    default:                            return nil;
+    }
+}
+
+
 @interface SwiffBitmapDefinition (Friend)
 - (void) _setJPEGTablesData:(NSData *)data;
 @end
@@ -61,7 +123,23 @@ static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEG
 
 
 @implementation SwiffMovie {
-    SwiffSparseArray *_definitions;
+    SwiffSparseArray        *_definitions;
+    SwiffParser             *_incrementalParser;
+    SwiffMovieReadingOptions _options;
+    SwiffDisplayListCache   *_displayListCache;
+    SwiffBitmapCache        *_bitmapCache;
+    NSUInteger               _loadedFrameCount;
+    BOOL                     _didReadHeader;
+    BOOL                     _didFindEndTag;
+
+    // Lazy definitions
+    NSData                      *_directoryData;
+    NSData                      *_jpegTablesData;
+    SwiffMovieTagDirectoryEntry *_directory;
+    NSUInteger                   _directoryCount;
+    NSUInteger                   _directoryCapacity;
+    CFMutableDictionaryRef       _libraryIDToEntry1;     // (0x10000 | libraryID) -> 1-based index of first entry
+    CFMutableDictionaryRef       _libraryIDToLastEntry1; // (0x10000 | libraryID) -> 1-based index of last entry
 }
 
 
@@ -72,12 +150,19 @@ static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEG
 
 
 - (id) initWithData:(NSData *)data
+{
+    return [self initWithData:data options:SwiffMovieReadingOptionsNone];
+}
+
+
+- (id) initWithData:(NSData *)data options:(SwiffMovieReadingOptions)options
 {
     if ((self = [super init])) {
         SwiffColor white = { 1.0, 1.0, 1.0, 1.0 };
 
         _backgroundColor = white;
         _definitions = [[SwiffSparseArray alloc] init];
+        _options = options;
 
         [self _decodeData:data];
     }
@@ -86,15 +171,51 @@ static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEG
 }
 
 
+- (id) initWithContentsOfFile:(NSString *)path options:(SwiffMovieReadingOptions)options
+{
+    NSDataReadingOptions readingOptions = (options & SwiffMovieReadingMapped) ? NSDataReadingMappedAlways : 0;
+
+    NSError *error = nil;
+    NSData  *data  = [[NSData alloc] initWithContentsOfFile:path options:readingOptions error:&error];
+
+    if (!data) {
+        SwiffWarn(@"Movie", @"Could not read %@: %@", path, error);
+        return nil;
+    }
+
+    return [self initWithData:data options:options];
+}
+
+
+- (id) initWithLoadingDelegate:(id<SwiffMovieLoadingDelegate>)loadingDelegate
+{
+    if ((self = [self initWithData:nil])) {
+        _loadingDelegate   = loadingDelegate;
+        _incrementalParser = SwiffParserCreateIncremental();
+
+        [self setMovie:self];
+    }
+
+    return self;
+}
+
+
+- (void) dealloc
+{
+    if (_incrementalParser) {
+        SwiffParserFree(_incrementalParser);
+        _incrementalParser = NULL;
+    }
+
+    [self _freeTagDirectory];
+}
+
+
 #pragma mark -
 #pragma mark Private Methods
 
-- (void) _decodeData:(NSData *)data
+- (void) _readHeaderFromParser:(SwiffParser *)parser
 {
-    if (!data) return;
-    
-    SwiffParser *parser = SwiffParserCreate([data bytes], [data length]);
-    
     SwiffHeader header;
     SwiffParserReadHeader(parser, &header);
     
@@ -105,25 +226,261 @@ static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEG
     if (_version < 6) {
         SwiffParserSetStringEncoding(parser, SwiffGetLegacyStringEncoding());
     }
+    
+    _didReadHeader = YES;
+}
 
-    // Parse tags
-    {
-        [self setMovie:self];
 
-        while (SwiffParserIsValid(parser)) {
-            SwiffParserAdvanceToNextTag(parser);
-            
-            SwiffTag  tag     = SwiffParserGetCurrentTag(parser);
-            NSInteger version = SwiffParserGetCurrentTagVersion(parser);
+- (void) _freeTagDirectory
+{
+    free(_directory);
+    _directory = NULL;
+    _directoryCount = _directoryCapacity = 0;
 
-            if (tag == SwiffTagEnd) break;
+    if (_libraryIDToEntry1) {
+        CFRelease(_libraryIDToEntry1);
+        _libraryIDToEntry1 = NULL;
+    }
 
-            [self _parser:parser didFindTag:tag version:version];
+    if (_libraryIDToLastEntry1) {
+        CFRelease(_libraryIDToLastEntry1);
+        _libraryIDToLastEntry1 = NULL;
+    }
+
+    _directoryData  = nil;
+    _jpegTablesData = nil;
+}
+
+
+- (void) _addTagDirectoryEntryWithParser:(SwiffParser *)parser tag:(SwiffTag)tag version:(NSInteger)version
+{
+    UInt32 offset = (UInt32)SwiffParserGetCurrentTagOffset(parser);
+    UInt32 length = (UInt32)SwiffParserGetBytesRemainingInCurrentTag(parser);
+
+    UInt16 libraryID = 0;
+    SwiffParserReadUInt16(parser, &libraryID);
+
+    if (_directoryCount == _directoryCapacity) {
+        _directoryCapacity = _directoryCapacity ? (_directoryCapacity * 2) : 64;
+        _directory = realloc(_directory, _directoryCapacity * sizeof(SwiffMovieTagDirectoryEntry));
+    }
+
+    NSUInteger index1 = _directoryCount + 1;
+    SwiffMovieTagDirectoryEntry *entry = &_directory[_directoryCount++];
+
+    entry->offset    = offset;
+    entry->length    = length;
+    entry->libraryID = libraryID;
+    entry->tag       = tag;
+    entry->version   = version;
+    entry->next1     = 0;
+
+    const void *key  = (const void *)(0x10000 | (NSUInteger)libraryID);
+    NSUInteger  last = (NSUInteger)CFDictionaryGetValue(_libraryIDToLastEntry1, key);
+
+    if (last) {
+        _directory[last - 1].next1 = (UInt32)index1;
+    } else {
+        CFDictionarySetValue(_libraryIDToEntry1, key, (const void *)index1);
+    }
+
+    CFDictionarySetValue(_libraryIDToLastEntry1, key, (const void *)index1);
+}
+
+
+// YES if the current tag is for a libraryID which already has a definition.  A definition decoded while parsing
+// (see SwiffMovieGetDefinition()) no longer replays its chain, so the tags which follow it, such as a DefineFontInfo
+// after a DefineFont which was decoded early, are applied to it directly, as an eager parse would
+- (BOOL) _hasDefinitionForCurrentTagWithParser:(SwiffParser *)parser
+{
+    if (SwiffParserGetBytesRemainingInCurrentTag(parser) < 2) return NO;
+
+    const UInt8 *bytes     = SwiffParserGetCurrentBytePointer(parser);
+    UInt16       libraryID = bytes[0] | (bytes[1] << 8);
+
+    return SwiffSparseArrayGetObjectAtIndex(_definitions, libraryID) != nil;
+}
+
+
+- (NSUInteger) _firstTagDirectoryEntry1ForLibraryID:(UInt16)libraryID
+{
+    if (!_libraryIDToEntry1) return 0;
+    return (NSUInteger)CFDictionaryGetValue(_libraryIDToEntry1, (const void *)(0x10000 | (NSUInteger)libraryID));
+}
+
+
+// Builds the definition for a chain of tag directory entries without adding it to the movie.
+// Only reads from the movie, hence may run concurrently for independent shape, bitmap, font and sound chains
+//
+- (id<SwiffDefinition>) _definitionWithTagDirectoryEntry1:(NSUInteger)index1
+{
+    id<SwiffDefinition> result = nil;
+    NSStringEncoding encoding = (_version < 6) ? SwiffGetLegacyStringEncoding() : NSUTF8StringEncoding;
+
+    // Replay every tag for this libraryID in file order (DefineFont is followed by DefineFontInfo, etc.)
+    while (index1) {
+        SwiffMovieTagDirectoryEntry *entry = &_directory[index1 - 1];
+        SwiffTag tag = entry->tag;
+
+        SwiffParser *parser = SwiffParserCreateWithBackingData(_directoryData);
+        SwiffParserSetStringEncoding(parser, encoding);
+
+        SwiffParserAdvance(parser, entry->offset);
+        SwiffParserAdvanceToNextTag(parser);
+
+        if (!SwiffParserIsValid(parser)) {
+            // Skip
+
+        } else if (tag == SwiffTagDefineShape) {
+            result = [[SwiffShapeDefinition alloc] initWithParser:parser movie:self];
+
+        } else if (tag == SwiffTagDefineBits || tag == SwiffTagDefineBitsLossless) {
+            SwiffBitmapDefinition *bitmap = [[SwiffBitmapDefinition alloc] initWithParser:parser movie:self];
+
+            if (tag == SwiffTagDefineBits && _jpegTablesData) {
+                [bitmap _setJPEGTablesData:_jpegTablesData];
+            }
+
+            result = bitmap;
+
+        } else if (tag == SwiffTagDefineSound) {
+            result = [[SwiffSoundDefinition alloc] initWithParser:parser movie:self];
+
+        } else if (tag == SwiffTagDefineSprite) {
+            result = [[SwiffSpriteDefinition alloc] initWithParser:parser movie:self];
+
+        } else if (tag == SwiffTagDefineText) {
+            result = [[SwiffStaticTextDefinition alloc] initWithParser:parser movie:self];
+
+        } else if (tag == SwiffTagDefineEditText) {
+            result = [[SwiffDynamicTextDefinition alloc] initWithParser:parser movie:self];
+
+        } else {
+            UInt16 fontID;
+            SwiffParserReadUInt16(parser, &fontID);
+
+            SwiffFontDefinition *font = (SwiffFontDefinition *)result;
+
+            if (![font isKindOfClass:[SwiffFontDefinition class]]) {
+                result = font = [[SwiffFontDefinition alloc] initWithLibraryID:fontID movie:self];
+            }
+
+            if (tag == SwiffTagDefineFont) {
+                [font readDefineFontTagFromParser:parser];
+            } else if (tag == SwiffTagDefineFontInfo) {
+                [font readDefineFontInfoTagFromParser:parser];
+            } else if (tag == SwiffTagDefineFontName) {
+                [font readDefineFontNameTagFromParser:parser];
+            } else if (tag == SwiffTagDefineFontAlignZones) {
+                [font readDefineFontAlignZonesFromParser:parser];
+            }
+        }
+
+        SwiffParserFree(parser);
+
+        index1 = entry->next1;
+    }
+
+    return result;
+}
+
+
+- (id<SwiffDefinition>) _decodeDefinitionWithLibraryID:(UInt16)libraryID
+{
+    NSUInteger index1 = [self _firstTagDirectoryEntry1ForLibraryID:libraryID];
+    if (!index1) return nil;
+
+    // Remove first, so that lookups made while decoding cannot recurse into this definition
+    CFDictionaryRemoveValue(_libraryIDToEntry1, (const void *)(0x10000 | (NSUInteger)libraryID));
+
+    id<SwiffDefinition> definition = [self _definitionWithTagDirectoryEntry1:index1];
+
+    if (definition) {
+        SwiffSparseArraySetObjectAtIndex(_definitions, libraryID, definition);
+    }
+
+    return definition;
+}
+
+
+static int sCompareIndex1(const void *a, const void *b)
+{
+    NSUInteger ia = *(const NSUInteger *)a, ib = *(const NSUInteger *)b;
+    return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+}
+
+
+- (void) _decodeTagDirectoryInParallel
+{
+    CFIndex count = CFDictionaryGetCount(_libraryIDToEntry1);
+    if (!count) return;
+
+    NSUInteger  *firsts  = malloc(count * sizeof(NSUInteger));
+    const void **results = calloc(count, sizeof(void *));
+
+    CFDictionaryGetKeysAndValues(_libraryIDToEntry1, NULL, (const void **)firsts);
+
+    // Sort by position in the file, so that the join below is in tag order
+    qsort(firsts, count, sizeof(NSUInteger), sCompareIndex1);
+
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        @autoreleasepool {
+            id<SwiffDefinition> definition = [self _definitionWithTagDirectoryEntry1:firsts[i]];
+            results[i] = definition ? CFBridgingRetain(definition) : NULL;
         }
+    });
+
+    for (CFIndex i = 0; i < count; i++) {
+        if (!results[i]) continue;
+
+        id<SwiffDefinition> definition = CFBridgingRelease(results[i]);
+        SwiffSparseArraySetObjectAtIndex(_definitions, [definition libraryID], definition);
+    }
+
+    CFDictionaryRemoveAllValues(_libraryIDToEntry1);
+
+    free(firsts);
+    free(results);
+}
+
+
+// Returns YES if the End tag was found
+- (BOOL) _parseTagsWithParser:(SwiffParser *)parser
+{
+    // Only whole tags are parsed while loading incrementally, including after SwiffParserFinishAppending()
+    BOOL isIncremental = (parser == _incrementalParser);
+
+    while (SwiffParserIsValid(parser)) {
+        if (isIncremental && !SwiffParserIsNextTagAvailable(parser)) {
+            return NO;
+        }
+
+        SwiffParserAdvanceToNextTag(parser);
         
-        [self setMovie:nil];
+        SwiffTag  tag     = SwiffParserGetCurrentTag(parser);
+        NSInteger version = SwiffParserGetCurrentTagVersion(parser);
+
+        if (tag == SwiffTagEnd) return YES;
+
+        BOOL defer = NO;
+        if (_libraryIDToEntry1) {
+            defer = (_options & SwiffMovieReadingLazyDefinitions) ? sIsDeferrableTag(tag) : sIsIndependentTag(tag);
+            defer = defer && ![self _hasDefinitionForCurrentTagWithParser:parser];
+        }
+
+        if (defer) {
+            [self _addTagDirectoryEntryWithParser:parser tag:tag version:version];
+        } else {
+            [self _parser:parser didFindTag:tag version:version];
+        }
     }
 
+    return NO;
+}
+
+
+- (void) _applyJPEGTablesWithParser:(SwiffParser *)parser
+{
     NSData *jpegTablesData = SwiffParserGetAssociatedValue(parser, SwiffMovieJPEGTablesDataKey);
     if (jpegTablesData) {
         NSArray *needsTables = SwiffParserGetAssociatedValue(parser, SwiffMovieNeedsJPEGTablesDataKey);
@@ -131,14 +488,73 @@ static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEG
         for (SwiffBitmapDefinition *bitmap in needsTables) {
             [bitmap _setJPEGTablesData:jpegTablesData];
         }
+
+        SwiffParserSetAssociatedValue(parser, SwiffMovieNeedsJPEGTablesDataKey, nil);
     }
-    
+}
+
+
+- (void) _decodeData:(NSData *)data
+{
+    if (!data) return;
+
+    BOOL isLazy     = (_options & SwiffMovieReadingLazyDefinitions) > 0;
+    BOOL isParallel = !isLazy && ((_options & SwiffMovieReadingParallelDefinitions) > 0);
+
+    SwiffParser *parser;
+    if (isLazy || isParallel || (_options & SwiffMovieReadingMapped)) {
+        parser = SwiffParserCreateWithBackingData([data copy]);
+    } else {
+        parser = SwiffParserCreate([data bytes], [data length]);
+    }
+
+    [self _readHeaderFromParser:parser];
+
+    if (isLazy || isParallel) {
+        _libraryIDToEntry1     = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+        _libraryIDToLastEntry1 = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+        _directoryData = SwiffParserGetBackingData(parser);
+    }
+
+    [self setMovie:self];
+    [self _parseTagsWithParser:parser];
+
+    if (isLazy || isParallel) {
+        _jpegTablesData = SwiffParserGetAssociatedValue(parser, SwiffMovieJPEGTablesDataKey);
+
+        CFRelease(_libraryIDToLastEntry1);
+        _libraryIDToLastEntry1 = NULL;
+    }
+
+    // Join all workers before the JPEG table fixups and -_parserDidEnd:, which still run in tag order
+    if (isParallel) {
+        [self _decodeTagDirectoryInParallel];
+        [self _freeTagDirectory];
+    }
+
+    [self setMovie:nil];
+
+    [self _applyJPEGTablesWithParser:parser];
     [self _parserDidEnd:parser];
 
     SwiffParserFree(parser);
 }
 
 
+- (void) _notifyLoadedFrames
+{
+    NSUInteger frameCount = [[self frames] count];
+
+    if (frameCount > _loadedFrameCount) {
+        _loadedFrameCount = frameCount;
+    
+        if ([_loadingDelegate respondsToSelector:@selector(movie:didLoadFramesThroughIndex1:)]) {
+            [_loadingDelegate movie:self didLoadFramesThroughIndex1:frameCount];
+        }
+    }
+}
+
+
 - (void) _parser:(SwiffParser *)parser didFindTag:(SwiffTag)tag version:(NSInteger)version
 {
     id<SwiffDefinition> definitionToAdd = nil;
@@ -159,6 +575,9 @@ static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEG
             NSData *data = nil;
             SwiffParserReadData(parser, remaining, &data);
             SwiffParserSetAssociatedValue(parser, SwiffMovieJPEGTablesDataKey, data);
+
+            // Deferred DefineBits tags may be decoded before the parse pass ends
+            if (_libraryIDToEntry1) _jpegTablesData = data;
         }
 
     } else if (tag == SwiffTagDefineBits || tag == SwiffTagDefineBitsLossless) {
@@ -231,12 +650,106 @@ static NSString * const SwiffMovieNeedsJPEGTablesDataKey = @"SwiffMovieNeedsJPEG
 }
 
 
+#pragma mark -
+#pragma mark Incremental Loading
+
+- (void) appendData:(NSData *)data
+{
+    SwiffParser *parser = _incrementalParser;
+    if (!parser || ![data length]) return;
+
+    SwiffParserAppendBytes(parser, [data bytes], [data length]);
+
+    BOOL foundEnd = [self _parseAvailableDataWithParser:parser];
+
+    if (foundEnd || !SwiffParserIsValid(parser) || SwiffParserIsComplete(parser)) {
+        [self finishLoading];
+    }
+}
+
+
+// Reads the header and the tags which have arrived.  Returns YES if the End tag was found
+- (BOOL) _parseAvailableDataWithParser:(SwiffParser *)parser
+{
+    if (!_didReadHeader) {
+        if (!SwiffParserIsHeaderAvailable(parser)) return NO;
+
+        [self _readHeaderFromParser:parser];
+
+        if ([_loadingDelegate respondsToSelector:@selector(movieDidLoadHeader:)]) {
+            [_loadingDelegate movieDidLoadHeader:self];
+        }
+    }
+
+    if ([self _parseTagsWithParser:parser]) {
+        _didFindEndTag = YES;
+    }
+
+    [self _applyJPEGTablesWithParser:parser];
+    [self _notifyLoadedFrames];
+
+    return _didFindEndTag;
+}
+
+
+- (void) finishLoading
+{
+    SwiffParser *parser = _incrementalParser;
+    if (!parser) return;
+
+    // A ZWS stream decodes its last bytes once no more input will arrive.  The tags in them are parsed,
+    // unless the End tag was already found
+    if (!SwiffParserIsComplete(parser) && !_didFindEndTag) {
+        SwiffParserFinishAppending(parser);
+        [self _parseAvailableDataWithParser:parser];
+    }
+
+    if (_didReadHeader) {
+        [self _applyJPEGTablesWithParser:parser];
+        [self _parserDidEnd:parser];
+    }
+
+    [self setMovie:nil];
+
+    _incrementalParser = NULL;
+    SwiffParserFree(parser);
+
+    [self _notifyLoadedFrames];
+
+    if ([_loadingDelegate respondsToSelector:@selector(movieDidFinishLoading:)]) {
+        [_loadingDelegate movieDidFinishLoading:self];
+    }
+}
+
+
+- (BOOL) isLoading
+{
+    return _incrementalParser != NULL;
+}
+
+
 #pragma mark -
 #pragma mark Public Methods
 
 id<SwiffDefinition> SwiffMovieGetDefinition(SwiffMovie *movie, UInt16 libraryID)
 {
-    return SwiffSparseArrayGetObjectAtIndex(movie->_definitions, libraryID);
+    id<SwiffDefinition> definition = SwiffSparseArrayGetObjectAtIndex(movie->_definitions, libraryID);
+
+    if (!definition && movie->_libraryIDToEntry1) {
+        definition = [movie _decodeDefinitionWithLibraryID:libraryID];
+    }
+
+    return definition;
+}
+
+
+Class SwiffMovieGetDefinitionClass(SwiffMovie *movie, UInt16 libraryID)
+{
+    id<SwiffDefinition> definition = SwiffSparseArrayGetObjectAtIndex(movie->_definitions, libraryID);
+    if (definition) return [definition class];
+
+    NSUInteger index1 = [movie _firstTagDirectoryEntry1ForLibraryID:libraryID];
+    return index1 ? sGetDefinitionClassForTag(movie->_directory[index1 - 1].tag) : nil;
 }
 
 
@@ -283,4 +796,24 @@ id<SwiffDefinition> SwiffMovieGetDefinition(SwiffMovie *movie, UInt16 libraryID)
     return &_backgroundColor;
 }
 
+
+- (SwiffDisplayListCache *) displayListCache
+{
+    if (!_displayListCache) {
+        _displayListCache = [[SwiffDisplayListCache alloc] init];
+    }
+
+    return _displayListCache;
+}
+
+
+- (SwiffBitmapCache *) bitmapCache
+{
+    if (!_bitmapCache) {
+        _bitmapCache = [[SwiffBitmapCache alloc] init];
+    }
+
+    return _bitmapCache;
+}
+
 @end
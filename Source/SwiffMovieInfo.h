@@ -0,0 +1,67 @@
+/*
+    SwiffMovieInfo.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+#import <SwiffTypes.h>
+
+
+// A lightweight description of a movie, gathered by walking its tags without decoding any
+// definitions.  Useful for indexing many files; use SwiffMovie to display one
+//
+@interface SwiffMovieInfo : NSObject
+
+- (id) initWithData:(NSData *)data;
+- (id) initWithContentsOfFile:(NSString *)path;
+
+// Only reads (and decompresses) the header, leaving the tag properties empty
+- (id) initWithData:(NSData *)data headerOnly:(BOOL)headerOnly;
+
+// Header
+@property (nonatomic, assign, readonly) NSInteger version;
+@property (nonatomic, assign, readonly, getter=isCompressed) BOOL compressed;
+@property (nonatomic, assign, readonly) SwiffCompression compression;
+@property (nonatomic, assign, readonly) NSUInteger fileLength;
+@property (nonatomic, assign, readonly) CGRect stageRect;
+@property (nonatomic, assign, readonly) CGFloat frameRate;
+@property (nonatomic, assign, readonly) NSUInteger frameCount;
+
+// Tags
+@property (nonatomic, assign, readonly) SwiffColor backgroundColor;
+@property (nonatomic, assign, readonly) BOOL hasBackgroundColor;
+
+@property (nonatomic, strong, readonly) NSArray *sceneNames;                   // In timeline order
+@property (nonatomic, strong, readonly) NSDictionary *frameIndexToLabelMap;    // NSNumber -> NSString
+
+@property (nonatomic, strong, readonly) NSDictionary *libraryIDToTagMap;       // NSNumber -> NSNumber of the SwiffTag which defines it
+@property (nonatomic, strong, readonly) NSDictionary *libraryIDToExportNameMap; // NSNumber -> NSString, from ExportAssets and SymbolClass
+
+@property (nonatomic, strong, readonly) NSDictionary *tagToByteCountMap;       // NSNumber of a SwiffTag -> NSNumber of body bytes
+
+// NO if the data is not a .swf file, or if the tags are truncated
+@property (nonatomic, assign, readonly, getter=isValid) BOOL valid;
+
+@end
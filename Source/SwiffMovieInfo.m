@@ -0,0 +1,266 @@
+/*
+    SwiffMovieInfo.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffMovieInfo.h"
+
+#import "SwiffParser.h"
+#import "SwiffSceneAndFrameLabelData.h"
+#import "SwiffUtils.h"
+
+
+// Compressed data is fed to an incremental parser in chunks, so that decompression stops
+// once the End tag (or, for header-only reads, the header) has been reached
+static const NSUInteger sChunkLength = 64 * 1024;
+
+
+static BOOL sIsDefinitionTag(SwiffTag tag)
+{
+    return (tag == SwiffTagDefineShape)       ||
+           (tag == SwiffTagDefineBits)        ||
+           (tag == SwiffTagDefineBitsLossless)||
+           (tag == SwiffTagDefineButton)      ||
+           (tag == SwiffTagDefineFont)        ||
+           (tag == SwiffTagDefineText)        ||
+           (tag == SwiffTagDefineEditText)    ||
+           (tag == SwiffTagDefineSound)       ||
+           (tag == SwiffTagDefineSprite)      ||
+           (tag == SwiffTagDefineMorphShape)  ||
+           (tag == SwiffTagDefineVideoStream) ||
+           (tag == SwiffTagDefineBinaryData);
+}
+
+
+@implementation SwiffMovieInfo {
+    NSMutableArray      *_sceneNames;
+    NSMutableDictionary *_frameIndexToLabelMap;
+    NSMutableDictionary *_libraryIDToTagMap;
+    NSMutableDictionary *_libraryIDToExportNameMap;
+    NSMutableDictionary *_tagToByteCountMap;
+    NSUInteger           _frameIndex;
+}
+
+@synthesize sceneNames               = _sceneNames,
+            frameIndexToLabelMap     = _frameIndexToLabelMap,
+            libraryIDToTagMap        = _libraryIDToTagMap,
+            libraryIDToExportNameMap = _libraryIDToExportNameMap,
+            tagToByteCountMap        = _tagToByteCountMap;
+
+
+- (id) initWithData:(NSData *)data
+{
+    return [self initWithData:data headerOnly:NO];
+}
+
+
+- (id) initWithContentsOfFile:(NSString *)path
+{
+    NSError *error = nil;
+    NSData  *data  = [[NSData alloc] initWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:&error];
+
+    if (!data) {
+        SwiffWarn(@"Movie", @"Could not read %@: %@", path, error);
+        return nil;
+    }
+
+    return [self initWithData:data headerOnly:NO];
+}
+
+
+- (id) initWithData:(NSData *)data headerOnly:(BOOL)headerOnly
+{
+    if ((self = [super init])) {
+        _sceneNames               = [[NSMutableArray alloc] init];
+        _frameIndexToLabelMap     = [[NSMutableDictionary alloc] init];
+        _libraryIDToTagMap        = [[NSMutableDictionary alloc] init];
+        _libraryIDToExportNameMap = [[NSMutableDictionary alloc] init];
+        _tagToByteCountMap        = [[NSMutableDictionary alloc] init];
+
+        [self _readData:data headerOnly:headerOnly];
+    }
+    
+    return self;
+}
+
+
+#pragma mark -
+#pragma mark Private Methods
+
+- (BOOL) _readHeaderFromParser:(SwiffParser *)parser
+{
+    SwiffHeader header;
+    BOOL isValid = SwiffParserReadHeader(parser, &header);
+
+    _version     = header.version;
+    _compressed  = header.isCompressed;
+    _compression = header.compression;
+    _fileLength  = header.fileLength;
+    _stageRect   = header.stageRect;
+    _frameRate   = header.frameRate;
+    _frameCount  = header.frameCount;
+
+    if (_version < 6) {
+        SwiffParserSetStringEncoding(parser, SwiffGetLegacyStringEncoding());
+    }
+
+    return isValid;
+}
+
+
+- (void) _readSceneAndFrameLabelDataFromParser:(SwiffParser *)parser
+{
+    SwiffSceneAndFrameLabelData *data = [[SwiffSceneAndFrameLabelData alloc] initWithParser:parser movie:nil];
+
+    NSDictionary *offsetToSceneNameMap = [data offsetToSceneNameMap];
+    NSArray      *offsets = [[offsetToSceneNameMap allKeys] sortedArrayUsingSelector:@selector(compare:)];
+
+    [_sceneNames removeAllObjects];
+    for (NSNumber *offset in offsets) {
+        [_sceneNames addObject:[offsetToSceneNameMap objectForKey:offset]];
+    }
+
+    [_frameIndexToLabelMap addEntriesFromDictionary:[data numberToFrameLabelMap]];
+}
+
+
+- (void) _readExportNamesFromParser:(SwiffParser *)parser
+{
+    UInt16 count = 0;
+    SwiffParserReadUInt16(parser, &count);
+
+    for (UInt16 i = 0; i < count; i++) {
+        UInt16 libraryID = 0;
+        SwiffParserReadUInt16(parser, &libraryID);
+
+        NSString *name = nil;
+        SwiffParserReadString(parser, &name);
+
+        if (!SwiffParserIsValid(parser)) break;
+
+        if (name) {
+            [_libraryIDToExportNameMap setObject:name forKey:@(libraryID)];
+        }
+    }
+}
+
+
+// Returns YES if the End tag was found
+- (BOOL) _readTagsFromParser:(SwiffParser *)parser
+{
+    while (SwiffParserIsValid(parser)) {
+        if (!SwiffParserIsNextTagAvailable(parser)) {
+            return NO;
+        }
+
+        SwiffParserAdvanceToNextTag(parser);
+
+        SwiffTag tag = SwiffParserGetCurrentTag(parser);
+        if (tag == SwiffTagEnd) return YES;
+
+        NSNumber  *tagNumber = @(tag);
+        NSUInteger length    = SwiffParserGetBytesRemainingInCurrentTag(parser);
+        NSUInteger total     = [[_tagToByteCountMap objectForKey:tagNumber] unsignedIntegerValue] + length;
+
+        [_tagToByteCountMap setObject:@(total) forKey:tagNumber];
+
+        // Only the leading fields of a tag are read, the rest of the body is skipped
+        if (sIsDefinitionTag(tag)) {
+            UInt16 libraryID = 0;
+            SwiffParserReadUInt16(parser, &libraryID);
+            [_libraryIDToTagMap setObject:tagNumber forKey:@(libraryID)];
+
+        } else if (tag == SwiffTagSetBackgroundColor) {
+            SwiffParserReadColorRGB(parser, &_backgroundColor);
+            _hasBackgroundColor = YES;
+
+        } else if (tag == SwiffTagShowFrame) {
+            _frameIndex++;
+
+        } else if (tag == SwiffTagFrameLabel) {
+            NSString *label = nil;
+            SwiffParserReadString(parser, &label);
+            if (label) [_frameIndexToLabelMap setObject:label forKey:@(_frameIndex)];
+
+        } else if (tag == SwiffTagDefineSceneAndFrameLabelData) {
+            [self _readSceneAndFrameLabelDataFromParser:parser];
+
+        } else if ((tag == SwiffTagExportAssets) || (tag == SwiffTagSymbolClass)) {
+            [self _readExportNamesFromParser:parser];
+        }
+    }
+
+    return NO;
+}
+
+
+- (void) _readData:(NSData *)data headerOnly:(BOOL)headerOnly
+{
+    const UInt8 *bytes  = [data bytes];
+    NSUInteger   length = [data length];
+
+    if (length < 8) return;
+
+    // Uncompressed files are parsed in place
+    BOOL isIncremental = (bytes[0] != 'F');
+    SwiffParser *parser = isIncremental ? SwiffParserCreateIncremental() : SwiffParserCreate(bytes, length);
+
+    NSUInteger offset        = 0;
+    BOOL       didReadHeader = NO;
+    BOOL       didFindEnd    = NO;
+
+    while (!didFindEnd) {
+        if (isIncremental) {
+            if (offset >= length) break;
+
+            NSUInteger chunkLength = MIN(length - offset, sChunkLength);
+            if (!SwiffParserAppendBytes(parser, bytes + offset, chunkLength)) break;
+            offset += chunkLength;
+        }
+
+        if (!didReadHeader) {
+            if (!SwiffParserIsHeaderAvailable(parser)) {
+                if (isIncremental) continue;
+                break;
+            }
+
+            if (![self _readHeaderFromParser:parser]) break;
+            didReadHeader = YES;
+
+            if (headerOnly) break;
+        }
+
+        didFindEnd = [self _readTagsFromParser:parser];
+
+        if (!isIncremental) break;
+    }
+
+    _valid = didReadHeader && (headerOnly || didFindEnd);
+
+    SwiffParserFree(parser);
+}
+
+
+@end
@@ -32,10 +32,32 @@
 typedef struct SwiffParser SwiffParser;
 
 extern SwiffParser *SwiffParserCreate(const UInt8 *buffer, NSUInteger length);
+
+// SwiffParserReadData() on this parser returns slices which retain data (or the decompressed
+// buffer of a CWS or ZWS file) rather than copies.  Use with mapped data to keep pages clean
+extern SwiffParser *SwiffParserCreateWithBackingData(NSData *data);
+
+// The backing data (after SwiffParserReadHeader(), the decompressed data of a CWS or ZWS file)
+extern NSData *SwiffParserGetBackingData(SwiffParser *parser);
 extern void SwiffParserFree(SwiffParser *reader);
 
 extern BOOL SwiffParserReadHeader(SwiffParser *parser, SwiffHeader *outHeader);
 
+// Incremental parsing.  The parser owns its buffer and decompresses CWS/ZWS data as it is appended.
+// Reads must stay within bytes that have already arrived: check SwiffParserIsHeaderAvailable()
+// before SwiffParserReadHeader() and SwiffParserIsNextTagAvailable() before each
+// SwiffParserAdvanceToNextTag()
+//
+extern SwiffParser *SwiffParserCreateIncremental(void);
+extern BOOL SwiffParserAppendBytes(SwiffParser *parser, const UInt8 *bytes, NSUInteger length);
+
+// Notes that no more bytes will be appended.  A ZWS stream holds back its last bytes until then
+extern void SwiffParserFinishAppending(SwiffParser *parser);
+extern BOOL SwiffParserIsComplete(SwiffParser *parser);
+
+extern BOOL SwiffParserIsHeaderAvailable(SwiffParser *parser);
+extern BOOL SwiffParserIsNextTagAvailable(SwiffParser *parser);
+
 extern void SwiffParserAdvance(SwiffParser *parser, NSUInteger length);
 extern BOOL SwiffParserIsValid(SwiffParser *parser);
 
@@ -55,6 +77,9 @@ extern NSStringEncoding SwiffParserGetStringEncoding(SwiffParser *parser);
 extern void SwiffParserAdvanceToNextTag(SwiffParser *parser);
 extern NSUInteger SwiffParserGetBytesRemainingInCurrentTag(SwiffParser *parser);
 
+// Offset of the current tag's RECORDHEADER from the start of the (decompressed) buffer
+extern NSUInteger SwiffParserGetCurrentTagOffset(SwiffParser *parser);
+
 extern SwiffTag  SwiffParserGetCurrentTag(SwiffParser *parser);
 extern NSInteger SwiffParserGetCurrentTagVersion(SwiffParser *parser);
 
@@ -100,6 +125,7 @@ extern void SwiffParserReadColorTransformWithAlpha(SwiffParser *parser, SwiffCol
 
 // Objects
 //
+// Copies the bytes, unless the parser was created with SwiffParserCreateWithBackingData()
 extern void SwiffParserReadData(SwiffParser *parser, NSUInteger length, NSData **outValue);
 
 extern void SwiffParserReadString(SwiffParser *parser, NSString **outValue);
@@ -27,6 +27,7 @@
 
 #import "SwiffParser.h"
 
+#import "SwiffLZMA.h"
 #import "SwiffUtils.h"
 
 #include <stdlib.h>
@@ -35,10 +36,18 @@
 #include <string.h>
 
 
+@interface SwiffParserDataSlice : NSData
+- (id) initWithBackingData:(NSData *)backingData bytes:(const UInt8 *)bytes length:(NSUInteger)length;
+@end
+
+
 struct SwiffParser {
+    CFDataRef     backingData;
     const UInt8  *buffer;
     const UInt8  *end;
+    const UInt8  *wordEnd;  // Last position at which an unchecked 64-bit load may start
     const UInt8  *b;
+    const UInt8  *tagB;
     const UInt8  *nextTagB;
     
     CFMutableDictionaryRef values;
@@ -46,27 +55,50 @@ struct SwiffParser {
 
     NSUInteger    length;
 
-    UInt8         bitPosition;
-    UInt8         bitByte;
+    UInt8         bitPosition;  // When non-zero, bits are being consumed from b[-1]
     UInt8         isValid;
     Boolean       bufferNeedsFree;
 
     UInt16        currentTag;
     UInt8         currentTagVersion;
+
+    // Incremental parsing
+    z_stream     *stream;
+    SwiffLZMADecoder *lzmaDecoder;
+    NSUInteger    capacity;
+    UInt8         headerBytes[12 + SwiffLZMAPropertiesLength];
+    UInt8         headerBytesCount;
+    Boolean       isIncremental;
+    Boolean       isComplete;
 };
 
 void SwiffParserEnsureBufferError(SwiffParser *parser);
 
 
+static void sSetAvailableLength(SwiffParser *parser, NSUInteger length)
+{
+    parser->length  = length;
+    parser->end     = parser->buffer + length;
+    parser->wordEnd = (length >= sizeof(UInt64)) ? (parser->end - sizeof(UInt64)) : NULL;
+}
+
+
+static void sSetBuffer(SwiffParser *parser, const UInt8 *buffer, NSUInteger length)
+{
+    parser->buffer = buffer;
+    parser->b      = buffer;
+
+    sSetAvailableLength(parser, length);
+}
+
+
 SwiffParser *SwiffParserCreate(const UInt8 *buffer, NSUInteger length)
 {
     SwiffParser *parser = calloc(1, sizeof(SwiffParser));
 
-    parser->buffer      = buffer;
-    parser->length      = length;
-    parser->b           = parser->buffer;
+    sSetBuffer(parser, buffer, length);
+
     parser->bitPosition = 0;
-    parser->bitByte     = 0;
     parser->isValid     = YES;
     parser->encoding    = NSUTF8StringEncoding;
 
@@ -74,8 +106,37 @@ SwiffParser *SwiffParserCreate(const UInt8 *buffer, NSUInteger length)
 }
 
 
+SwiffParser *SwiffParserCreateWithBackingData(NSData *data)
+{
+    SwiffParser *parser = SwiffParserCreate([data bytes], [data length]);
+
+    if (data) {
+        parser->backingData = CFRetain((__bridge CFDataRef)data);
+    }
+
+    return parser;
+}
+
+
+SwiffParser *SwiffParserCreateIncremental(void)
+{
+    SwiffParser *parser = SwiffParserCreate(NULL, 0);
+    parser->isIncremental = YES;
+    return parser;
+}
+
+
 extern void SwiffParserFree(SwiffParser *parser)
 {
+    if (parser->stream) {
+        inflateEnd(parser->stream);
+        free(parser->stream);
+    }
+
+    if (parser->lzmaDecoder) {
+        SwiffLZMADecoderFree(parser->lzmaDecoder);
+    }
+
     if (parser->bufferNeedsFree) {
         free((void *)parser->buffer);
     }
@@ -84,6 +145,10 @@ extern void SwiffParserFree(SwiffParser *parser)
         CFRelease(parser->values);
     }
 
+    if (parser->backingData) {
+        CFRelease(parser->backingData);
+    }
+
     free(parser);
 }
 
@@ -117,6 +182,21 @@ static BOOL sInflate(const UInt8 *inBuffer, UInt32 inLength, UInt8 *outBuffer, U
 }
 
 
+// Replaces the buffer with a decompressed one, which the parser takes ownership of
+static void sSetDecompressedBuffer(SwiffParser *parser, UInt8 *buffer, NSUInteger length)
+{
+    sSetBuffer(parser, buffer, length);
+
+    // Slices now point into the decompressed buffer, which becomes the new backing data
+    if (parser->backingData) {
+        CFRelease(parser->backingData);
+        parser->backingData = CFDataCreateWithBytesNoCopy(NULL, buffer, length, kCFAllocatorMalloc);
+    } else {
+        parser->bufferNeedsFree = YES;
+    }
+}
+
+
 void SwiffParserEnsureBufferError(SwiffParser *parser)
 {
     SwiffWarn(@"Parser", @"SwiffParser %p is no longer valid.  Break on SwiffParserEnsureBufferError to debug.", parser);
@@ -125,7 +205,7 @@ void SwiffParserEnsureBufferError(SwiffParser *parser)
 
 static BOOL sEnsureBuffer(SwiffParser *parser, NSUInteger length)
 {
-    BOOL yn = ((parser->b + length) <= (parser->buffer + parser->length));
+    BOOL yn = ((parser->b + length) <= parser->end);
 
     if (!yn) {
         SwiffParserEnsureBufferError(parser);
@@ -136,6 +216,215 @@ static BOOL sEnsureBuffer(SwiffParser *parser, NSUInteger length)
 }
 
 
+#pragma mark -
+#pragma mark Incremental
+
+// 'ZWS' files have a UI32 compressed length and the LZMA properties between the header and the stream
+static NSUInteger sGetHeaderBytesLength(SwiffParser *parser)
+{
+    BOOL isLZMA = (parser->headerBytesCount > 0) && (parser->headerBytes[0] == 'Z');
+    return isLZMA ? sizeof(parser->headerBytes) : 8;
+}
+
+
+static BOOL sAppendHeaderBytes(SwiffParser *parser, const UInt8 **inOutBytes, NSUInteger *inOutLength)
+{
+    const UInt8 *bytes  = *inOutBytes;
+    NSUInteger   length = *inOutLength;
+
+    while (length && (parser->headerBytesCount < sGetHeaderBytesLength(parser))) {
+        parser->headerBytes[parser->headerBytesCount++] = *bytes++;
+        length--;
+    }
+
+    *inOutBytes  = bytes;
+    *inOutLength = length;
+
+    if (parser->headerBytesCount < sGetHeaderBytesLength(parser)) {
+        return YES;
+    }
+
+    const UInt8 *h = parser->headerBytes;
+    BOOL   isCompressed = (h[0] == 'C');
+    BOOL   isLZMA       = (h[0] == 'Z');
+    UInt32 fileLength   = h[4] | (h[5] << 8) | (h[6] << 16) | ((UInt32)h[7] << 24);
+
+    if (!(h[0] == 'F' || isCompressed || isLZMA) || h[1] != 'W' || h[2] != 'S' || (fileLength < 8)) {
+        return NO;
+    }
+
+    // fileLength is the uncompressed size of the entire file, including the 8 header bytes.
+    // Allocating it up front keeps the buffer (and every pointer into it) stable as data arrives.
+    //
+    UInt8 *buffer = malloc(fileLength);
+    if (!buffer) return NO;
+
+    // Only the signature, version and length are kept, so that the buffer has the same layout for all three signatures
+    memcpy(buffer, h, 8);
+
+    parser->buffer   = buffer;
+    parser->b        = buffer;
+    parser->capacity = fileLength;
+    parser->bufferNeedsFree = YES;
+    sSetAvailableLength(parser, 8);
+
+    if (isCompressed) {
+        parser->stream = calloc(1, sizeof(z_stream));
+
+        if (!parser->stream || (inflateInit(parser->stream) != Z_OK)) {
+            free(parser->stream);
+            parser->stream = NULL;
+            return NO;
+        }
+
+    } else if (isLZMA) {
+        // As with SwiffParserReadHeader(), the compressed length is ignored.  The end of the
+        // input is instead given by SwiffParserFinishAppending()
+        parser->lzmaDecoder = SwiffLZMADecoderCreate(h + 12, buffer + 8, fileLength - 8);
+        if (!parser->lzmaDecoder) return NO;
+    }
+
+    return YES;
+}
+
+
+BOOL SwiffParserAppendBytes(SwiffParser *parser, const UInt8 *bytes, NSUInteger length)
+{
+    if (!parser->isIncremental || !parser->isValid) {
+        return NO;
+    }
+
+    if (!parser->capacity) {
+        if (!sAppendHeaderBytes(parser, &bytes, &length)) {
+            parser->isValid = NO;
+            return NO;
+        }
+
+        if (!parser->capacity) return YES;
+    }
+
+    UInt8     *out       = (UInt8 *)parser->buffer + parser->length;
+    NSUInteger available = parser->capacity - parser->length;
+    NSUInteger produced  = 0;
+
+    if (parser->stream) {
+        z_stream *stream = parser->stream;
+
+        stream->next_in   = (Bytef *)bytes;
+        stream->avail_in  = (uInt)length;
+        stream->next_out  = (Bytef *)out;
+        stream->avail_out = (uInt)available;
+
+        int err = inflate(stream, Z_NO_FLUSH);
+        produced = available - stream->avail_out;
+
+        if (err == Z_STREAM_END) {
+            inflateEnd(stream);
+            free(stream);
+            parser->stream = NULL;
+            parser->isComplete = YES;
+
+        } else if ((err != Z_OK) && (err != Z_BUF_ERROR)) {
+            parser->isValid = NO;
+        }
+
+    } else if (parser->lzmaDecoder) {
+        SwiffLZMADecoder *decoder = parser->lzmaDecoder;
+        NSUInteger before = SwiffLZMADecoderGetOutputLength(decoder);
+
+        if (!SwiffLZMADecoderAppendBytes(decoder, bytes, length)) {
+            parser->isValid = NO;
+        }
+
+        produced = SwiffLZMADecoderGetOutputLength(decoder) - before;
+
+        if (SwiffLZMADecoderIsFinished(decoder)) {
+            SwiffLZMADecoderFree(decoder);
+            parser->lzmaDecoder = NULL;
+            parser->isComplete = YES;
+        }
+
+    } else {
+        produced = MIN(length, available);
+        memcpy(out, bytes, produced);
+    }
+
+    sSetAvailableLength(parser, parser->length + produced);
+
+    if (parser->length == parser->capacity) {
+        parser->isComplete = YES;
+    }
+
+    return parser->isValid;
+}
+
+
+void SwiffParserFinishAppending(SwiffParser *parser)
+{
+    if (!parser->isIncremental || parser->isComplete) return;
+
+    if (parser->lzmaDecoder) {
+        SwiffLZMADecoder *decoder = parser->lzmaDecoder;
+        NSUInteger before = SwiffLZMADecoderGetOutputLength(decoder);
+
+        if (!SwiffLZMADecoderFinish(decoder)) {
+            parser->isValid = NO;
+        }
+
+        sSetAvailableLength(parser, parser->length + (SwiffLZMADecoderGetOutputLength(decoder) - before));
+
+        SwiffLZMADecoderFree(decoder);
+        parser->lzmaDecoder = NULL;
+    }
+
+    parser->isComplete = YES;
+}
+
+
+BOOL SwiffParserIsComplete(SwiffParser *parser)
+{
+    return !parser->isIncremental || parser->isComplete;
+}
+
+
+BOOL SwiffParserIsHeaderAvailable(SwiffParser *parser)
+{
+    // 8 byte signature/version/length, then a RECT, FIXED8 frame rate, and UI16 frame count
+    NSUInteger fixedLength = 8;
+
+    if (parser->length < (fixedLength + 1)) {
+        return NO;
+    }
+
+    UInt8 nBits = parser->buffer[fixedLength] >> 3;
+    NSUInteger rectLength = ((5 + (nBits * 4)) + 7) / 8;
+
+    return parser->length >= (fixedLength + rectLength + 4);
+}
+
+
+BOOL SwiffParserIsNextTagAvailable(SwiffParser *parser)
+{
+    const UInt8 *b = parser->nextTagB ? parser->nextTagB : parser->b;
+
+    if (!b || (parser->end - b) < 2) {
+        return NO;
+    }
+
+    UInt32 length = (b[0] | (b[1] << 8)) & 0x3F;
+    b += 2;
+
+    // Long RECORDHEADER
+    if (length == 0x3F) {
+        if ((parser->end - b) < 4) return NO;
+        length = b[0] | (b[1] << 8) | (b[2] << 16) | ((UInt32)b[3] << 24);
+        b += 4;
+    }
+
+    return (NSUInteger)(parser->end - b) >= length;
+}
+
+
 BOOL SwiffParserReadHeader(SwiffParser *parser, SwiffHeader *outHeader)
 {
     UInt8  sig1 = 0, sig2 = 0, sig3 = 0, version = 0;
@@ -150,17 +439,40 @@ BOOL SwiffParserReadHeader(SwiffParser *parser, SwiffHeader *outHeader)
 
     SwiffParserReadUInt32(parser, &fileLength);
 
-    if (sig1 == 'C' && sig2 == 'W' && sig3 == 'S') {
+    BOOL isLZMA = (sig1 == 'Z');
+
+    if ((sig1 == 'C' || isLZMA) && sig2 == 'W' && sig3 == 'S' && parser->isIncremental) {
+        // Incremental parsers decompress as bytes are appended
+        isCompressed = YES;
+
+    } else if (sig1 == 'C' && sig2 == 'W' && sig3 == 'S') {
         isCompressed = YES;
 
         UInt8 *newBuffer = fileLength ? (UInt8 *)malloc(fileLength) : NULL;
 
         if (newBuffer && sInflate(parser->b, (UInt32)(parser->length - 8), newBuffer, fileLength)) {
-            parser->buffer = newBuffer;
-            parser->b      = parser->buffer;
-            parser->length = fileLength;
-            parser->bufferNeedsFree = YES;
-        
+            sSetDecompressedBuffer(parser, newBuffer, fileLength);
+        } else {
+            free(newBuffer);
+            didInflateFail = YES;
+        }
+
+    } else if (isLZMA && sig2 == 'W' && sig3 == 'S') {
+        isCompressed = YES;
+
+        UInt32 compressedLength = 0;
+        SwiffParserReadUInt32(parser, &compressedLength);
+
+        const UInt8 *properties = parser->b;
+        SwiffParserAdvance(parser, SwiffLZMAPropertiesLength);
+
+        // Some writers store an incorrect compressed length, the uncompressed length is authoritative
+        NSUInteger inLength  = SwiffParserIsValid(parser) ? (parser->end - parser->b) : 0;
+        NSUInteger outLength = (fileLength > 8) ? (fileLength - 8) : 0;
+        UInt8     *newBuffer = outLength ? (UInt8 *)malloc(outLength) : NULL;
+
+        if (newBuffer && SwiffLZMADecode(properties, parser->b, inLength, newBuffer, outLength)) {
+            sSetDecompressedBuffer(parser, newBuffer, outLength);
         } else {
             free(newBuffer);
             didInflateFail = YES;
@@ -179,13 +491,14 @@ BOOL SwiffParserReadHeader(SwiffParser *parser, SwiffHeader *outHeader)
     if (outHeader) {
         outHeader->version      = version;
         outHeader->isCompressed = isCompressed;
+        outHeader->compression  = isLZMA ? SwiffCompressionLZMA : SwiffCompressionZlib;
         outHeader->fileLength   = fileLength;
         outHeader->stageRect    = stageRect;
         outHeader->frameRate    = frameRate;
         outHeader->frameCount   = frameCount;
     }
     
-    return (sig1 == 'F' || sig1 == 'C') &&
+    return (sig1 == 'F' || sig1 == 'C' || sig1 == 'Z') &&
             sig2 == 'W' &&
             sig3 == 'S' &&
            !didInflateFail &&
@@ -215,6 +528,12 @@ const UInt8 *SwiffParserGetCurrentBytePointer(SwiffParser *parser)
 }
 
 
+NSData *SwiffParserGetBackingData(SwiffParser *parser)
+{
+    return (__bridge NSData *)parser->backingData;
+}
+
+
 void SwiffParserSetStringEncoding(SwiffParser *parser, NSStringEncoding encoding)
 {
     parser->encoding = encoding;
@@ -266,6 +585,7 @@ void SwiffParserAdvanceToNextTag(SwiffParser *parser)
     
     SwiffParserByteAlign(parser);
 
+    parser->tagB = parser->b;
     SwiffParserReadUInt16(parser, &tagCodeAndLength);
 
     SwiffTag  tag     = (tagCodeAndLength >> 6);
@@ -287,6 +607,12 @@ void SwiffParserAdvanceToNextTag(SwiffParser *parser)
 }
 
 
+NSUInteger SwiffParserGetCurrentTagOffset(SwiffParser *parser)
+{
+    return parser->tagB ? (parser->tagB - parser->buffer) : 0;
+}
+
+
 NSUInteger SwiffParserGetBytesRemainingInCurrentTag(SwiffParser *parser)
 {
     return (parser->nextTagB - parser->b);
@@ -311,7 +637,6 @@ NSInteger SwiffParserGetCurrentTagVersion(SwiffParser *parser)
 void SwiffParserByteAlign(SwiffParser *parser)
 {
     parser->bitPosition = 0;
-    parser->bitByte     = 0;
 }
 
 
@@ -342,24 +667,52 @@ void SwiffParserReadSBits(SwiffParser *parser, UInt8 numberOfBits, SInt32 *outVa
 
 void SwiffParserReadUBits(SwiffParser *parser, UInt8 numberOfBits, UInt32 *outValue)
 {
-    int i;
     UInt32 value = 0;
-    UInt8 bp = parser->bitPosition;
 
-    for (i = 0; i < numberOfBits; i++) {
-        if (bp == 0) {
-            if (!sEnsureBuffer(parser, 1)) break;
-            parser->bitByte = *((UInt8 *)parser->b);
-            parser->b++;
+    if (numberOfBits > 0 && numberOfBits <= 32) {
+        UInt8 bp = parser->bitPosition;
+
+        // p points at the byte holding the next unread bit.  A field spans at most
+        // 7 + 32 = 39 bits, so a single big-endian 64-bit word always covers it.
+        //
+        const UInt8 *p          = bp ? (parser->b - 1) : parser->b;
+        NSUInteger   totalBits  = bp + numberOfBits;
+        NSUInteger   usedBytes  = totalBits >> 3;
+        UInt64       word;
+
+        if (parser->wordEnd && (p <= parser->wordEnd)) {
+            // Fast path: the 8-byte window lies inside the buffer, no per-byte checks
+            memcpy(&word, p, sizeof(UInt64));
+            word = CFSwapInt64BigToHost(word);
+
+        } else {
+            NSUInteger touchedBytes = (totalBits + 7) >> 3;
+
+            if ((p + touchedBytes) > parser->end) {
+                SwiffParserEnsureBufferError(parser);
+                parser->isValid = NO;
+                if (outValue) *outValue = 0;
+                return;
+            }
+
+            word = 0;
+            for (NSUInteger i = 0; i < touchedBytes; i++) {
+                word |= ((UInt64)p[i] << (56 - (i * 8)));
+            }
         }
 
-        UInt8 bit = ((parser->bitByte >> (7 - bp)) & 0x1);
-        value = (value << 1) + bit;
+        value = (UInt32)((word << bp) >> (64 - numberOfBits));
 
-        bp = (bp + 1) % 8;
-    }
+        bp = (totalBits & 0x7);
+        parser->b = p + usedBytes + (bp ? 1 : 0);
+        parser->bitPosition = bp;
 
-    parser->bitPosition = bp;
+    } else if (numberOfBits > 32) {
+        // Fields wider than the output keep only their low 32 bits
+        UInt32 ignored;
+        SwiffParserReadUBits(parser, numberOfBits - 32, &ignored);
+        SwiffParserReadUBits(parser, 32, &value);
+    }
 
     if (outValue) {
         *outValue = value;
@@ -721,7 +1074,11 @@ void SwiffParserReadData(SwiffParser *parser, NSUInteger length, NSData **outVal
     }
 
     if (outValue) {
-        *outValue = [[NSData alloc] initWithBytes:parser->b length:length];
+        if (parser->backingData) {
+            *outValue = [[SwiffParserDataSlice alloc] initWithBackingData:(__bridge NSData *)parser->backingData bytes:parser->b length:length];
+        } else {
+            *outValue = [[NSData alloc] initWithBytes:parser->b length:length];
+        }
     }
 
     SwiffParserAdvance(parser, length);
@@ -775,3 +1132,30 @@ void SwiffParserReadLengthPrefixedString(SwiffParser *parser, NSString **outValu
     SwiffParserAdvance(parser, length);
 }
 
+
+#pragma mark -
+#pragma mark Data Slices
+
+@implementation SwiffParserDataSlice {
+    NSData      *_backingData;
+    const UInt8 *_bytes;
+    NSUInteger   _length;
+}
+
+
+- (id) initWithBackingData:(NSData *)backingData bytes:(const UInt8 *)bytes length:(NSUInteger)length
+{
+    if ((self = [super init])) {
+        _backingData = backingData;
+        _bytes       = bytes;
+        _length      = length;
+    }
+
+    return self;
+}
+
+
+- (const void *) bytes    { return _bytes;  }
+- (NSUInteger)   length   { return _length; }
+
+@end
@@ -26,41 +26,69 @@
 */
 
 #import <SwiffImport.h>
+#import <SwiffTypes.h>
 
 @class SwiffLineStyle, SwiffFillStyle;
 
 typedef NS_ENUM(UInt8, SwiffPathOperation) {
     SwiffPathOperationEnd            = 0,
-    SwiffPathOperationMove           = 1,  // Corresponds to 2 floats in -floats : { CGFloat toX, CGFloat toY }
-    SwiffPathOperationLine           = 2,  // Corresponds to 2 floats in -floats : { CGFloat toX, CGFloat toY }
-    SwiffPathOperationHorizontalLine = 3,  // Corresponds to 1 float  in -floats : { CGFloat toX }
-    SwiffPathOperationVerticalLine   = 4,  // Corresponds to 1 float  in -floats : { CGFloat toY }
-    SwiffPathOperationCurve          = 5   // Corresponds to 4 floats in -floats : { CGFloat toX, CGFloat toY, CGFloat controlX, CGFloat controlY }
+    SwiffPathOperationMove           = 1,  // Corresponds to 1 point in -xCoordinates/-yCoordinates : { to }
+    SwiffPathOperationLine           = 2,  // Corresponds to 1 point in -xCoordinates/-yCoordinates : { to }
+    SwiffPathOperationHorizontalLine = 3,  // Corresponds to 1 point in -xCoordinates/-yCoordinates : { to }, to.y is the current y
+    SwiffPathOperationVerticalLine   = 4,  // Corresponds to 1 point in -xCoordinates/-yCoordinates : { to }, to.x is the current x
+    SwiffPathOperationCurve          = 5   // Corresponds to 2 points in -xCoordinates/-yCoordinates : { control, to }
 };
 
 
 @class SwiffPath;
-extern void SwiffPathAddOperationAndTwips(SwiffPath *path, SwiffPathOperation operation, /*SwiffTwips*/ ...);
+
+// Sizes the storage of path for the given number of operations and points.  Optional, but
+// avoids reallocation when the caller knows (an upper bound of) the final size.
+extern void SwiffPathReserveCapacity(SwiffPath *path, NSUInteger operationsCount, NSUInteger pointsCount);
+
+extern void SwiffPathAddMove(SwiffPath *path, SwiffPoint toPoint);
+extern void SwiffPathAddLine(SwiffPath *path, SwiffPoint toPoint);
+extern void SwiffPathAddHorizontalLine(SwiffPath *path, SwiffPoint toPoint);
+extern void SwiffPathAddVerticalLine(SwiffPath *path, SwiffPoint toPoint);
+extern void SwiffPathAddCurve(SwiffPath *path, SwiffPoint toPoint, SwiffPoint controlPoint);
+
+// Terminates the path and trims its storage to the exact size
 extern void SwiffPathAddOperationEnd(SwiffPath *path);
 
+// Applies transform to every point of path, writing [path pointsCount] points to outPoints
+extern void SwiffPathTransformPoints(SwiffPath *path, CGAffineTransform transform, CGPoint *outPoints);
+
+// Deprecated varargs appender, takes the same twips as before: 2 for move/line { toX, toY },
+// 1 for horizontal/vertical lines { toX } or { toY }, 4 for curves { toX, toY, controlX, controlY }
+extern void SwiffPathAddOperationAndTwips(SwiffPath *path, SwiffPathOperation operation, /*SwiffTwips*/ ...)
+    __attribute__((deprecated("Use SwiffPathAddMove(), SwiffPathAddLine(), etc.")));
+
 @interface SwiffPath : NSObject
 
 - (id) initWithLineStyle:(SwiffLineStyle *)lineStyle fillStyle:(SwiffFillStyle *)fillStyle;
 
 
 /*
-    operations              # points example data
-    ----------------------- -------- -------------
-    SwiffPathOperationMove  1        { 2.0, 3.0 }
-    SwiffPathOperationLine  1        { 3.0, 3.0 }
-    SwiffPathOperationCurve 2        { 4.0, 3.0, 4.0, 4.0 }
+    Coordinates are stored in points (not twips) as 32-bit floats, in separate x and y arrays:
+
+    operations              # points example x/y data
+    ----------------------- -------- --------------------------
+    SwiffPathOperationMove  1        { 2.0 }, { 3.0 }
+    SwiffPathOperationLine  1        { 3.0 }, { 3.0 }
+    SwiffPathOperationCurve 2        { 4.0, 4.0 }, { 3.0, 4.0 }
     SwiffPathOperationEnd   0
 */
 @property (nonatomic, assign, readonly) NSUInteger operationsCount;
-@property (nonatomic, assign, readonly) NSUInteger floatsCount;
+@property (nonatomic, assign, readonly) NSUInteger pointsCount;
+
+@property (nonatomic, assign, readonly) UInt8 *operations;   // Inside pointer, valid for lifetime of the SwiffPath
+@property (nonatomic, assign, readonly) float *xCoordinates; // Inside pointer, valid for lifetime of the SwiffPath
+@property (nonatomic, assign, readonly) float *yCoordinates; // Inside pointer, valid for lifetime of the SwiffPath
 
-@property (nonatomic, assign, readonly) UInt8   *operations; // Inside pointer, valid for lifetime of the SwiffPath
-@property (nonatomic, assign, readonly) CGFloat *floats;     // Inside pointer, valid for lifetime of the SwiffPath
+// Deprecated.  The coordinates in the former interleaved CGFloat layout (see SwiffPathAddOperationAndTwips()),
+// built on first access.  Inside pointer, valid for lifetime of the SwiffPath
+@property (nonatomic, assign, readonly) NSUInteger floatsCount __attribute__((deprecated("Use -pointsCount")));
+@property (nonatomic, assign, readonly) CGFloat   *floats      __attribute__((deprecated("Use -xCoordinates and -yCoordinates")));
 
 @property (nonatomic, strong, readonly) SwiffLineStyle *lineStyle;
 @property (nonatomic, strong, readonly) SwiffFillStyle *fillStyle;
@@ -31,69 +31,360 @@
 #import "SwiffFillStyle.h"
 #import "SwiffLineStyle.h"
 
-static const NSUInteger sGrowthForOperations = 64;
-static const NSUInteger sGrowthForFloats     = 256;
+#if CGFLOAT_IS_DOUBLE && defined(__ARM_NEON) && defined(__aarch64__)
+#import <arm_neon.h>
+#define SWIFF_PATH_SIMD 1
+#elif CGFLOAT_IS_DOUBLE && defined(__SSE2__)
+#import <emmintrin.h>
+#define SWIFF_PATH_SIMD 1
+#endif
 
+static const NSUInteger sMinimumOperationsCapacity = 16;
+static const NSUInteger sMinimumPointsCapacity     = 16;
 
-@implementation SwiffPath
+
+@implementation SwiffPath {
+    NSUInteger _operationsCapacity;
+    NSUInteger _pointsCapacity;
+    CGFloat   *_floats;
+    NSUInteger _floatsCount;
+}
 
 @synthesize operations            = _operations,
-            floats                = _floats,
+            xCoordinates          = _xCoordinates,
+            yCoordinates          = _yCoordinates,
             operationsCount       = _operationsCount,
-            floatsCount           = _floatsCount,
+            pointsCount           = _pointsCount,
             fillStyle             = _fillStyle,
             lineStyle             = _lineStyle,
             usesFillHairlineWidth = _usesFillHairlineWidth;
 
 
-static void SwiffPathAddTwipsToFloats(SwiffPath *path, const SwiffTwips twips)
+static void sSetOperationsCapacity(SwiffPath *path, NSUInteger capacity)
+{
+    path->_operations = realloc(path->_operations, sizeof(UInt8) * capacity);
+    path->_operationsCapacity = capacity;
+}
+
+
+static void sSetPointsCapacity(SwiffPath *path, NSUInteger capacity)
 {
-    if ((path->_floatsCount % sGrowthForFloats) == 0) {
-        NSUInteger capacity = (path->_floatsCount + sGrowthForFloats);
-        path->_floats = realloc(path->_floats, sizeof(CGFloat) * capacity);
+    path->_xCoordinates = realloc(path->_xCoordinates, sizeof(float) * capacity);
+    path->_yCoordinates = realloc(path->_yCoordinates, sizeof(float) * capacity);
+    path->_pointsCapacity = capacity;
+}
+
+
+static inline void sAddOperation(SwiffPath *path, SwiffPathOperation operation)
+{
+    if (path->_operationsCount == path->_operationsCapacity) {
+        sSetOperationsCapacity(path, MAX(path->_operationsCapacity * 2, sMinimumOperationsCapacity));
     }
 
-    path->_floats[path->_floatsCount++] = SwiffGetCGFloatFromTwips(twips);
+    path->_operations[path->_operationsCount++] = operation;
 }
 
 
-void SwiffPathAddOperationAndTwips(SwiffPath *path, SwiffPathOperation operation, ...)
+static inline void sAddPoint(SwiffPath *path, SwiffTwips x, SwiffTwips y)
+{
+    if (path->_pointsCount == path->_pointsCapacity) {
+        sSetPointsCapacity(path, MAX(path->_pointsCapacity * 2, sMinimumPointsCapacity));
+    }
+
+    path->_xCoordinates[path->_pointsCount] = SwiffGetCGFloatFromTwips((float)x);
+    path->_yCoordinates[path->_pointsCount] = SwiffGetCGFloatFromTwips((float)y);
+    path->_pointsCount++;
+}
+
+
+void SwiffPathReserveCapacity(SwiffPath *path, NSUInteger operationsCount, NSUInteger pointsCount)
+{
+    if (path->_operationsCapacity < operationsCount) sSetOperationsCapacity(path, operationsCount);
+    if (path->_pointsCapacity     < pointsCount)     sSetPointsCapacity(path, pointsCount);
+}
+
+
+void SwiffPathAddMove(SwiffPath *path, SwiffPoint toPoint)
+{
+    sAddOperation(path, SwiffPathOperationMove);
+    sAddPoint(path, toPoint.x, toPoint.y);
+}
+
+
+void SwiffPathAddLine(SwiffPath *path, SwiffPoint toPoint)
+{
+    sAddOperation(path, SwiffPathOperationLine);
+    sAddPoint(path, toPoint.x, toPoint.y);
+}
+
+
+void SwiffPathAddHorizontalLine(SwiffPath *path, SwiffPoint toPoint)
 {
-    if ((path->_operationsCount % sGrowthForOperations) == 0) {
-        NSUInteger capacity = (path->_operationsCount + sGrowthForOperations);
-        path->_operations = realloc(path->_operations, sizeof(UInt8) * capacity);
+    sAddOperation(path, SwiffPathOperationHorizontalLine);
+    sAddPoint(path, toPoint.x, toPoint.y);
+}
+
+
+void SwiffPathAddVerticalLine(SwiffPath *path, SwiffPoint toPoint)
+{
+    sAddOperation(path, SwiffPathOperationVerticalLine);
+    sAddPoint(path, toPoint.x, toPoint.y);
+}
+
+
+void SwiffPathAddCurve(SwiffPath *path, SwiffPoint toPoint, SwiffPoint controlPoint)
+{
+    sAddOperation(path, SwiffPathOperationCurve);
+    sAddPoint(path, controlPoint.x, controlPoint.y);
+    sAddPoint(path, toPoint.x, toPoint.y);
+}
+
+
+void SwiffPathAddOperationEnd(SwiffPath *path)
+{
+    // Two end operations, as the stroke tracer looks one operation ahead
+    sAddOperation(path, SwiffPathOperationEnd);
+    sAddOperation(path, SwiffPathOperationEnd);
+
+    if (path->_operationsCapacity > path->_operationsCount) {
+        sSetOperationsCapacity(path, path->_operationsCount);
+    }
+
+    if (path->_pointsCapacity > path->_pointsCount) {
+        sSetPointsCapacity(path, MAX(path->_pointsCount, 1));
     }
+}
+
+
+#pragma mark -
+#pragma mark Transform
+
+#if SWIFF_PATH_SIMD
+
+// Each vector holds one coordinate (x or y) of two consecutive points
+#if defined(__ARM_NEON)
+
+typedef float64x2_t SwiffPathVector;
+
+static inline SwiffPathVector sLoad(const float *f)              { return vcvt_f64_f32(vld1_f32(f)); }
+static inline SwiffPathVector sSplat(CGFloat f)                  { return vdupq_n_f64(f); }
+static inline SwiffPathVector sAdd(SwiffPathVector a, SwiffPathVector b) { return vaddq_f64(a, b); }
+static inline SwiffPathVector sMul(SwiffPathVector a, SwiffPathVector b) { return vmulq_f64(a, b); }
 
+static inline void sStore(CGPoint *outPoints, SwiffPathVector x, SwiffPathVector y)
+{
+    float64x2x2_t xy = { { x, y } };
+    vst2q_f64((double *)outPoints, xy);
+}
+
+#else
+
+typedef __m128d SwiffPathVector;
+
+static inline SwiffPathVector sLoad(const float *f)              { return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i *)f))); }
+static inline SwiffPathVector sSplat(CGFloat f)                  { return _mm_set1_pd(f); }
+static inline SwiffPathVector sAdd(SwiffPathVector a, SwiffPathVector b) { return _mm_add_pd(a, b); }
+static inline SwiffPathVector sMul(SwiffPathVector a, SwiffPathVector b) { return _mm_mul_pd(a, b); }
+
+static inline void sStore(CGPoint *outPoints, SwiffPathVector x, SwiffPathVector y)
+{
+    _mm_storeu_pd((double *)&outPoints[0], _mm_unpacklo_pd(x, y));
+    _mm_storeu_pd((double *)&outPoints[1], _mm_unpackhi_pd(x, y));
+}
+
+#endif
+
+#endif
+
+
+// Specialized for the common identity, translate-only, and scale+translate transforms.
+// The SIMD loops handle two points per iteration, the scalar loops handle the remainder.
+//
+void SwiffPathTransformPoints(SwiffPath *path, CGAffineTransform transform, CGPoint *outPoints)
+{
+    const float *xs = path->_xCoordinates;
+    const float *ys = path->_yCoordinates;
+    NSUInteger count = path->_pointsCount;
+    NSUInteger i = 0;
+
+    const CGFloat a = transform.a, b = transform.b, c = transform.c, d = transform.d, tx = transform.tx, ty = transform.ty;
+
+    BOOL isScale     = (b == 0) && (c == 0);
+    BOOL isTranslate = isScale && (a == 1) && (d == 1);
+    BOOL isIdentity  = isTranslate && (tx == 0) && (ty == 0);
+
+#if SWIFF_PATH_SIMD
+    SwiffPathVector vA  = sSplat(a),  vB  = sSplat(b),  vC = sSplat(c), vD = sSplat(d);
+    SwiffPathVector vTX = sSplat(tx), vTY = sSplat(ty);
+#endif
+
+    if (isIdentity) {
+#if SWIFF_PATH_SIMD
+        for ( ; (i + 2) <= count; i += 2) {
+            sStore(&outPoints[i], sLoad(&xs[i]), sLoad(&ys[i]));
+        }
+#endif
+        for ( ; i < count; i++) {
+            outPoints[i].x = xs[i];
+            outPoints[i].y = ys[i];
+        }
+
+    } else if (isTranslate) {
+#if SWIFF_PATH_SIMD
+        for ( ; (i + 2) <= count; i += 2) {
+            sStore(&outPoints[i], sAdd(sLoad(&xs[i]), vTX), sAdd(sLoad(&ys[i]), vTY));
+        }
+#endif
+        for ( ; i < count; i++) {
+            outPoints[i].x = xs[i] + tx;
+            outPoints[i].y = ys[i] + ty;
+        }
+
+    } else if (isScale) {
+#if SWIFF_PATH_SIMD
+        for ( ; (i + 2) <= count; i += 2) {
+            sStore(&outPoints[i], sAdd(sMul(sLoad(&xs[i]), vA), vTX), sAdd(sMul(sLoad(&ys[i]), vD), vTY));
+        }
+#endif
+        for ( ; i < count; i++) {
+            outPoints[i].x = (a * xs[i]) + tx;
+            outPoints[i].y = (d * ys[i]) + ty;
+        }
+
+    } else {
+#if SWIFF_PATH_SIMD
+        for ( ; (i + 2) <= count; i += 2) {
+            SwiffPathVector x = sLoad(&xs[i]);
+            SwiffPathVector y = sLoad(&ys[i]);
+
+            sStore(&outPoints[i],
+                sAdd(sAdd(sMul(x, vA), sMul(y, vC)), vTX),
+                sAdd(sAdd(sMul(x, vB), sMul(y, vD)), vTY)
+            );
+        }
+#endif
+        for ( ; i < count; i++) {
+            CGFloat x = xs[i], y = ys[i];
+            outPoints[i].x = (a * x) + (c * y) + tx;
+            outPoints[i].y = (b * x) + (d * y) + ty;
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Deprecated
+
+static SwiffPoint sGetCurrentPoint(SwiffPath *path)
+{
+    SwiffPoint result = { 0, 0 };
+
+    if (path->_pointsCount > 0) {
+        NSUInteger last = path->_pointsCount - 1;
+        result.x = SwiffGetTwipsFromCGFloat(path->_xCoordinates[last]);
+        result.y = SwiffGetTwipsFromCGFloat(path->_yCoordinates[last]);
+    }
+
+    return result;
+}
+
+
+void SwiffPathAddOperationAndTwips(SwiffPath *path, SwiffPathOperation operation, ...)
+{
     va_list v;
     va_start(v, operation);
 
-    path->_operations[path->_operationsCount++] = operation;
-    
+    SwiffPoint toPoint = sGetCurrentPoint(path);
+
     if (operation == SwiffPathOperationCurve) {
-        SwiffPathAddTwipsToFloats(path, va_arg(v, SwiffTwips));
-        SwiffPathAddTwipsToFloats(path, va_arg(v, SwiffTwips));
-        SwiffPathAddTwipsToFloats(path, va_arg(v, SwiffTwips));
-        SwiffPathAddTwipsToFloats(path, va_arg(v, SwiffTwips));
+        SwiffPoint controlPoint;
+        toPoint.x      = va_arg(v, SwiffTwips);
+        toPoint.y      = va_arg(v, SwiffTwips);
+        controlPoint.x = va_arg(v, SwiffTwips);
+        controlPoint.y = va_arg(v, SwiffTwips);
+        SwiffPathAddCurve(path, toPoint, controlPoint);
 
     } else if (operation == SwiffPathOperationMove || operation == SwiffPathOperationLine) {
-        SwiffPathAddTwipsToFloats(path, va_arg(v, SwiffTwips));
-        SwiffPathAddTwipsToFloats(path, va_arg(v, SwiffTwips));
-    
-    } else if (operation == SwiffPathOperationHorizontalLine || operation == SwiffPathOperationVerticalLine) {
-        SwiffPathAddTwipsToFloats(path, va_arg(v, SwiffTwips));
+        toPoint.x = va_arg(v, SwiffTwips);
+        toPoint.y = va_arg(v, SwiffTwips);
+        
+        if (operation == SwiffPathOperationMove) {
+            SwiffPathAddMove(path, toPoint);
+        } else {
+            SwiffPathAddLine(path, toPoint);
+        }
+
+    } else if (operation == SwiffPathOperationHorizontalLine) {
+        toPoint.x = va_arg(v, SwiffTwips);
+        SwiffPathAddHorizontalLine(path, toPoint);
+
+    } else if (operation == SwiffPathOperationVerticalLine) {
+        toPoint.y = va_arg(v, SwiffTwips);
+        SwiffPathAddVerticalLine(path, toPoint);
+
+    } else if (operation == SwiffPathOperationEnd) {
+        sAddOperation(path, SwiffPathOperationEnd);
     }
-    
+
     va_end(v);
 }
 
 
-void SwiffPathAddOperationEnd(SwiffPath *path)
+// Rebuilds the former interleaved layout from the x/y arrays
+static void sMakeFloats(SwiffPath *path)
 {
-    SwiffPathAddOperationAndTwips(path, SwiffPathOperationEnd);
-    SwiffPathAddOperationAndTwips(path, SwiffPathOperationEnd);
+    path->_floats = malloc(sizeof(CGFloat) * MAX(path->_pointsCount * 2, 1));
+    path->_floatsCount = 0;
+
+    const float *xs = path->_xCoordinates;
+    const float *ys = path->_yCoordinates;
+    CGFloat *out = path->_floats;
+    NSUInteger p = 0;
+    
+    for (NSUInteger i = 0; i < path->_operationsCount; i++) {
+        SwiffPathOperation operation = path->_operations[i];
+
+        if (operation == SwiffPathOperationMove || operation == SwiffPathOperationLine) {
+            *out++ = xs[p];
+            *out++ = ys[p];
+            p++;
+
+        } else if (operation == SwiffPathOperationHorizontalLine) {
+            *out++ = xs[p++];
+
+        } else if (operation == SwiffPathOperationVerticalLine) {
+            *out++ = ys[p++];
+
+        } else if (operation == SwiffPathOperationCurve) {
+            *out++ = xs[p + 1];
+            *out++ = ys[p + 1];
+            *out++ = xs[p];
+            *out++ = ys[p];
+            p += 2;
+        }
+    }
+
+    path->_floatsCount = (out - path->_floats);
+}
+
+
+- (CGFloat *) floats
+{
+    if (!_floats) sMakeFloats(self);
+    return _floats;
+}
+
+
+- (NSUInteger) floatsCount
+{
+    if (!_floats) sMakeFloats(self);
+    return _floatsCount;
 }
 
 
+#pragma mark -
+#pragma mark Lifecycle
+
 - (id) initWithLineStyle:(SwiffLineStyle *)lineStyle fillStyle:(SwiffFillStyle *)fillStyle
 {
     if ((self = [super init])) {
@@ -112,6 +403,16 @@ void SwiffPathAddOperationEnd(SwiffPath *path)
         _operations = NULL;
     }
 
+    if (_xCoordinates) {
+        free(_xCoordinates);
+        _xCoordinates = NULL;
+    }
+
+    if (_yCoordinates) {
+        free(_yCoordinates);
+        _yCoordinates = NULL;
+    }
+
     if (_floats) {
         free(_floats);
         _floats = NULL;
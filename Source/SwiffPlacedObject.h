@@ -35,6 +35,7 @@
 @package
     UInt16             _libraryID;
     UInt16             _depth;
+    UInt32             _instanceID;
     CGAffineTransform  _affineTransform;
     void              *_additional;      // Keep less commonly used ivars here
 }
@@ -64,6 +65,10 @@
 @property (nonatomic, assign) BOOL placesImage;
 @property (nonatomic, assign) BOOL cachesAsBitmap;
 
+// Identifies one placement of a character in the timeline of its sprite.  Moves keep the instanceID,
+// while placing a new character at the depth changes it.  Used to give each sprite instance its own playhead
+@property (nonatomic, assign) UInt32 instanceID;
+
 // Inside pointers, valid for lifetime of the SwiffPlacedObject
 @property (nonatomic, assign, readonly) CGAffineTransform   *affineTransformPointer;
 @property (nonatomic, assign, readonly) SwiffColorTransform *colorTransformPointer;
@@ -56,11 +56,13 @@ SwiffPlacedObject *SwiffPlacedObjectCreate(SwiffMovie *movie, UInt16 libraryID,
     SwiffPlacedObject *result = nil;
     Class cls = [SwiffPlacedObject class];
 
+    // Only placements with a specialized class need the definition, which may not be decoded yet
     if (libraryID) {
-        definition = [movie definitionWithLibraryID:libraryID];
+        Class definitionClass = SwiffMovieGetDefinitionClass(movie, libraryID);
 
-        if ([[definition class] respondsToSelector:@selector(placedObjectClass)]) {
-            cls = [[definition class] placedObjectClass];
+        if ([definitionClass respondsToSelector:@selector(placedObjectClass)]) {
+            cls = [definitionClass placedObjectClass];
+            definition = SwiffMovieGetDefinition(movie, libraryID);
         }
     }
 
@@ -99,6 +101,7 @@ SwiffPlacedObject *SwiffPlacedObjectCreate(SwiffMovie *movie, UInt16 libraryID,
 {
     if ((self = [self init])) {
         _depth             = placedObject->_depth;
+        _instanceID        = placedObject->_instanceID;
         _libraryID         = placedObject->_libraryID;
         _affineTransform   = placedObject->_affineTransform;
 
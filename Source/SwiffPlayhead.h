@@ -28,7 +28,7 @@
 #import <SwiffImport.h>
 #import <SwiffTypes.h>
 
-@class SwiffScene, SwiffFrame, SwiffMovie;
+@class SwiffScene, SwiffFrame, SwiffMovie, SwiffTimeline;
 @class CADisplayLink;
 @protocol SwiffPlayheadDelegate;
 
@@ -64,6 +64,9 @@
 @property (nonatomic, assign) BOOL loopsScene;
 
 @property (nonatomic, readonly, strong) SwiffMovie *movie;
+
+// The playheads of the sprite instances, which step with this playhead.  Gotos do not advance them
+@property (nonatomic, readonly, strong) SwiffTimeline *timeline;
 @property (nonatomic, readonly, getter=isPlaying) BOOL playing;
 
 @end
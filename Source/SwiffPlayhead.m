@@ -30,6 +30,7 @@
 #import "SwiffFrame.h"
 #import "SwiffMovie.h"
 #import "SwiffScene.h"
+#import "SwiffTimeline.h"
 #import "SwiffUtils.h"
 #import "SwiffSoundPlayer.h"
 
@@ -65,6 +66,7 @@ void SwiffPlayheadWarnForInvalidGotoArguments()
         _frameIndex = -1;
         _movie = movie;
         _delegate = delegate;
+        _timeline = movie ? [[SwiffTimeline alloc] initWithMovie:movie] : nil;
     }
     
     return self;
@@ -119,6 +121,7 @@ void SwiffPlayheadWarnForInvalidGotoArguments()
     
     if (_frameIndex != frameIndex) {
         _frameIndex = frameIndex;
+        [_timeline gotoFrameWithIndex:frameIndex];
         needsUpdate = YES;
     }
 
@@ -319,6 +322,8 @@ void SwiffPlayheadWarnForInvalidGotoArguments()
     
     if (atEnd) {
         [self stop];
+    } else {
+        [_timeline stepToFrameWithIndex:_frameIndex];
     }
 
     [_delegate playheadDidUpdate:self step:YES];
@@ -0,0 +1,117 @@
+/*
+    SwiffRasterizer.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+#import <SwiffTypes.h>
+
+
+// A CPU scanline rasterizer which renders into an RGBA8 premultiplied buffer
+// (bytes in R, G, B, A order).  Coverage is computed analytically from the signed
+// area of each edge within each pixel, so no supersampling is involved.
+//
+// Paths are specified in device (pixel) coordinates and flattened as they are added.
+//
+typedef struct SwiffRasterizer SwiffRasterizer;
+
+typedef NS_ENUM(NSInteger, SwiffRasterizerFillRule) {
+    SwiffRasterizerFillRuleNonZero = 0,
+    SwiffRasterizerFillRuleEvenOdd = 1
+};
+
+typedef NS_ENUM(NSInteger, SwiffRasterizerPaintType) {
+    SwiffRasterizerPaintTypeColor = 0,
+    SwiffRasterizerPaintTypeLinearGradient,
+    SwiffRasterizerPaintTypeRadialGradient,
+    SwiffRasterizerPaintTypeBitmap
+};
+
+typedef NS_ENUM(NSInteger, SwiffRasterizerSpreadMode) {
+    SwiffRasterizerSpreadModePad = 0,
+    SwiffRasterizerSpreadModeReflect,
+    SwiffRasterizerSpreadModeRepeat
+};
+
+enum {
+    SwiffRasterizerGradientTableLength = 256
+};
+
+typedef struct SwiffRasterizerPaint {
+    SwiffRasterizerPaintType type;
+
+    // Maps device coordinates into paint space.  For gradients, paint space is the gradient
+    // square (-819.2, -819.2)-(819.2, 819.2).  For bitmaps, it is bitmap pixels, top row first.
+    CGAffineTransform inverseTransform;
+
+    // SwiffRasterizerPaintTypeColor, premultiplied RGBA
+    UInt8 color[4];
+
+    // SwiffRasterizerPaintType...Gradient, premultiplied RGBA
+    const UInt8 *gradientTable; // UInt8[SwiffRasterizerGradientTableLength * 4]
+    SwiffRasterizerSpreadMode spreadMode;
+
+    // SwiffRasterizerPaintTypeBitmap, premultiplied RGBA.  bitmapAlpha (0-255) multiplies every sample
+    const UInt8 *bitmapPixels;
+    size_t bitmapWidth;
+    size_t bitmapHeight;
+    size_t bitmapBytesPerRow;
+    UInt8  bitmapAlpha;
+    BOOL   bitmapRepeats;
+    BOOL   bitmapSmooths;
+
+    // How the paint is composited onto the pixels, see SwiffBlendProcessor.h.  SwiffBlendModeNormal (0) is source over
+    SwiffBlendMode blendMode;
+} SwiffRasterizerPaint;
+
+
+extern SwiffRasterizer *SwiffRasterizerCreate(UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow);
+extern void SwiffRasterizerFree(SwiffRasterizer *rasterizer);
+
+// Path construction.  Each move starts a new subpath; fills implicitly close all subpaths
+extern void SwiffRasterizerBeginPath(SwiffRasterizer *rasterizer);
+extern void SwiffRasterizerMoveToPoint(SwiffRasterizer *rasterizer, CGPoint point);
+extern void SwiffRasterizerAddLineToPoint(SwiffRasterizer *rasterizer, CGPoint point);
+extern void SwiffRasterizerAddQuadCurveToPoint(SwiffRasterizer *rasterizer, CGPoint control, CGPoint point);
+extern void SwiffRasterizerClosePath(SwiffRasterizer *rasterizer);
+
+// Fills or strokes the current path, then clears it.  Strokes use round joins and caps
+// unless isHairline is set, in which case segments are drawn with butt ends
+extern void SwiffRasterizerFillPath(SwiffRasterizer *rasterizer, SwiffRasterizerFillRule rule, const SwiffRasterizerPaint *paint);
+extern void SwiffRasterizerStrokePath(SwiffRasterizer *rasterizer, CGFloat width, BOOL isHairline, const SwiffRasterizerPaint *paint);
+
+// Clipping.  BeginClipMask starts an empty pending mask, AddPathToClipMask unions the current
+// path into it, and ApplyClipMask makes it active.  All drawing is then masked until removed.
+extern void SwiffRasterizerBeginClipMask(SwiffRasterizer *rasterizer);
+extern void SwiffRasterizerAddPathToClipMask(SwiffRasterizer *rasterizer, SwiffRasterizerFillRule rule);
+extern void SwiffRasterizerApplyClipMask(SwiffRasterizer *rasterizer);
+extern void SwiffRasterizerRemoveClipMask(SwiffRasterizer *rasterizer);
+
+// Cached clip masks, as 8-bit coverage of width x height pixels, starting at pixel (x, y).  CopyClipMask
+// copies the pending mask into outCoverage, and returns NO if the pixels are not all inside of the rasterizer.
+// AddCoverageToClipMask unions coverage into the pending mask, ignoring pixels outside of the rasterizer
+extern BOOL SwiffRasterizerCopyClipMask(SwiffRasterizer *rasterizer, UInt8 *outCoverage, NSInteger x, NSInteger y, size_t width, size_t height);
+extern void SwiffRasterizerAddCoverageToClipMask(SwiffRasterizer *rasterizer, const UInt8 *coverage, NSInteger x, NSInteger y, size_t width, size_t height);
+
@@ -0,0 +1,921 @@
+/*
+    SwiffRasterizer.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffRasterizer.h"
+
+#import "SwiffBlendProcessor.h"
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#import <arm_neon.h>
+#define SWIFF_RASTERIZER_SIMD_NEON 1
+#elif defined(__SSE2__)
+#import <emmintrin.h>
+#define SWIFF_RASTERIZER_SIMD_SSE 1
+#endif
+
+
+// Maximum distance, in pixels, between a curve and its flattened approximation
+static const CGFloat sFlatteningTolerance = 0.1;
+
+// Width of the gradient square, in points
+static const CGFloat sGradientSquareSize = 1638.4;
+
+
+typedef struct SwiffRasterizerSubpath {
+    NSUInteger start;
+    NSUInteger count;
+    BOOL       closed;
+} SwiffRasterizerSubpath;
+
+
+typedef struct SwiffRasterizerPath {
+    CGPoint    *points;
+    NSUInteger  pointsCount;
+    NSUInteger  pointsCapacity;
+
+    SwiffRasterizerSubpath *subpaths;
+    NSUInteger  subpathsCount;
+    NSUInteger  subpathsCapacity;
+} SwiffRasterizerPath;
+
+
+struct SwiffRasterizer {
+    UInt8  *pixels;
+    size_t  width;
+    size_t  height;
+    size_t  bytesPerRow;
+
+    SwiffRasterizerPath path;
+    SwiffRasterizerPath strokePath;
+
+    // Signed area accumulation for the fill in progress, (width + 2) * height cells
+    float  *accumulation;
+    size_t  accumulationCapacity;
+
+    // Per-row scratch spans, width entries each
+    UInt8  *coverage;
+    UInt8  *source;
+
+    UInt8  *clipMask;        // width * height, active when isClipping
+    UInt8  *pendingClipMask; // width * height
+    BOOL    isClipping;
+};
+
+
+#pragma mark -
+#pragma mark Paths
+
+static void sPathReset(SwiffRasterizerPath *path)
+{
+    path->pointsCount   = 0;
+    path->subpathsCount = 0;
+}
+
+
+static void sPathFree(SwiffRasterizerPath *path)
+{
+    free(path->points);
+    free(path->subpaths);
+}
+
+
+static void sPathMoveTo(SwiffRasterizerPath *path, CGPoint point)
+{
+    if (path->subpathsCount == path->subpathsCapacity) {
+        path->subpathsCapacity = MAX(path->subpathsCapacity * 2, 16);
+        path->subpaths = realloc(path->subpaths, path->subpathsCapacity * sizeof(SwiffRasterizerSubpath));
+    }
+
+    if (path->pointsCount == path->pointsCapacity) {
+        path->pointsCapacity = MAX(path->pointsCapacity * 2, 64);
+        path->points = realloc(path->points, path->pointsCapacity * sizeof(CGPoint));
+    }
+
+    SwiffRasterizerSubpath *subpath = &path->subpaths[path->subpathsCount++];
+    subpath->start  = path->pointsCount;
+    subpath->count  = 1;
+    subpath->closed = NO;
+
+    path->points[path->pointsCount++] = point;
+}
+
+
+static void sPathLineTo(SwiffRasterizerPath *path, CGPoint point)
+{
+    if (!path->subpathsCount) {
+        sPathMoveTo(path, point);
+        return;
+    }
+
+    SwiffRasterizerSubpath *subpath = &path->subpaths[path->subpathsCount - 1];
+
+    // Drawing after a close starts a new subpath at the closed subpath's first point
+    if (subpath->closed) {
+        sPathMoveTo(path, path->points[subpath->start]);
+        subpath = &path->subpaths[path->subpathsCount - 1];
+    }
+
+    if (path->pointsCount == path->pointsCapacity) {
+        path->pointsCapacity = MAX(path->pointsCapacity * 2, 64);
+        path->points = realloc(path->points, path->pointsCapacity * sizeof(CGPoint));
+    }
+
+    path->points[path->pointsCount++] = point;
+    subpath->count++;
+}
+
+
+static CGPoint sPathGetCurrentPoint(SwiffRasterizerPath *path)
+{
+    if (!path->subpathsCount) return CGPointZero;
+
+    SwiffRasterizerSubpath *subpath = &path->subpaths[path->subpathsCount - 1];
+    return subpath->closed ? path->points[subpath->start] : path->points[path->pointsCount - 1];
+}
+
+
+static void sPathQuadCurveTo(SwiffRasterizerPath *path, CGPoint control, CGPoint point)
+{
+    CGPoint from = sPathGetCurrentPoint(path);
+
+    // The distance between a quadratic curve and the chord of a parameter interval h is
+    // at most |from - 2 * control + point| * h^2 / 4, which bounds the segment count
+    CGFloat ddx = from.x - (2 * control.x) + point.x;
+    CGFloat ddy = from.y - (2 * control.y) + point.y;
+    CGFloat dd  = sqrt((ddx * ddx) + (ddy * ddy));
+
+    NSInteger segments = (NSInteger)ceil(sqrt(dd / (4 * sFlatteningTolerance)));
+    if (segments < 1)   segments = 1;
+    if (segments > 100) segments = 100;
+
+    for (NSInteger i = 1; i < segments; i++) {
+        CGFloat t  = (CGFloat)i / segments;
+        CGFloat mt = 1 - t;
+
+        CGPoint p = {
+            (mt * mt * from.x) + (2 * mt * t * control.x) + (t * t * point.x),
+            (mt * mt * from.y) + (2 * mt * t * control.y) + (t * t * point.y)
+        };
+
+        sPathLineTo(path, p);
+    }
+
+    sPathLineTo(path, point);
+}
+
+
+#pragma mark -
+#pragma mark Coverage
+
+// Accumulates the signed area of the line (x0, y0)-(x1, y1) into acc.  After a prefix sum
+// along each row, a cell holds the winding-weighted coverage of its pixel.  x must be within
+// [0, stride - 2]; y is clipped to [0, height].
+//
+static void sAccumulateLine(float *acc, size_t stride, size_t height, float x0, float y0, float x1, float y1)
+{
+    if (y0 == y1) return;
+
+    float direction = 1;
+
+    if (y0 > y1) {
+        float t;
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+        direction = -1;
+    }
+
+    if ((y1 <= 0) || (y0 >= height)) return;
+
+    float dxdy = (x1 - x0) / (y1 - y0);
+    float x    = x0;
+    float maxX = (float)(stride - 2);
+
+    if (y0 < 0) {
+        x -= y0 * dxdy;
+        y0 = 0;
+    }
+
+    if (y1 > height) {
+        y1 = height;
+    }
+
+    NSInteger yEnd = (NSInteger)ceilf(y1);
+
+    for (NSInteger y = (NSInteger)floorf(y0); y < yEnd; y++) {
+        float *row   = acc + (y * stride);
+        float  dy    = MIN((float)(y + 1), y1) - MAX((float)y, y0);
+        float  xNext = x + (dxdy * dy);
+        float  d     = dy * direction;
+
+        float xLow  = MIN(x, xNext);
+        float xHigh = MAX(x, xNext);
+
+        // Guard against rounding drift pushing us outside of the row
+        if (xLow  < 0)    xLow  = 0;
+        if (xHigh > maxX) xHigh = maxX;
+        if (xLow  > xHigh) xLow = xHigh;
+
+        float     xLowFloor = floorf(xLow);
+        NSInteger xLowIndex = (NSInteger)xLowFloor;
+        float     xHighCeil  = ceilf(xHigh);
+        NSInteger xHighIndex = (NSInteger)xHighCeil;
+
+        if (xHighIndex <= (xLowIndex + 1)) {
+            // Within a single pixel: split d by the position of the midpoint
+            float middle = (0.5f * (xLow + xHigh)) - xLowFloor;
+            row[xLowIndex]     += d - (d * middle);
+            row[xLowIndex + 1] += d * middle;
+
+        } else {
+            float s         = 1.0f / (xHigh - xLow);
+            float xLowFrac  = xLow - xLowFloor;
+            float a0        = 0.5f * s * (1 - xLowFrac) * (1 - xLowFrac);
+            float xHighFrac = xHigh - xHighCeil + 1;
+            float aMax      = 0.5f * s * xHighFrac * xHighFrac;
+
+            row[xLowIndex] += d * a0;
+
+            if (xHighIndex == (xLowIndex + 2)) {
+                row[xLowIndex + 1] += d * (1 - a0 - aMax);
+
+            } else {
+                float a1 = s * (1.5f - xLowFrac);
+                row[xLowIndex + 1] += d * (a1 - a0);
+
+                for (NSInteger xi = xLowIndex + 2; xi < (xHighIndex - 1); xi++) {
+                    row[xi] += d * s;
+                }
+
+                float a2 = a1 + ((xHighIndex - xLowIndex - 3) * s);
+                row[xHighIndex - 1] += d * (1 - a2 - aMax);
+            }
+
+            row[xHighIndex] += d * aMax;
+        }
+
+        x = xNext;
+    }
+}
+
+
+static inline void sAccumulateOrientedLine(float *acc, size_t width, size_t height, BOOL reversed, CGFloat x0, CGFloat y0, CGFloat x1, CGFloat y1)
+{
+    if (reversed) {
+        sAccumulateLine(acc, width + 2, height, x1, y1, x0, y0);
+    } else {
+        sAccumulateLine(acc, width + 2, height, x0, y0, x1, y1);
+    }
+}
+
+
+// Clips the edge horizontally to [0, width] before accumulating it.  Portions to the right of the
+// area never affect it; portions to the left are projected onto x = 0, where they still count towards
+// the winding of every pixel.
+//
+static void sAccumulateEdge(float *acc, size_t width, size_t height, CGPoint p0, CGPoint p1)
+{
+    CGFloat x0 = p0.x, y0 = p0.y, x1 = p1.x, y1 = p1.y;
+    CGFloat w  = width;
+
+    if (y0 == y1) return;
+    if ((x0 >= w) && (x1 >= w)) return;
+
+    // Order the endpoints by x, remembering to restore the original direction (and thus winding)
+    BOOL reversed = (x0 > x1);
+
+    if (reversed) {
+        CGFloat t;
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+
+    // Drop the portion right of w
+    if (x1 > w) {
+        y1 = y0 + ((y1 - y0) * (w - x0) / (x1 - x0));
+        x1 = w;
+    }
+
+    // Project the portion left of 0
+    if (x0 < 0) {
+        if (x1 <= 0) {
+            sAccumulateOrientedLine(acc, width, height, reversed, 0, y0, 0, y1);
+            return;
+        }
+
+        CGFloat yCross = y0 + ((y1 - y0) * (0 - x0) / (x1 - x0));
+        sAccumulateOrientedLine(acc, width, height, reversed, 0, y0, 0, yCross);
+
+        x0 = 0;
+        y0 = yCross;
+    }
+
+    sAccumulateOrientedLine(acc, width, height, reversed, x0, y0, x1, y1);
+}
+
+
+static inline UInt8 sGetCoverage(float area, SwiffRasterizerFillRule rule)
+{
+    float a = fabsf(area);
+
+    if (rule == SwiffRasterizerFillRuleEvenOdd) {
+        a = fmodf(a, 2.0f);
+        if (a > 1.0f) a = 2.0f - a;
+
+    } else if (a > 1.0f) {
+        a = 1.0f;
+    }
+
+    return (UInt8)((a * 255.0f) + 0.5f);
+}
+
+
+#pragma mark -
+#pragma mark Compositing
+
+static inline UInt32 sDiv255(UInt32 x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+
+#if SWIFF_RASTERIZER_SIMD_SSE
+static inline __m128i sDiv255Vector(__m128i x)
+{
+    __m128i t = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+#endif
+
+
+// dst = src * coverage + dst * (1 - srcAlpha * coverage), all premultiplied RGBA8
+static void sCompositeSpan(UInt8 *dst, const UInt8 *src, const UInt8 *coverage, size_t count)
+{
+    size_t i = 0;
+
+#if SWIFF_RASTERIZER_SIMD_NEON
+    for ( ; (i + 8) <= count; i += 8) {
+        uint8x8_t c = vld1_u8(&coverage[i]);
+        if (!vget_lane_u64(vreinterpret_u64_u8(c), 0)) continue;
+
+        uint8x8x4_t s = vld4_u8(&src[i * 4]);
+        uint8x8x4_t d = vld4_u8(&dst[i * 4]);
+
+        // vraddhn_u16(x, vrshrq_n_u16(x, 8)) matches sDiv255()
+        for (NSInteger channel = 0; channel < 4; channel++) {
+            uint16x8_t x = vmull_u8(s.val[channel], c);
+            s.val[channel] = vraddhn_u16(x, vrshrq_n_u16(x, 8));
+        }
+
+        uint8x8_t inverseAlpha = vmvn_u8(s.val[3]);
+
+        for (NSInteger channel = 0; channel < 4; channel++) {
+            uint16x8_t x = vmull_u8(d.val[channel], inverseAlpha);
+            d.val[channel] = vadd_u8(s.val[channel], vraddhn_u16(x, vrshrq_n_u16(x, 8)));
+        }
+
+        vst4_u8(&dst[i * 4], d);
+    }
+
+#elif SWIFF_RASTERIZER_SIMD_SSE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c255 = _mm_set1_epi16(255);
+
+    for ( ; (i + 4) <= count; i += 4) {
+        UInt32 c4;
+        memcpy(&c4, &coverage[i], 4);
+        if (!c4) continue;
+
+        // Each coverage byte repeated for the four channels of its pixel
+        __m128i c = _mm_cvtsi32_si128((int)c4);
+        c = _mm_unpacklo_epi8(c, c);
+        c = _mm_unpacklo_epi16(c, c);
+
+        __m128i s = _mm_loadu_si128((const __m128i *)&src[i * 4]);
+        __m128i d = _mm_loadu_si128((const __m128i *)&dst[i * 4]);
+
+        __m128i sLow  = sDiv255Vector(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(c, zero)));
+        __m128i sHigh = sDiv255Vector(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(c, zero)));
+
+        __m128i inverseLow  = _mm_sub_epi16(c255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLow,  0xFF), 0xFF));
+        __m128i inverseHigh = _mm_sub_epi16(c255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHigh, 0xFF), 0xFF));
+
+        __m128i dLow  = _mm_add_epi16(sLow,  sDiv255Vector(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverseLow)));
+        __m128i dHigh = _mm_add_epi16(sHigh, sDiv255Vector(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverseHigh)));
+
+        _mm_storeu_si128((__m128i *)&dst[i * 4], _mm_packus_epi16(dLow, dHigh));
+    }
+#endif
+
+    for ( ; i < count; i++) {
+        UInt32 c = coverage[i];
+        if (!c) continue;
+
+        const UInt8 *s = &src[i * 4];
+        UInt8       *d = &dst[i * 4];
+
+        UInt32 r = sDiv255(s[0] * c);
+        UInt32 g = sDiv255(s[1] * c);
+        UInt32 b = sDiv255(s[2] * c);
+        UInt32 a = sDiv255(s[3] * c);
+
+        UInt32 inverseAlpha = 255 - a;
+
+        d[0] = r + sDiv255(d[0] * inverseAlpha);
+        d[1] = g + sDiv255(d[1] * inverseAlpha);
+        d[2] = b + sDiv255(d[2] * inverseAlpha);
+        d[3] = a + sDiv255(d[3] * inverseAlpha);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Paint
+
+static inline CGFloat sApplySpreadMode(CGFloat t, SwiffRasterizerSpreadMode spreadMode)
+{
+    if (spreadMode == SwiffRasterizerSpreadModeRepeat) {
+        t = t - floor(t);
+
+    } else if (spreadMode == SwiffRasterizerSpreadModeReflect) {
+        t = fmod(fabs(t), 2.0);
+        if (t > 1.0) t = 2.0 - t;
+
+    } else {
+        if (t < 0.0) t = 0.0;
+        if (t > 1.0) t = 1.0;
+    }
+
+    return t;
+}
+
+
+static inline const UInt8 *sGetBitmapPixel(const SwiffRasterizerPaint *paint, NSInteger x, NSInteger y)
+{
+    NSInteger width  = paint->bitmapWidth;
+    NSInteger height = paint->bitmapHeight;
+
+    if (paint->bitmapRepeats) {
+        x %= width;  if (x < 0) x += width;
+        y %= height; if (y < 0) y += height;
+    } else {
+        // Clipped bitmaps are affine clamped, their edge pixels extend outwards
+        x = MAX(0, MIN(x, width  - 1));
+        y = MAX(0, MIN(y, height - 1));
+    }
+
+    return paint->bitmapPixels + (y * paint->bitmapBytesPerRow) + (x * 4);
+}
+
+
+// Fills src[0..count) with the premultiplied paint color of pixels (x, y) through (x + count - 1, y)
+static void sFetchSpan(const SwiffRasterizerPaint *paint, NSInteger x, NSInteger y, size_t count, UInt8 *src)
+{
+    CGAffineTransform t = paint->inverseTransform;
+
+    // Sample at pixel centers, stepping by (t.a, t.b) per pixel
+    CGFloat u = (t.a * (x + 0.5)) + (t.c * (y + 0.5)) + t.tx;
+    CGFloat v = (t.b * (x + 0.5)) + (t.d * (y + 0.5)) + t.ty;
+
+    if (paint->type == SwiffRasterizerPaintTypeColor) {
+        for (size_t i = 0; i < count; i++) {
+            memcpy(&src[i * 4], paint->color, 4);
+        }
+
+    } else if (paint->type == SwiffRasterizerPaintTypeLinearGradient) {
+        const CGFloat half = sGradientSquareSize / 2;
+
+        for (size_t i = 0; i < count; i++, u += t.a) {
+            CGFloat   position = sApplySpreadMode((u + half) / sGradientSquareSize, paint->spreadMode);
+            NSInteger index    = (NSInteger)((position * (SwiffRasterizerGradientTableLength - 1)) + 0.5);
+
+            memcpy(&src[i * 4], &paint->gradientTable[index * 4], 4);
+        }
+
+    } else if (paint->type == SwiffRasterizerPaintTypeRadialGradient) {
+        const CGFloat radius = sGradientSquareSize / 2;
+
+        for (size_t i = 0; i < count; i++, u += t.a, v += t.b) {
+            CGFloat   position = sApplySpreadMode(sqrt((u * u) + (v * v)) / radius, paint->spreadMode);
+            NSInteger index    = (NSInteger)((position * (SwiffRasterizerGradientTableLength - 1)) + 0.5);
+
+            memcpy(&src[i * 4], &paint->gradientTable[index * 4], 4);
+        }
+
+    } else if (paint->type == SwiffRasterizerPaintTypeBitmap) {
+        UInt32 alpha = paint->bitmapAlpha;
+
+        if (!paint->bitmapPixels || !paint->bitmapWidth || !paint->bitmapHeight) {
+            memset(src, 0, count * 4);
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++, u += t.a, v += t.b) {
+            UInt8 *out = &src[i * 4];
+
+            if (paint->bitmapSmooths) {
+                CGFloat   su = u - 0.5, sv = v - 0.5;
+                CGFloat   fu = floor(su), fv = floor(sv);
+                NSInteger iu = (NSInteger)fu, iv = (NSInteger)fv;
+                UInt32    wu = (UInt32)((su - fu) * 256), wv = (UInt32)((sv - fv) * 256);
+
+                const UInt8 *p00 = sGetBitmapPixel(paint, iu,     iv);
+                const UInt8 *p10 = sGetBitmapPixel(paint, iu + 1, iv);
+                const UInt8 *p01 = sGetBitmapPixel(paint, iu,     iv + 1);
+                const UInt8 *p11 = sGetBitmapPixel(paint, iu + 1, iv + 1);
+
+                for (NSInteger channel = 0; channel < 4; channel++) {
+                    UInt32 top    = (p00[channel] * (256 - wu)) + (p10[channel] * wu);
+                    UInt32 bottom = (p01[channel] * (256 - wu)) + (p11[channel] * wu);
+                    UInt32 value  = ((top * (256 - wv)) + (bottom * wv) + (1 << 15)) >> 16;
+
+                    out[channel] = sDiv255(value * alpha);
+                }
+
+            } else {
+                const UInt8 *p = sGetBitmapPixel(paint, (NSInteger)floor(u), (NSInteger)floor(v));
+
+                out[0] = sDiv255(p[0] * alpha);
+                out[1] = sDiv255(p[1] * alpha);
+                out[2] = sDiv255(p[2] * alpha);
+                out[3] = sDiv255(p[3] * alpha);
+            }
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Rasterization
+
+// Rasterizes path and either composites paint through the resulting coverage, or, when
+// clipMask is non-NULL, unions the coverage into clipMask
+//
+static void sRasterizePath(
+    SwiffRasterizer *rasterizer,
+    SwiffRasterizerPath *path,
+    SwiffRasterizerFillRule rule,
+    const SwiffRasterizerPaint *paint,
+    UInt8 *clipMask
+) {
+    if (!path->pointsCount) return;
+
+    CGFloat minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+
+    for (NSUInteger i = 0; i < path->pointsCount; i++) {
+        CGPoint p = path->points[i];
+        if (p.x < minX) minX = p.x;
+        if (p.x > maxX) maxX = p.x;
+        if (p.y < minY) minY = p.y;
+        if (p.y > maxY) maxY = p.y;
+    }
+
+    NSInteger left   = MAX(0, (NSInteger)floor(minX));
+    NSInteger top    = MAX(0, (NSInteger)floor(minY));
+    NSInteger right  = MIN((NSInteger)rasterizer->width,  (NSInteger)ceil(maxX));
+    NSInteger bottom = MIN((NSInteger)rasterizer->height, (NSInteger)ceil(maxY));
+
+    if ((left >= right) || (top >= bottom)) return;
+
+    size_t width  = right  - left;
+    size_t height = bottom - top;
+    size_t stride = width + 2;
+
+    size_t cells = stride * height;
+    if (rasterizer->accumulationCapacity < cells) {
+        free(rasterizer->accumulation);
+        rasterizer->accumulation = malloc(cells * sizeof(float));
+        rasterizer->accumulationCapacity = cells;
+    }
+
+    float *acc = rasterizer->accumulation;
+    memset(acc, 0, cells * sizeof(float));
+
+    CGPoint origin = CGPointMake(left, top);
+
+    for (NSUInteger s = 0; s < path->subpathsCount; s++) {
+        SwiffRasterizerSubpath subpath = path->subpaths[s];
+        CGPoint *points = &path->points[subpath.start];
+
+        for (NSUInteger i = 0; i < subpath.count; i++) {
+            CGPoint p0 = points[i];
+            CGPoint p1 = points[(i + 1) % subpath.count];  // Implicitly closed
+
+            p0.x -= origin.x;  p0.y -= origin.y;
+            p1.x -= origin.x;  p1.y -= origin.y;
+
+            sAccumulateEdge(acc, width, height, p0, p1);
+        }
+    }
+
+    UInt8 *coverage = rasterizer->coverage;
+    UInt8 *source   = rasterizer->source;
+
+    for (size_t y = 0; y < height; y++) {
+        float *row = acc + (y * stride);
+        float  sum = 0;
+
+        NSInteger first = -1, last = -1;
+
+        for (size_t x = 0; x < width; x++) {
+            sum += row[x];
+
+            UInt8 c = sGetCoverage(sum, rule);
+            coverage[x] = c;
+
+            if (c) {
+                if (first < 0) first = x;
+                last = x;
+            }
+        }
+
+        if (first < 0) continue;
+
+        size_t  count     = (last - first) + 1;
+        size_t  pixelY    = top + y;
+        size_t  pixelX    = left + first;
+        UInt8  *spanCoverage = &coverage[first];
+
+        if (clipMask) {
+            UInt8 *mask = &clipMask[(pixelY * rasterizer->width) + pixelX];
+
+            for (size_t i = 0; i < count; i++) {
+                mask[i] = mask[i] + spanCoverage[i] - sDiv255(mask[i] * spanCoverage[i]);
+            }
+
+            continue;
+        }
+
+        if (rasterizer->isClipping) {
+            UInt8 *mask = &rasterizer->clipMask[(pixelY * rasterizer->width) + pixelX];
+
+            for (size_t i = 0; i < count; i++) {
+                spanCoverage[i] = sDiv255(spanCoverage[i] * mask[i]);
+            }
+        }
+
+        UInt8 *dst = rasterizer->pixels + (pixelY * rasterizer->bytesPerRow) + (pixelX * 4);
+        sFetchSpan(paint, pixelX, pixelY, count, source);
+
+        if ((paint->blendMode == SwiffBlendModeNormal) || (paint->blendMode == SwiffBlendModeLayer)) {
+            sCompositeSpan(dst, source, spanCoverage, count);
+        } else {
+            SwiffBlendModeCompositeSpan(paint->blendMode, dst, source, spanCoverage, count);
+        }
+    }
+}
+
+
+static void sAddDisk(SwiffRasterizerPath *path, CGPoint center, CGFloat radius)
+{
+    // Enough segments that the polygon stays within 1/8 pixel of the circle
+    NSInteger segments = 8;
+    if (radius > 0.125) {
+        segments = (NSInteger)ceil(M_PI / acos(1 - (0.125 / radius)));
+        segments = MAX(8, MIN(segments, 64));
+    }
+
+    // Push the vertices out so that the polygon has the area of the circle
+    CGFloat step = (2 * M_PI) / segments;
+    CGFloat vertexRadius = radius * sqrt(step / sin(step));
+
+    // Clockwise, matching the orientation of the segment quads in sStrokePath()
+    for (NSInteger i = 0; i < segments; i++) {
+        CGFloat angle = -step * i;
+        CGPoint p = CGPointMake(center.x + (vertexRadius * cos(angle)), center.y + (vertexRadius * sin(angle)));
+
+        if (i == 0) {
+            sPathMoveTo(path, p);
+        } else {
+            sPathLineTo(path, p);
+        }
+    }
+}
+
+
+// Expands the current path into one quad per segment, plus a disk at every vertex for round
+// joins and caps.  All polygons share one orientation, so the non-zero rule unions them.
+//
+static void sStrokePath(SwiffRasterizer *rasterizer, CGFloat width, BOOL isHairline)
+{
+    SwiffRasterizerPath *path   = &rasterizer->path;
+    SwiffRasterizerPath *stroke = &rasterizer->strokePath;
+    CGFloat halfWidth = width / 2;
+
+    sPathReset(stroke);
+
+    for (NSUInteger s = 0; s < path->subpathsCount; s++) {
+        SwiffRasterizerSubpath subpath = path->subpaths[s];
+        CGPoint *points = &path->points[subpath.start];
+        NSUInteger segmentCount = subpath.closed ? subpath.count : (subpath.count - 1);
+
+        for (NSUInteger i = 0; i < segmentCount; i++) {
+            CGPoint a = points[i];
+            CGPoint b = points[(i + 1) % subpath.count];
+
+            CGFloat dx = b.x - a.x, dy = b.y - a.y;
+            CGFloat length = sqrt((dx * dx) + (dy * dy));
+            if (length == 0) continue;
+
+            CGFloat nx = (-dy / length) * halfWidth;
+            CGFloat ny = ( dx / length) * halfWidth;
+
+            sPathMoveTo(stroke, CGPointMake(a.x + nx, a.y + ny));
+            sPathLineTo(stroke, CGPointMake(b.x + nx, b.y + ny));
+            sPathLineTo(stroke, CGPointMake(b.x - nx, b.y - ny));
+            sPathLineTo(stroke, CGPointMake(a.x - nx, a.y - ny));
+        }
+
+        if (!isHairline) {
+            for (NSUInteger i = 0; i < subpath.count; i++) {
+                sAddDisk(stroke, points[i], halfWidth);
+            }
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Public Functions
+
+SwiffRasterizer *SwiffRasterizerCreate(UInt8 *pixels, size_t width, size_t height, size_t bytesPerRow)
+{
+    if (!pixels || !width || !height || (bytesPerRow < (width * 4))) {
+        return NULL;
+    }
+
+    SwiffRasterizer *rasterizer = calloc(1, sizeof(SwiffRasterizer));
+
+    rasterizer->pixels      = pixels;
+    rasterizer->width       = width;
+    rasterizer->height      = height;
+    rasterizer->bytesPerRow = bytesPerRow;
+    rasterizer->coverage    = malloc(width);
+    rasterizer->source      = malloc(width * 4);
+
+    return rasterizer;
+}
+
+
+void SwiffRasterizerFree(SwiffRasterizer *rasterizer)
+{
+    if (!rasterizer) return;
+
+    sPathFree(&rasterizer->path);
+    sPathFree(&rasterizer->strokePath);
+
+    free(rasterizer->accumulation);
+    free(rasterizer->coverage);
+    free(rasterizer->source);
+    free(rasterizer->clipMask);
+    free(rasterizer->pendingClipMask);
+    free(rasterizer);
+}
+
+
+void SwiffRasterizerBeginPath(SwiffRasterizer *rasterizer)
+{
+    sPathReset(&rasterizer->path);
+}
+
+
+void SwiffRasterizerMoveToPoint(SwiffRasterizer *rasterizer, CGPoint point)
+{
+    sPathMoveTo(&rasterizer->path, point);
+}
+
+
+void SwiffRasterizerAddLineToPoint(SwiffRasterizer *rasterizer, CGPoint point)
+{
+    sPathLineTo(&rasterizer->path, point);
+}
+
+
+void SwiffRasterizerAddQuadCurveToPoint(SwiffRasterizer *rasterizer, CGPoint control, CGPoint point)
+{
+    sPathQuadCurveTo(&rasterizer->path, control, point);
+}
+
+
+void SwiffRasterizerClosePath(SwiffRasterizer *rasterizer)
+{
+    SwiffRasterizerPath *path = &rasterizer->path;
+
+    if (path->subpathsCount) {
+        path->subpaths[path->subpathsCount - 1].closed = YES;
+    }
+}
+
+
+void SwiffRasterizerFillPath(SwiffRasterizer *rasterizer, SwiffRasterizerFillRule rule, const SwiffRasterizerPaint *paint)
+{
+    sRasterizePath(rasterizer, &rasterizer->path, rule, paint, NULL);
+    sPathReset(&rasterizer->path);
+}
+
+
+void SwiffRasterizerStrokePath(SwiffRasterizer *rasterizer, CGFloat width, BOOL isHairline, const SwiffRasterizerPaint *paint)
+{
+    if (width > 0) {
+        sStrokePath(rasterizer, width, isHairline);
+        sRasterizePath(rasterizer, &rasterizer->strokePath, SwiffRasterizerFillRuleNonZero, paint, NULL);
+    }
+
+    sPathReset(&rasterizer->path);
+}
+
+
+void SwiffRasterizerBeginClipMask(SwiffRasterizer *rasterizer)
+{
+    size_t length = rasterizer->width * rasterizer->height;
+
+    if (!rasterizer->pendingClipMask) {
+        rasterizer->pendingClipMask = malloc(length);
+    }
+
+    memset(rasterizer->pendingClipMask, 0, length);
+}
+
+
+void SwiffRasterizerAddPathToClipMask(SwiffRasterizer *rasterizer, SwiffRasterizerFillRule rule)
+{
+    if (rasterizer->pendingClipMask) {
+        sRasterizePath(rasterizer, &rasterizer->path, rule, NULL, rasterizer->pendingClipMask);
+    }
+
+    sPathReset(&rasterizer->path);
+}
+
+
+void SwiffRasterizerApplyClipMask(SwiffRasterizer *rasterizer)
+{
+    if (!rasterizer->pendingClipMask) return;
+
+    UInt8 *mask = rasterizer->clipMask;
+    rasterizer->clipMask        = rasterizer->pendingClipMask;
+    rasterizer->pendingClipMask = mask;
+    rasterizer->isClipping      = YES;
+}
+
+
+void SwiffRasterizerRemoveClipMask(SwiffRasterizer *rasterizer)
+{
+    rasterizer->isClipping = NO;
+}
+
+
+BOOL SwiffRasterizerCopyClipMask(SwiffRasterizer *rasterizer, UInt8 *outCoverage, NSInteger x, NSInteger y, size_t width, size_t height)
+{
+    if (!rasterizer->pendingClipMask) return NO;
+    if ((x < 0) || (y < 0) || (((size_t)x + width) > rasterizer->width) || (((size_t)y + height) > rasterizer->height)) return NO;
+
+    for (size_t row = 0; row < height; row++) {
+        memcpy(&outCoverage[row * width], &rasterizer->pendingClipMask[((y + row) * rasterizer->width) + x], width);
+    }
+
+    return YES;
+}
+
+
+void SwiffRasterizerAddCoverageToClipMask(SwiffRasterizer *rasterizer, const UInt8 *coverage, NSInteger x, NSInteger y, size_t width, size_t height)
+{
+    if (!rasterizer->pendingClipMask) return;
+
+    NSInteger left   = MAX(x, 0);
+    NSInteger top    = MAX(y, 0);
+    NSInteger right  = MIN(x + (NSInteger)width,  (NSInteger)rasterizer->width);
+    NSInteger bottom = MIN(y + (NSInteger)height, (NSInteger)rasterizer->height);
+
+    for (NSInteger pixelY = top; pixelY < bottom; pixelY++) {
+        const UInt8 *src  = &coverage[((pixelY - y) * width) + (left - x)];
+        UInt8       *mask = &rasterizer->pendingClipMask[(pixelY * rasterizer->width) + left];
+
+        for (NSInteger i = 0; i < (right - left); i++) {
+            mask[i] = mask[i] + src[i] - sDiv255(mask[i] * src[i]);
+        }
+    }
+}
@@ -28,7 +28,7 @@
 #import <SwiffImport.h>
 #import <SwiffTypes.h>
 
-@class SwiffMovie;
+@class SwiffMovie, SwiffDisplayList, SwiffBitmapCache, SwiffTimeline;
 
 
 @interface SwiffRenderer : NSObject
@@ -37,6 +37,24 @@
 
 - (void) renderPlacedObjects:(NSArray *)placedObjects inContext:(CGContextRef)context;
 
+// Renders with the CPU rasterizer (see SwiffRasterizer.h) into a premultiplied RGBA8 buffer,
+// bytes in R, G, B, A order, row 0 at the top.  Dynamic text is not drawn, and SwiffBlendModeOther modes draw as normal.
+- (void) renderPlacedObjects:(NSArray *)placedObjects intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow;
+
+// Records the drawing of placedObjects into a display list (see SwiffDisplayList.h), which may be replayed many
+// times.  Colors are final at record time, including the color modifications.  baseAffineTransform, the hairline
+// widths, and pixel-snapping are instead taken from the renderer at replay time.
+- (SwiffDisplayList *) displayListForPlacedObjects:(NSArray *)placedObjects;
+
+- (void) renderDisplayList:(SwiffDisplayList *)displayList inContext:(CGContextRef)context;
+- (void) renderDisplayList:(SwiffDisplayList *)displayList intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow;
+
+// Rasterizes in tiles of tileSize x tileSize pixels (256 when 0), concurrently on all cores.  Each tile
+// replays the display list with its own render state and rasterizer, directly into its part of buffer.
+// The placed objects are traversed once, on the calling thread.
+- (void) renderPlacedObjects:(NSArray *)placedObjects intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow tileSize:(size_t)tileSize;
+- (void) renderDisplayList:(SwiffDisplayList *)displayList intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow tileSize:(size_t)tileSize;
+
 @property (nonatomic, strong, readonly) SwiffMovie *movie;
 
 @property (nonatomic, assign) CGAffineTransform *baseAffineTransform;
@@ -44,9 +62,29 @@
 // Hint to renderer about the original contentsScale of the context.  Used only for pixel-snapping, not scaling
 @property (nonatomic, assign) CGFloat scaleFactorHint;
 
-// When non-NULL, all rendered colors are multiplied by the specified color
+// When non-NULL, all rendered colors are multiplied by the specified color.  Replacing it, or releasing the
+// renderer while it is set, removes all pixels from bitmapCache
 @property (nonatomic, strong) SwiffColorModificationBlock colorModificationBlock;
 
+// When non-NULL, applied to all rendered colors after the color transform stack and before colorModificationBlock.
+// It is composed into the stack once per push, so unlike colorModificationBlock it has no per-color cost
+@property (nonatomic, assign) SwiffColorTransform *colorModificationTransform;
+
+// When non-nil, placed objects with cachesAsBitmap are rasterized into bitmapCache once, and then drawn from it
+// while only their position changes.  The tiled methods do not use it.  SwiffLayer uses the bitmapCache of its movie
+@property (nonatomic, strong) SwiffBitmapCache *bitmapCache;
+
+// When non-nil, sprites draw the current frame of their instance in timeline, which should be at the frame of
+// the placed objects being rendered.  Otherwise, sprites draw their first frame.  SwiffLayer uses its playhead's
+@property (nonatomic, strong) SwiffTimeline *timeline;
+
+// When YES, sprites drawing many paths are also drawn through bitmapCache, once they are seen to only move
+@property (nonatomic, assign) BOOL shouldCacheSlidingSprites;
+
+// The number of placed objects which were not drawn, as they were outside of the bounds of their clipping mask.
+// Counted as the placed objects are traversed, so replaying a display list does not add to it
+@property (nonatomic, assign, readonly) NSUInteger maskCulledCount;
+
 @property (nonatomic, assign) CGFloat hairlineWidth;
 @property (nonatomic, assign) CGFloat fillHairlineWidth;
 
@@ -29,31 +29,161 @@
 #import "SwiffRenderer.h"
 
 #import "SwiffBitmapDefinition.h"
+#import "SwiffDisplayList.h"
 #import "SwiffDynamicTextAttributes.h"
 #import "SwiffDynamicTextDefinition.h"
-#import "SwiffFontDefinition.h"
 #import "SwiffFrame.h"
 #import "SwiffMovie.h"
 #import "SwiffGradient.h"
 #import "SwiffLineStyle.h"
 #import "SwiffFillStyle.h"
+#import "SwiffBitmapCache.h"
+#import "SwiffBlendProcessor.h"
+#import "SwiffFilterProcessor.h"
 #import "SwiffPath.h"
 #import "SwiffPlacedObject.h"
 #import "SwiffPlacedDynamicText.h"
+#import "SwiffRasterizer.h"
 #import "SwiffShapeDefinition.h"
 #import "SwiffStaticTextRecord.h"
 #import "SwiffStaticTextDefinition.h"
+#import "SwiffTimeline.h"
 #import "SwiffUtils.h"
 
+#if CGFLOAT_IS_DOUBLE && defined(__ARM_NEON) && defined(__aarch64__)
+#import <arm_neon.h>
+#define SWIFF_RENDERER_SIMD_NEON 1
+#elif CGFLOAT_IS_DOUBLE && defined(__SSE4_1__)
+#import <smmintrin.h>
+#define SWIFF_RENDERER_SIMD_SSE 1
+#endif
+
+static const size_t sDefaultTileSize = 256;
+
+// Sprites drawing at least this many paths are complex enough for shouldCacheSlidingSprites
+static const NSUInteger sComplexSpritePathCount = 32;
+
+
+// Identifies the pixels of a placed object in a SwiffBitmapCache: what it draws, and with which colors.
+// The transform is handled by the cache itself.  Clip masks are cached as coverage, and ignore the colors
+@interface SwiffRenderBitmapKey : NSObject {
+@public
+    UInt16                      _libraryID;
+    SwiffComposedColorTransform _colorTransform;
+    __unsafe_unretained SwiffColorModificationBlock _colorModificationBlock; // Compared by identity, see -setColorModificationBlock:
+    NSArray                    *_filters;
+    NSUInteger                  _frameIndex;     // Of a sprite instance, with the frames of its own sprite instances
+    NSData                     *_childFrames;
+    BOOL                        _isClipMask;
+    BOOL                        _isAutomatic;    // From shouldCacheSlidingSprites, not part of equality
+    NSUInteger                  _hash;           // Computed on first use, keys do not change once submitted
+}
+@end
+
+
+@implementation SwiffRenderBitmapKey
+
+// Covers everything which -isEqual: compares, as instances of one symbol with different tints or
+// alpha would otherwise share a hash, and turn each cache lookup into a scan
+- (NSUInteger) hash
+{
+    if (!_hash) {
+        // FNV-1a over the color transform
+        const UInt8 *bytes = (const UInt8 *)&_colorTransform;
+        NSUInteger hash = 2166136261U;
+
+        for (size_t i = 0; i < sizeof(SwiffComposedColorTransform); i++) {
+            hash = (hash ^ bytes[i]) * 16777619U;
+        }
+
+        hash ^= _libraryID;
+        hash ^= [_filters count] << 16;
+        hash ^= _frameIndex << 8;
+        hash ^= [_childFrames hash];
+        hash ^= ((NSUInteger)(__bridge void *)_colorModificationBlock) >> 4;
+
+        if (_isClipMask) hash = ~hash;
+
+        _hash = hash;
+    }
+
+    return _hash;
+}
+
+
+- (BOOL) isEqual:(id)otherObject
+{
+    if (![otherObject isKindOfClass:[SwiffRenderBitmapKey class]]) return NO;
+
+    SwiffRenderBitmapKey *other = otherObject;
+
+    if (_libraryID != other->_libraryID) return NO;
+    if (_isClipMask != other->_isClipMask) return NO;
+    if (_frameIndex != other->_frameIndex) return NO;
+    if (_colorModificationBlock != other->_colorModificationBlock) return NO;
+    if (memcmp(&_colorTransform, &other->_colorTransform, sizeof(SwiffComposedColorTransform)) != 0) return NO;
+
+    if ((_childFrames != other->_childFrames) && ![_childFrames isEqual:other->_childFrames]) return NO;
+
+    return (_filters == other->_filters) || [_filters isEqual:other->_filters];
+}
+
+@end
+
+
+typedef struct SwiffRenderLayer {
+    CGContextRef      parentContext;
+    SwiffRasterizer  *parentRasterizer;
+    CGPoint           parentRasterizerOrigin;
+    UInt8            *pixels;
+    CGImageRef        image;               // Of pixels, when made before sDrawLayer()
+    BOOL              hasBorrowedPixels;   // pixels belong to an NSData in the bitmap cache, and are never freed or changed
+    CGRect            rect;                // Integral, in the device space of the parent
+    CGFloat           scale;               // Multiplies the sizes of the filters
+    __unsafe_unretained NSArray *filters;
+    SwiffBlendMode    blendMode;           // Used to draw the layer into its parent
+    __unsafe_unretained SwiffRenderBitmapKey *cacheKey; // Non-nil when the pixels are added to the bitmap cache
+    CGAffineTransform cacheTransform;
+    BOOL              isDirect;            // Drawing goes directly into the parent, see sBeginLayer()
+} SwiffRenderLayer;
+
 
 typedef struct SwiffRenderState {
     __unsafe_unretained SwiffMovie *movie;
     __unsafe_unretained SwiffColorModificationBlock colorModificationBlock;
 
     CGContextRef      context;
+    SwiffRasterizer  *rasterizer;          // Non-NULL when rendering with the CPU rasterizer instead of context
+    __unsafe_unretained SwiffDisplayList *displayList; // Non-nil when recording commands instead of drawing them
+    CFMutableDictionaryRef bitmapPixels;   // Bitmap library ID -> CFDataRef of RGBA8 pixels, for the rasterizer
     CGRect            clipBoundingBox;
+    CGRect            clipMaskBounds;      // Of the active clipping mask while clipDepth is non-zero, in the space of renderBounds
+    NSUInteger        maskCulledCount;     // Placed objects skipped as they are outside of clipMaskBounds
+    CGRect            renderBounds;        // Of the placed object being drawn, in the space of affineTransform
     CGAffineTransform affineTransform;
-    CFMutableArrayRef colorTransforms;
+    SwiffComposedColorTransform *colorTransforms;  // colorTransforms[i] is the composition of the first i + 1 pushes
+    NSUInteger        colorTransformsCount;
+    NSUInteger        colorTransformsCapacity;
+    SwiffComposedColorTransform colorTransform;    // The top of colorTransforms, then colorModificationTransform
+    SwiffColorTransform colorModificationTransform;
+    BOOL              hasColorModificationTransform;
+    SwiffRenderLayer *layers;              // Offscreen layers of placed objects with filters or blend modes, innermost last
+    NSUInteger        layersCount;
+    NSUInteger        layersCapacity;
+    CGPoint           rasterizerOrigin;    // The position of the rasterizer's pixels in the device space of the commands
+    CGSize            filterOutset;        // Added to renderBounds, for the filters of the placed objects being drawn
+    CGFloat           baseScale;           // Of the base transform.  Filter sizes are in movie pixels, and are multiplied by this
+    __unsafe_unretained SwiffBitmapCache *bitmapCache;
+    __unsafe_unretained SwiffTimeline *timeline; // Of the sprite instance being drawn
+    NSUInteger        skippedLayersCount;  // While non-zero, commands are skipped, as their layer was drawn from bitmapCache
+    NSUInteger        skippedClipPathsCount; // While non-zero, the clipping path was drawn from bitmapCache, see sBeginClipMask()
+    __unsafe_unretained SwiffRenderBitmapKey *clipMaskKey; // Non-nil when the coverage of the clipping path is added to bitmapCache
+    CGRect            clipMaskRect;        // Integral, in device space
+    CGAffineTransform clipMaskTransform;
+    CGImageRef        clipMaskImage;       // The cached coverage of the clipping path, when drawing into context
+    CGPoint          *points;
+    CGPoint          *snappedPoints;
+    NSUInteger        pointsCapacity;
     CGFloat           scaleFactorHint;
     CGFloat           hairlineWidth;
     CGFloat           fillHairlineWidth;
@@ -62,70 +192,212 @@ typedef struct SwiffRenderState {
     BOOL              ceilX;
     BOOL              ceilY;
     BOOL              skipUntilClipDepth;
+    BOOL              shouldAntialias;
+    BOOL              shouldSmoothFonts;
+    BOOL              shouldSubpixelPositionFonts;
+    BOOL              shouldSubpixelQuantizeFonts;
+    BOOL              shouldCacheSlidingSprites;
 } SwiffRenderState;
 
 
 static void sDrawPlacedObject(SwiffRenderState *state, SwiffPlacedObject *placedObject);
-static void sStopClipping(SwiffRenderState *state);
 
 
-static void sStartClipping(SwiffRenderState *state, UInt16 clipDepth)
+static const SwiffComposedColorTransform *sGetStackColorTransform(SwiffRenderState *state)
 {
-    if (state->clipDepth == 0) {
-        CGContextRef context = state->context;
+    NSUInteger count = state->colorTransformsCount;
+    return count ? &state->colorTransforms[count - 1] : &SwiffComposedColorTransformIdentity;
+}
 
-        CGContextSaveGState(context);
-        CGContextClip(context);
 
-        state->clipDepth = clipDepth;
+static void sUpdateColorTransform(SwiffRenderState *state)
+{
+    const SwiffComposedColorTransform *stackTransform = sGetStackColorTransform(state);
+
+    if (state->hasColorModificationTransform) {
+        state->colorTransform = SwiffComposedColorTransformAppend(stackTransform, &state->colorModificationTransform);
+    } else {
+        state->colorTransform = *stackTransform;
     }
 }
 
 
-static void sStopClipping(SwiffRenderState *state)
+static void sPushColorTransform(SwiffRenderState *state, const SwiffColorTransform *transform)
 {
-    if (state->clipDepth) {
-        CGContextRestoreGState(state->context);
-        state->clipDepth = 0;
-        state->skipUntilClipDepth = NO;
+    if (state->colorTransformsCount == state->colorTransformsCapacity) {
+        state->colorTransformsCapacity = state->colorTransformsCapacity ? (state->colorTransformsCapacity * 2) : 8;
+        state->colorTransforms = realloc(state->colorTransforms, sizeof(SwiffComposedColorTransform) * state->colorTransformsCapacity);
     }
+
+    SwiffComposedColorTransform composed = SwiffComposedColorTransformAppend(sGetStackColorTransform(state), transform);
+    state->colorTransforms[state->colorTransformsCount++] = composed;
+
+    sUpdateColorTransform(state);
 }
 
 
-static void sPushColorTransform(SwiffRenderState *state, const SwiffColorTransform *transform)
+static void sPopColorTransform(SwiffRenderState *state)
+{
+    state->colorTransformsCount--;
+    sUpdateColorTransform(state);
+}
+
+
+static SwiffColor sResolveColor(SwiffRenderState *state, SwiffColor color)
 {
-    if (!state->colorTransforms) {
-        state->colorTransforms = CFArrayCreateMutable(NULL, 0, NULL);
+    color = SwiffColorApplyComposedColorTransform(color, &state->colorTransform);
+
+    if (state->colorModificationBlock) {
+        state->colorModificationBlock(&color);
     }
 
-    CFMutableArrayRef array = state->colorTransforms;
-    CFArraySetValueAtIndex(array, CFArrayGetCount(array), transform);
+    return color;
 }
 
 
-static void sPopColorTransform(SwiffRenderState *state)
+#pragma mark -
+#pragma mark Point Kernels
+
+// Makes sure both point buffers of state hold at least count points
+static void sReservePoints(SwiffRenderState *state, NSUInteger count)
+{
+    if (state->pointsCapacity < count) {
+        state->pointsCapacity = MAX(count, state->pointsCapacity * 2);
+        state->points        = realloc(state->points,        state->pointsCapacity * sizeof(CGPoint));
+        state->snappedPoints = realloc(state->snappedPoints, state->pointsCapacity * sizeof(CGPoint));
+    }
+}
+
+
+// This works around <rdar://10646847> and also immitates what the Flash engine does
+static CGPoint sSnapFillPoint(CGPoint point)
+{
+    CGFloat iX, iY, fX, fY;
+
+#if CGFLOAT_IS_DOUBLE
+    fX= modf(point.x, &iX);
+    fY= modf(point.y, &iY);
+
+    if (fX < 0.15 || fX > 0.85) point.x = round(point.x);
+    if (fY < 0.15 || fY > 0.85) point.y = round(point.y);
+#else
+    fX= modff(point.x, &iX);
+    fY= modff(point.y, &iY);
+
+    if (fX < 0.15 || fX > 0.85) point.x = roundf(point.x);
+    if (fY < 0.15 || fY > 0.85) point.y = roundf(point.y);
+#endif
+
+    return point;
+}
+
+
+// Batch version of sSnapFillPoint().  Each vector holds the x and y of a single point.
+static void sSnapFillPoints(const CGPoint *inPoints, CGPoint *outPoints, NSUInteger count)
+{
+    NSUInteger i = 0;
+
+#if SWIFF_RENDERER_SIMD_NEON
+    const float64x2_t low  = vdupq_n_f64(0.15);
+    const float64x2_t high = vdupq_n_f64(0.85);
+
+    for ( ; i < count; i++) {
+        float64x2_t p = vld1q_f64((const double *)&inPoints[i]);
+        float64x2_t f = vsubq_f64(p, vrndq_f64(p));
+        uint64x2_t  m = vorrq_u64(vcltq_f64(f, low), vcgtq_f64(f, high));
+
+        vst1q_f64((double *)&outPoints[i], vbslq_f64(m, vrndaq_f64(p), p));
+    }
+
+#elif SWIFF_RENDERER_SIMD_SSE
+    const __m128d low  = _mm_set1_pd(0.15);
+    const __m128d high = _mm_set1_pd(0.85);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d one  = _mm_set1_pd(1.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+
+    for ( ; i < count; i++) {
+        __m128d p = _mm_loadu_pd((const double *)&inPoints[i]);
+        __m128d t = _mm_round_pd(p, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        __m128d f = _mm_sub_pd(p, t);
+        __m128d m = _mm_or_pd(_mm_cmplt_pd(f, low), _mm_cmpgt_pd(f, high));
+
+        // round() is half away from zero: trunc(p), plus copysign(1, p) when |fraction| >= 0.5.
+        // The sign of p is then reapplied so that e.g. -0.3 rounds to -0.0, as round() does.
+        __m128d pSign = _mm_and_pd(sign, p);
+        __m128d away  = _mm_cmpge_pd(_mm_andnot_pd(sign, f), half);
+        __m128d r     = _mm_or_pd(_mm_add_pd(t, _mm_and_pd(away, _mm_or_pd(one, pSign))), pSign);
+
+        _mm_storeu_pd((double *)&outPoints[i], _mm_blendv_pd(p, r, m));
+    }
+#endif
+
+    for ( ; i < count; i++) {
+        outPoints[i] = sSnapFillPoint(inPoints[i]);
+    }
+}
+
+
+// Rounds each point to the device pixel grid (given by scale), then nudges by offset
+// towards the center of the pixel, for crisp hairlines and odd-width strokes
+static void sSnapStrokePoints(const CGPoint *inPoints, CGPoint *outPoints, NSUInteger count, CGFloat scale, CGFloat offset, BOOL ceilX, BOOL ceilY)
 {
-    CFMutableArrayRef array = state->colorTransforms;
-    CFArrayRemoveValueAtIndex(array, CFArrayGetCount(array) - 1);
+    NSUInteger i = 0;
+
+#if SWIFF_RENDERER_SIMD_NEON
+    const uint64_t    maskArray[2] = { ceilX ? UINT64_MAX : 0, ceilY ? UINT64_MAX : 0 };
+    const uint64x2_t  useCeil = vld1q_u64(maskArray);
+    const float64x2_t vScale  = vdupq_n_f64(scale);
+    const float64x2_t vOffset = vdupq_n_f64(offset);
+
+    for ( ; i < count; i++) {
+        float64x2_t p = vmulq_f64(vld1q_f64((const double *)&inPoints[i]), vScale);
+        float64x2_t c = vsubq_f64(vdivq_f64(vrndpq_f64(p), vScale), vOffset);
+        float64x2_t f = vaddq_f64(vdivq_f64(vrndmq_f64(p), vScale), vOffset);
+
+        vst1q_f64((double *)&outPoints[i], vbslq_f64(useCeil, c, f));
+    }
+
+#elif SWIFF_RENDERER_SIMD_SSE
+    const __m128d useCeil = _mm_castsi128_pd(_mm_set_epi64x(ceilY ? -1 : 0, ceilX ? -1 : 0));
+    const __m128d vScale  = _mm_set1_pd(scale);
+    const __m128d vOffset = _mm_set1_pd(offset);
+
+    for ( ; i < count; i++) {
+        __m128d p = _mm_mul_pd(_mm_loadu_pd((const double *)&inPoints[i]), vScale);
+        __m128d c = _mm_sub_pd(_mm_div_pd(_mm_ceil_pd(p),  vScale), vOffset);
+        __m128d f = _mm_add_pd(_mm_div_pd(_mm_floor_pd(p), vScale), vOffset);
+
+        _mm_storeu_pd((double *)&outPoints[i], _mm_blendv_pd(f, c, useCeil));
+    }
+#endif
+
+    for ( ; i < count; i++) {
+        CGPoint p = inPoints[i];
+        outPoints[i].x = ceilX ? (SwiffScaleCeil(p.x, scale) - offset) : (SwiffScaleFloor(p.x, scale) + offset);
+        outPoints[i].y = ceilY ? (SwiffScaleCeil(p.y, scale) - offset) : (SwiffScaleFloor(p.y, scale) + offset);
+    }
 }
 
 
+#pragma mark -
+#pragma mark Path Tracing
+
 static void sTracePathStrokeAdvanced(
     SwiffRenderState *state,
     SwiffPathOperation *operations,
-    CGFloat *floats,
-    CGFloat width,
-    CGAffineTransform pointTransform,
+    const float *xs,
+    const float *ys,
+    const CGPoint *points,         // xs and ys with the point transform applied
+    const CGPoint *snappedPoints,  // points passed through sSnapStrokePoints(), or NULL
     BOOL isHairline,
-    BOOL shouldRound,
     BOOL shouldClose
 ) {
     CGContextRef context = state->context;
 
-    CGFloat scale  = state->scaleFactorHint;
-    CGFloat offset = (lround(width * state->scaleFactorHint) % 2) ? ((1.0 / state->scaleFactorHint) / 2) : 0;
-
-    CGFloat x = NAN, y = NAN, controlX = NAN, controlY = NAN, moveX = NAN, moveY = NAN;
+    CGFloat x = NAN, y = NAN, moveX = NAN, moveY = NAN;
+    CGPoint current = CGPointMake(NAN, NAN);
+    NSUInteger i = 0;
 
     SwiffPathOperation prevOp = SwiffPathOperationMove;
     SwiffPathOperation op     = SwiffPathOperationMove;
@@ -142,16 +414,12 @@ nextOperation:
             CGContextClosePath(context);
         }
 
-        moveX = x = *floats++;
-        moveY = y = *floats++;
+        moveX = x = xs[i];
+        moveY = y = ys[i];
         
         {
-            CGPoint to = CGPointApplyAffineTransform(CGPointMake(x, y), pointTransform);
-
-            if (isHairline || shouldRound) {
-                to.x = (state->ceilX) ? (SwiffScaleCeil(to.x, scale) - offset) : (SwiffScaleFloor(to.x, scale) + offset);
-                to.y = (state->ceilY) ? (SwiffScaleCeil(to.y, scale) - offset) : (SwiffScaleFloor(to.y, scale) + offset);
-            }
+            CGPoint to = snappedPoints ? snappedPoints[i] : points[i];
+            current = points[i++];
 
             CGContextMoveToPoint(context, to.x, to.y);
         }
@@ -161,22 +429,23 @@ nextOperation:
         goto nextOperation;
 
     case SwiffPathOperationCurve:
-        x        = *floats++;  y        = *floats++;
-        controlX = *floats++;  controlY = *floats++;
-        
         {
-            CGPoint to      = CGPointApplyAffineTransform(CGPointMake(x,        y),        pointTransform);
-            CGPoint control = CGPointApplyAffineTransform(CGPointMake(controlX, controlY), pointTransform);
+            CGPoint control = points[i++];
+            CGPoint to      = current = points[i];
+
+            x = xs[i];  y = ys[i];  i++;
+
             CGContextAddQuadCurveToPoint(context, control.x, control.y, to.x, to.y);
         }
 
         goto nextOperation;
 
     case SwiffPathOperationLine:
-        x = *floats++;  y = *floats++;
-        
         {
-            CGPoint to = CGPointApplyAffineTransform(CGPointMake(x, y), pointTransform);
+            CGPoint to = current = points[i];
+
+            x = xs[i];  y = ys[i];  i++;
+
             CGContextAddLineToPoint(context, to.x, to.y);
         }
 
@@ -186,12 +455,11 @@ nextOperation:
     case SwiffPathOperationVerticalLine:
         {
             CGFloat oldX = x, oldY = y;
-            if (op == SwiffPathOperationHorizontalLine) {
-                x = *floats++;;
-            } else {
-                y = *floats++;;
-            }
-            CGPoint to = CGPointApplyAffineTransform(CGPointMake(x, y), pointTransform);
+            CGPoint from    = current;
+            CGPoint to      = current = points[i];
+            CGPoint snapped = snappedPoints ? snappedPoints[i] : to;
+
+            x = xs[i];  y = ys[i];  i++;
 
             // Special hairline case, each horizontal or vertical line is a move followed by a lineTo
             // This corrects fuzzy line caps
@@ -201,38 +469,18 @@ nextOperation:
             if (isHairline && previousWasMove && nextIsMove) {
                 moveX = oldX;
                 moveY = oldY;
-                CGPoint from = CGPointApplyAffineTransform(CGPointMake(oldX, oldY), pointTransform);
 
                 if (op == SwiffPathOperationVerticalLine) {
-                    CGFloat roundedX;
-                    if (state->ceilX) {
-                        roundedX = SwiffScaleCeil (to.x, scale) - offset;
-                    } else {
-                        roundedX = SwiffScaleFloor(to.x, scale) + offset;
-                    }
-
-                    CGContextMoveToPoint(context, roundedX, from.y);
-                    CGContextAddLineToPoint(context, roundedX, to.y);
+                    CGContextMoveToPoint(context, snapped.x, from.y);
+                    CGContextAddLineToPoint(context, snapped.x, to.y);
 
                 } else {
-                    CGFloat roundedY;
-                    if (state->ceilY) {
-                        roundedY = SwiffScaleCeil (to.y, scale) - offset;
-                    } else {
-                        roundedY = SwiffScaleFloor(to.y, scale) + offset;
-                    }
-
-                    CGContextMoveToPoint(context, from.x, roundedY);
-                    CGContextAddLineToPoint(context, to.x, roundedY);
+                    CGContextMoveToPoint(context, from.x, snapped.y);
+                    CGContextAddLineToPoint(context, to.x, snapped.y);
                 }
                     
             } else {
-                if (isHairline || shouldRound) {
-                    to.x = (state->ceilX) ? (SwiffScaleCeil(to.x, scale) - offset) : (SwiffScaleFloor(to.x, scale) + offset);
-                    to.y = (state->ceilY) ? (SwiffScaleCeil(to.y, scale) - offset) : (SwiffScaleFloor(to.y, scale) + offset);
-                }
-
-                CGContextAddLineToPoint(context, to.x, to.y);
+                CGContextAddLineToPoint(context, snapped.x, snapped.y);
             }
 
             goto nextOperation;
@@ -248,10 +496,10 @@ nextOperation:
 }
 
 
-static void sTracePathStrokeSimple(SwiffRenderState *state, SwiffPathOperation *operations, CGFloat *floats, BOOL shouldClose)
+static void sTracePathStrokeSimple(SwiffRenderState *state, SwiffPathOperation *operations, const float *xs, const float *ys, BOOL shouldClose)
 {
     CGContextRef context = state->context;
-    CGFloat toX = NAN, toY = NAN, controlX = NAN, controlY = NAN, moveX = NAN, moveY = NAN;
+    CGFloat toX = NAN, toY = NAN, moveX = NAN, moveY = NAN;
 
 nextOperation:
     switch (*operations++) {
@@ -260,8 +508,8 @@ nextOperation:
             CGContextClosePath(context);
         }
 
-        moveX = toX = *floats++;
-        moveY = toY = *floats++;
+        moveX = toX = *xs++;
+        moveY = toY = *ys++;
         CGContextMoveToPoint(context, toX, toY);
 
         if (!shouldClose) moveX = NAN;
@@ -269,26 +517,18 @@ nextOperation:
         goto nextOperation;
 
     case SwiffPathOperationCurve:
-        toX      = *floats++;  toY      = *floats++;
-        controlX = *floats++;  controlY = *floats++;
-        CGContextAddQuadCurveToPoint(context, controlX, controlY, toX, toY);
+        {
+            CGFloat controlX = *xs++, controlY = *ys++;
+            toX = *xs++;  toY = *ys++;
+            CGContextAddQuadCurveToPoint(context, controlX, controlY, toX, toY);
+        }
 
         goto nextOperation;
 
     case SwiffPathOperationLine:
-        toX = *floats++;  toY = *floats++;
-        CGContextAddLineToPoint(context, toX, toY);
-
-        goto nextOperation;
-
     case SwiffPathOperationHorizontalLine:
-        toX = *floats++;
-        CGContextAddLineToPoint(context, toX, toY);
-
-        goto nextOperation;
-
     case SwiffPathOperationVerticalLine:
-        toY = *floats++;
+        toX = *xs++;  toY = *ys++;
         CGContextAddLineToPoint(context, toX, toY);
 
         goto nextOperation;
@@ -303,33 +543,17 @@ nextOperation:
 }
 
 
-// This works around <rdar://10646847> and also immitates what the Flash engine does
-static CGPoint sTracePathFill_ApplyTransform(CGFloat x, CGFloat y, CGAffineTransform *transform)
-{
-    CGPoint point = CGPointApplyAffineTransform(CGPointMake(x, y), *transform);
-    CGFloat iX, iY, fX, fY;
-
-#if CGFLOAT_IS_DOUBLE
-    fX= modf(point.x, &iX);
-    fY= modf(point.y, &iY);
-
-    if (fX < 0.15 || fX > 0.85) point.x = round(point.x);
-    if (fY < 0.15 || fY > 0.85) point.y = round(point.y);
-#else
-    fX= modff(point.x, &iX);
-    fY= modff(point.y, &iY);
-
-    if (fX < 0.15 || fX > 0.85) point.x = roundf(point.x);
-    if (fY < 0.15 || fY > 0.85) point.y = roundf(point.y);
-#endif
-
-    return point;
-}
-
-static void sTracePathFill(SwiffRenderState *state, SwiffPathOperation *operations, CGFloat *floats, CGAffineTransform pointTransform)
-{
+static void sTracePathFill(
+    SwiffRenderState *state,
+    SwiffPathOperation *operations,
+    const float *xs,
+    const float *ys,
+    const CGPoint *points,        // xs and ys with the point transform applied
+    const CGPoint *snappedPoints  // points passed through sSnapFillPoints()
+) {
     CGContextRef context = state->context;
     CGFloat toX = NAN, toY = NAN, moveX = NAN, moveY = NAN;
+    NSUInteger i = 0;
 
     CGPoint p, c;
 
@@ -340,44 +564,28 @@ nextOperation:
             CGContextClosePath(context);
         }
 
-        moveX = toX = *floats++;
-        moveY = toY = *floats++;
+        moveX = toX = xs[i];
+        moveY = toY = ys[i];
         
-        p = sTracePathFill_ApplyTransform(toX, toY, &pointTransform);
+        p = snappedPoints[i++];
         CGContextMoveToPoint(context, p.x, p.y);
 
         goto nextOperation;
 
     case SwiffPathOperationCurve:
-        toX = *floats++;  toY = *floats++;
-        c.x = *floats++;  c.y = *floats++;
+        c = points[i++];
 
-        c = CGPointApplyAffineTransform(c, pointTransform);
-        p = sTracePathFill_ApplyTransform(toX, toY, &pointTransform);
+        toX = xs[i];  toY = ys[i];
+        p = snappedPoints[i++];
         CGContextAddQuadCurveToPoint(context, c.x, c.y, p.x, p.y);
 
         goto nextOperation;
 
     case SwiffPathOperationLine:
-        toX = *floats++;  toY = *floats++;
-
-        p = sTracePathFill_ApplyTransform(toX, toY, &pointTransform);
-        CGContextAddLineToPoint(context, p.x, p.y);
-
-        goto nextOperation;
-
     case SwiffPathOperationHorizontalLine:
-        toX = *floats++;
-
-        p = sTracePathFill_ApplyTransform(toX, toY, &pointTransform);
-        CGContextAddLineToPoint(context, p.x, p.y);
-
-        goto nextOperation;
-
     case SwiffPathOperationVerticalLine:
-        toY = *floats++;
-
-        p = sTracePathFill_ApplyTransform(toX, toY, &pointTransform);
+        toX = xs[i];  toY = ys[i];
+        p = snappedPoints[i++];
         CGContextAddLineToPoint(context, p.x, p.y);
 
         goto nextOperation;
@@ -392,124 +600,1004 @@ nextOperation:
 }
 
 
-static void sStrokePath(SwiffRenderState *state, SwiffPath *path)
+#pragma mark -
+#pragma mark Rasterizer Backend
+
+static void sColorToRGBA8(SwiffColor color, UInt8 *outRGBA)
 {
-    SwiffPathOperation *operations = [path operations];
-    CGFloat *floats = [path floats];
-    if (!operations || !floats) return;
+    CGFloat alpha = MAX(0, MIN(color.alpha, 1));
 
-    SwiffLineStyle *lineStyle = [path lineStyle];
-    CGFloat lineWidth = [lineStyle width];
+    outRGBA[0] = (UInt8)lround(MAX(0, MIN(color.red,   1)) * alpha * 255);
+    outRGBA[1] = (UInt8)lround(MAX(0, MIN(color.green, 1)) * alpha * 255);
+    outRGBA[2] = (UInt8)lround(MAX(0, MIN(color.blue,  1)) * alpha * 255);
+    outRGBA[3] = (UInt8)lround(alpha * 255);
+}
 
-    // Prevent blurry lines when a/d are 1/-1 
-    BOOL isHairline  = (lineWidth == SwiffLineStyleHairlineWidth);
-    BOOL shouldRound = NO;
-    BOOL noScale     = NO;
 
-    if ((lround(lineWidth) % 2) == 1 &&
-        ((state->affineTransform.a == 1.0) || (state->affineTransform.a == -1.0)) &&
-        ((state->affineTransform.d == 1.0) || (state->affineTransform.d == -1.0)))
-    {
-        shouldRound = YES;
-    }
+static void sMakeColorPaint(SwiffColor color, SwiffRasterizerPaint *outPaint)
+{
+    memset(outPaint, 0, sizeof(SwiffRasterizerPaint));
+    outPaint->type = SwiffRasterizerPaintTypeColor;
+    sColorToRGBA8(color, outPaint->color);
+}
 
-    if (![lineStyle scalesHorizontally] && ![lineStyle scalesVertically]) {
-        noScale = YES;
+
+typedef struct {
+    size_t width;
+    size_t height;
+} SwiffRenderBitmapHeader;  // Followed by width * height premultiplied RGBA8 pixels
+
+
+// Returns the premultiplied RGBA8 pixels of a bitmap definition, decoded once per render.
+// Once every bitmap is in state->bitmapPixels, this no longer touches the movie, see sPrepareBitmapPixels()
+static const UInt8 *sGetBitmapPixels(SwiffRenderState *state, UInt16 libraryID, size_t *outWidth, size_t *outHeight)
+{
+    if (!state->bitmapPixels) {
+        state->bitmapPixels = CFDictionaryCreateMutable(NULL, 0, NULL, &kCFTypeDictionaryValueCallBacks);
     }
 
-    CGContextRef context = state->context;
-    CGContextSaveGState(context);
+    const void *key  = (const void *)(NSInteger)libraryID;
+    CFTypeRef   data = CFDictionaryGetValue(state->bitmapPixels, key);
 
-    if (isHairline || shouldRound || noScale) {
-        if (isHairline) {
-            lineWidth = state->hairlineWidth;
+    if (!data) {
+        CGImageRef image = [[state->movie bitmapDefinitionWithLibraryID:libraryID] CGImage];
 
-            if ((state->fillHairlineWidth != 0) && [path usesFillHairlineWidth]) {
-                lineWidth = state->fillHairlineWidth;
-            }
-        }
-        
-        sTracePathStrokeAdvanced(state, operations, floats, lineWidth, state->affineTransform, isHairline, shouldRound, [lineStyle closesStroke]);
+        if (image) {
+            SwiffRenderBitmapHeader header = { CGImageGetWidth(image), CGImageGetHeight(image) };
 
-    } else {
-        CGContextConcatCTM(context, state->affineTransform);
-        sTracePathStrokeSimple(state, operations, floats, [lineStyle closesStroke]);
-    }
+            CFMutableDataRef pixels = CFDataCreateMutable(NULL, 0);
+            CFDataSetLength(pixels, sizeof(SwiffRenderBitmapHeader) + (header.width * header.height * 4));
+            memcpy(CFDataGetMutableBytePtr(pixels), &header, sizeof(SwiffRenderBitmapHeader));
 
-    CGContextSetLineWidth(context, lineWidth);
+            CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+            CGContextRef    context    = CGBitmapContextCreate(CFDataGetMutableBytePtr(pixels) + sizeof(SwiffRenderBitmapHeader), header.width, header.height, 8, header.width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
 
-    if (isHairline) {
-        CGContextSetLineCap(context,  kCGLineCapButt);
-        CGContextSetLineJoin(context, kCGLineJoinMiter);
+            if (context) {
+                CGContextDrawImage(context, CGRectMake(0, 0, header.width, header.height), image);
+                CGContextRelease(context);
+            }
 
-    } else {
-        CGLineJoin lineJoin = [lineStyle lineJoin];
-        
-        //!issue10: Use endLineCap at some point
-        CGLineCap lineCap = [lineStyle startLineCap];
+            CGColorSpaceRelease(colorSpace);
 
-        CGContextSetLineCap(context, lineCap);
-        CGContextSetLineJoin(context, lineJoin);
+            data = pixels;
 
-        if (lineJoin == kCGLineJoinMiter) {
-            //!issue9: Better miter limits
-            //    When the miter limit is hit, Quartz and Flash render it differently -
-            //    Quartz converts it to a bezel that extends to 1/2 the line width
-            //    Flash converts it to a bezel that extends to: MiterLimitFactor * LineWidth
-            //  
-            CGContextSetMiterLimit(context, [lineStyle miterLimit]);
+        } else {
+            data = CFRetain(kCFNull);
         }
-    }
 
-    SwiffColor color = SwiffColorApplyColorTransformStack([lineStyle color], state->colorTransforms);
-    if (state->colorModificationBlock) {
-        state->colorModificationBlock(&color);
+        CFDictionarySetValue(state->bitmapPixels, key, data);
+        CFRelease(data);
     }
 
-    CGContextSetStrokeColor(context, (CGFloat *)&color);
-    CGContextDrawPath(context, kCGPathStroke);
+    if (data == kCFNull) return NULL;
 
-    CGContextRestoreGState(context);
+    const UInt8 *bytes = CFDataGetBytePtr(data);
+    const SwiffRenderBitmapHeader *header = (const SwiffRenderBitmapHeader *)bytes;
+
+    *outWidth  = header->width;
+    *outHeight = header->height;
+
+    return bytes + sizeof(SwiffRenderBitmapHeader);
 }
 
 
-static void sFillPath(SwiffRenderState *state, SwiffPath *path)
+// Adds the transformed points of a SwiffPath to the rasterizer's current path
+static void sAddPathToRasterizer(SwiffRasterizer *rasterizer, SwiffPathOperation *operations, const CGPoint *points, BOOL shouldClose)
 {
-    SwiffPathOperation *operations = [path operations];
-    CGFloat *floats = [path floats];
+    NSUInteger i = 0;
+    CGPoint move = CGPointZero, to = CGPointZero;
+    BOOL hasMove = NO;
 
-    if (!operations || !floats) return;
+nextOperation:
+    switch (*operations++) {
+    case SwiffPathOperationMove:
+        if (shouldClose && hasMove && CGPointEqualToPoint(to, move)) {
+            SwiffRasterizerClosePath(rasterizer);
+        }
 
-    SwiffFillStyle    *style = [path fillStyle];
-    SwiffFillStyleType type  = [style type];
+        move = to = points[i++];
+        hasMove = YES;
+        SwiffRasterizerMoveToPoint(rasterizer, to);
 
-    CGContextRef context = state->context;
+        goto nextOperation;
 
-    CGContextSaveGState(context);
-    sTracePathFill(state, operations, floats, state->affineTransform);
+    case SwiffPathOperationCurve:
+        {
+            CGPoint control = points[i++];
+            to = points[i++];
+            SwiffRasterizerAddQuadCurveToPoint(rasterizer, control, to);
+        }
 
-    CGContextConcatCTM(context, state->affineTransform);
+        goto nextOperation;
 
-    if (state->isBuildingClippingPath) {
-        // Do nothing if we are building the clip path
+    case SwiffPathOperationLine:
+    case SwiffPathOperationHorizontalLine:
+    case SwiffPathOperationVerticalLine:
+        to = points[i++];
+        SwiffRasterizerAddLineToPoint(rasterizer, to);
+
+        goto nextOperation;
+
+    case SwiffPathOperationEnd:
+        break;
+    }
+
+    if (shouldClose && hasMove && CGPointEqualToPoint(to, move)) {
+        SwiffRasterizerClosePath(rasterizer);
+    }
+}
+
+
+static void sRasterizeStrokePath(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    SwiffPath *path = (__bridge SwiffPath *)command->object;
+
+    SwiffPathOperation *operations = [path operations];
+    if (!operations || ![path pointsCount]) return;
+
+    SwiffLineStyle *lineStyle = [path lineStyle];
+    CGFloat lineWidth  = [lineStyle width];
+    BOOL    isHairline = (lineWidth == SwiffLineStyleHairlineWidth);
+
+    CGAffineTransform t = state->affineTransform;
+
+    if (isHairline) {
+        lineWidth = state->hairlineWidth;
+
+        if ((state->fillHairlineWidth != 0) && [path usesFillHairlineWidth]) {
+            lineWidth = state->fillHairlineWidth;
+        }
+
+    } else if ([lineStyle scalesHorizontally] || [lineStyle scalesVertically]) {
+        lineWidth *= sqrt(fabs((t.a * t.d) - (t.b * t.c)));
+    }
+
+    NSUInteger count = [path pointsCount];
+    sReservePoints(state, count);
+    SwiffPathTransformPoints(path, t, state->points);
+
+    SwiffRasterizerBeginPath(state->rasterizer);
+    sAddPathToRasterizer(state->rasterizer, operations, state->points, [lineStyle closesStroke]);
+
+    SwiffRasterizerPaint paint;
+    sMakeColorPaint(command->color, &paint);
+
+    SwiffRasterizerStrokePath(state->rasterizer, lineWidth, isHairline, &paint);
+}
+
+
+static void sRasterizeFillPath(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    SwiffPath *path = (__bridge SwiffPath *)command->object;
+
+    SwiffPathOperation *operations = [path operations];
+    if (!operations || ![path pointsCount]) return;
+
+    SwiffRasterizer   *rasterizer = state->rasterizer;
+    SwiffFillStyle    *style = [path fillStyle];
+    SwiffFillStyleType type  = [style type];
+
+    NSUInteger count = [path pointsCount];
+    sReservePoints(state, count);
+    SwiffPathTransformPoints(path, state->affineTransform, state->points);
+
+    SwiffRasterizerBeginPath(rasterizer);
+    sAddPathToRasterizer(rasterizer, operations, state->points, NO);
+
+    if (state->isBuildingClippingPath) {
+        SwiffRasterizerAddPathToClipMask(rasterizer, SwiffRasterizerFillRuleNonZero);
+        return;
+    }
+
+    SwiffRasterizerPaint paint;
+    memset(&paint, 0, sizeof(SwiffRasterizerPaint));
+
+    if (type == SwiffFillStyleTypeColor) {
+        sMakeColorPaint(command->color, &paint);
+        SwiffRasterizerFillPath(rasterizer, SwiffRasterizerFillRuleNonZero, &paint);
+
+    } else if ((type == SwiffFillStyleTypeLinearGradient) || (type == SwiffFillStyleTypeRadialGradient)) {
+        if (command->gradientTable) {
+            paint.type = (type == SwiffFillStyleTypeLinearGradient) ? SwiffRasterizerPaintTypeLinearGradient : SwiffRasterizerPaintTypeRadialGradient;
+            paint.inverseTransform = CGAffineTransformInvert(CGAffineTransformConcat([style gradientTransform], state->affineTransform));
+            paint.gradientTable = command->gradientTable;
+            paint.spreadMode = (SwiffRasterizerSpreadMode)[[style gradient] spreadMode];
+
+            // Matches the CGContextEOClip() used by sExecuteFillPath()
+            SwiffRasterizerFillPath(rasterizer, SwiffRasterizerFillRuleEvenOdd, &paint);
+        }
+
+    } else if ((type >= SwiffFillStyleTypeRepeatingBitmap) && (type <= SwiffFillStyleTypeNonSmoothedClippedBitmap)) {
+        size_t width = 0, height = 0;
+        const UInt8 *pixels = sGetBitmapPixels(state, [style bitmapID], &width, &height);
+
+        if (pixels) {
+            paint.type = SwiffRasterizerPaintTypeBitmap;
+            paint.inverseTransform  = CGAffineTransformInvert(CGAffineTransformConcat([style bitmapTransform], state->affineTransform));
+            paint.bitmapPixels      = pixels;
+            paint.bitmapWidth       = width;
+            paint.bitmapHeight      = height;
+            paint.bitmapBytesPerRow = width * 4;
+            paint.bitmapAlpha       = (UInt8)lround(MAX(0, MIN(command->color.alpha, 1)) * 255);
+            paint.bitmapRepeats     = (type == SwiffFillStyleTypeRepeatingBitmap) || (type == SwiffFillStyleTypeNonSmoothedRepeatingBitmap);
+            paint.bitmapSmooths     = (type == SwiffFillStyleTypeRepeatingBitmap) || (type == SwiffFillStyleTypeClippedBitmap);
+
+            SwiffRasterizerFillPath(rasterizer, SwiffRasterizerFillRuleNonZero, &paint);
+        }
+    }
+
+    SwiffRasterizerBeginPath(rasterizer);
+}
+
+
+typedef struct {
+    SwiffRasterizer  *rasterizer;
+    CGAffineTransform transform;
+} SwiffRasterizerGlyphContext;
+
+
+static void sAddGlyphPathElement(void *info, const CGPathElement *element)
+{
+    SwiffRasterizerGlyphContext *context = info;
+    SwiffRasterizer *rasterizer = context->rasterizer;
+    CGAffineTransform t = context->transform;
+
+    switch (element->type) {
+    case kCGPathElementMoveToPoint:
+        SwiffRasterizerMoveToPoint(rasterizer, CGPointApplyAffineTransform(element->points[0], t));
+        break;
+
+    case kCGPathElementAddLineToPoint:
+        SwiffRasterizerAddLineToPoint(rasterizer, CGPointApplyAffineTransform(element->points[0], t));
+        break;
+
+    case kCGPathElementAddQuadCurveToPoint:
+        SwiffRasterizerAddQuadCurveToPoint(rasterizer, CGPointApplyAffineTransform(element->points[0], t), CGPointApplyAffineTransform(element->points[1], t));
+        break;
+
+    case kCGPathElementAddCurveToPoint:
+        // Font glyphs only contain quadratic curves
+        SwiffRasterizerAddLineToPoint(rasterizer, CGPointApplyAffineTransform(element->points[2], t));
+        break;
+
+    case kCGPathElementCloseSubpath:
+        SwiffRasterizerClosePath(rasterizer);
+        break;
+    }
+}
+
+
+// Rasterizer version of sExecuteFillText()
+static void sRasterizeFillText(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    SwiffRasterizer *rasterizer = state->rasterizer;
+    SwiffRasterizerGlyphContext context = { rasterizer, state->affineTransform };
+
+    SwiffRasterizerBeginPath(rasterizer);
+    CGPathApply((CGPathRef)command->object, &context, sAddGlyphPathElement);
+
+    if (state->isBuildingClippingPath) {
+        SwiffRasterizerAddPathToClipMask(rasterizer, SwiffRasterizerFillRuleNonZero);
+    } else {
+        SwiffRasterizerPaint paint;
+        sMakeColorPaint(command->color, &paint);
+        SwiffRasterizerFillPath(rasterizer, SwiffRasterizerFillRuleNonZero, &paint);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Layers
+
+static void sSetupContext(SwiffRenderState *state, CGContextRef context)
+{
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+
+    CGContextSetInterpolationQuality(context, kCGInterpolationDefault);
+
+    CGContextSetShouldAntialias(context, state->shouldAntialias);
+    CGContextSetShouldSmoothFonts(context, state->shouldSmoothFonts);
+    CGContextSetShouldSubpixelPositionFonts(context, state->shouldSubpixelPositionFonts);
+    CGContextSetShouldSubpixelQuantizeFonts(context, state->shouldSubpixelQuantizeFonts);
+
+    CGContextSetLineCap(context, kCGLineCapRound);
+    CGContextSetLineJoin(context, kCGLineJoinRound);
+    CGContextSetFillColorSpace(context, colorSpace);
+    CGContextSetStrokeColorSpace(context, colorSpace);
+
+    CGColorSpaceRelease(colorSpace);
+}
+
+
+static void sReleaseLayerPixels(void *info, const void *data, size_t size)
+{
+    free((void *)data);
+}
+
+
+// Gives the layer its own copy of borrowed pixels, so that they can be changed
+static void sTakeLayerPixels(SwiffRenderLayer *layer)
+{
+    if (!layer->hasBorrowedPixels) return;
+
+    size_t length = layer->rect.size.width * layer->rect.size.height * 4;
+    UInt8 *pixels = malloc(length);
+    memcpy(pixels, layer->pixels, length);
+
+    CGImageRelease(layer->image);
+    layer->image = NULL;
+
+    layer->pixels = pixels;
+    layer->hasBorrowedPixels = NO;
+}
+
+
+static void sFreeLayerPixels(SwiffRenderLayer *layer)
+{
+    if (!layer->hasBorrowedPixels) {
+        free(layer->pixels);
+    }
+
+    CGImageRelease(layer->image);
+
+    layer->image  = NULL;
+    layer->pixels = NULL;
+    layer->hasBorrowedPixels = NO;
+}
+
+
+// Images of cached pixels read them in place, from the NSData held by the bitmap cache
+static CGImageRef sCreateImageWithPixels(NSData *pixels, size_t width, size_t height)
+{
+    CGColorSpaceRef   colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGDataProviderRef provider   = CGDataProviderCreateWithCFData((__bridge CFDataRef)pixels);
+    CGImageRef        image      = CGImageCreate(width, height, 8, 32, width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big, provider, NULL, false, kCGRenderingIntentDefault);
+
+    CGDataProviderRelease(provider);
+    CGColorSpaceRelease(colorSpace);
+
+    return image;
+}
+
+
+static CGImageRef sCreateImageWithCoverage(NSData *coverage, size_t width, size_t height)
+{
+    CGColorSpaceRef   colorSpace = CGColorSpaceCreateDeviceGray();
+    CGDataProviderRef provider   = CGDataProviderCreateWithCFData((__bridge CFDataRef)coverage);
+    CGImageRef        image      = CGImageCreate(width, height, 8, 8, width, colorSpace, kCGImageAlphaNone, provider, NULL, false, kCGRenderingIntentDefault);
+
+    CGDataProviderRelease(provider);
+    CGColorSpaceRelease(colorSpace);
+
+    return image;
+}
+
+
+// Copies the pixels of a bitmap context under rect, in device space, into RGBA8 outPixels, row 0 at the top.
+// Pixels outside of the context are transparent.  Returns NO unless the context is 8-bit RGB with alpha
+// (or nothing) in its last byte, which covers the layers and the usual CALayer and UIImage contexts
+static BOOL sReadBitmapContextPixels(CGContextRef context, CGRect rect, UInt8 *outPixels)
+{
+    UInt8 *data = CGBitmapContextGetData(context);
+    if (!data) return NO;
+
+    CGColorSpaceRef colorSpace = CGBitmapContextGetColorSpace(context);
+    if (!colorSpace || (CGColorSpaceGetModel(colorSpace) != kCGColorSpaceModelRGB)) return NO;
+    if ((CGBitmapContextGetBitsPerComponent(context) != 8) || (CGBitmapContextGetBitsPerPixel(context) != 32)) return NO;
+
+    CGImageAlphaInfo alphaInfo = CGBitmapContextGetAlphaInfo(context);
+    CGBitmapInfo     byteOrder = CGBitmapContextGetBitmapInfo(context) & kCGBitmapByteOrderMask;
+    BOOL isBigEndian = (byteOrder == kCGBitmapByteOrderDefault) || (byteOrder == kCGBitmapByteOrder32Big);
+    BOOL isBGRA, isOpaque;
+
+    if (isBigEndian && ((alphaInfo == kCGImageAlphaPremultipliedLast) || (alphaInfo == kCGImageAlphaNoneSkipLast))) {
+        isBGRA   = NO;
+        isOpaque = (alphaInfo == kCGImageAlphaNoneSkipLast);
+
+    } else if ((byteOrder == kCGBitmapByteOrder32Little) && ((alphaInfo == kCGImageAlphaPremultipliedFirst) || (alphaInfo == kCGImageAlphaNoneSkipFirst))) {
+        isBGRA   = YES;
+        isOpaque = (alphaInfo == kCGImageAlphaNoneSkipFirst);
+
+    } else {
+        return NO;
+    }
+
+    NSInteger contextWidth  = CGBitmapContextGetWidth(context);
+    NSInteger contextHeight = CGBitmapContextGetHeight(context);
+    size_t    bytesPerRow   = CGBitmapContextGetBytesPerRow(context);
+
+    // Device space is flipped relative to the rows of the bitmap
+    NSInteger left   = (NSInteger)CGRectGetMinX(rect);
+    NSInteger top    = contextHeight - (NSInteger)CGRectGetMaxY(rect);
+    size_t    width  = rect.size.width;
+    size_t    height = rect.size.height;
+
+    NSInteger startX = MAX(0, -left);
+    NSInteger endX   = MIN((NSInteger)width, contextWidth - left);
+
+    memset(outPixels, 0, width * height * 4);
+
+    for (size_t y = 0; y < height; y++) {
+        NSInteger contextY = top + (NSInteger)y;
+        if ((contextY < 0) || (contextY >= contextHeight)) continue;
+
+        const UInt8 *in  = data + (contextY * bytesPerRow) + ((left + startX) * 4);
+        UInt8       *out = outPixels + (y * width * 4) + (startX * 4);
+
+        for (NSInteger x = startX; x < endX; x++, in += 4, out += 4) {
+            out[0] = in[isBGRA ? 2 : 0];
+            out[1] = in[1];
+            out[2] = in[isBGRA ? 0 : 2];
+            out[3] = isOpaque ? 255 : in[3];
+        }
+    }
+
+    return YES;
+}
+
+
+// Draws the pixels of a layer into the current context or rasterizer, then frees them unless they are borrowed
+static void sDrawLayer(SwiffRenderState *state, SwiffRenderLayer *layer)
+{
+    size_t width  = layer->rect.size.width;
+    size_t height = layer->rect.size.height;
+
+    if (state->context) {
+        CGContextRef context   = state->context;
+        CGBlendMode  blendMode = kCGBlendModeNormal;
+
+        // Subtract and Invert have no CGBlendMode.  When the parent is a readable bitmap, the layer is blended onto
+        // a copy of the pixels under it, which is copied back.  Otherwise, Invert is drawn as the difference
+        // with white, which matches over opaque pixels, and Subtract is drawn as normal
+        if (!SwiffBlendModeGetCGBlendMode(layer->blendMode, &blendMode)) {
+            sTakeLayerPixels(layer);
+
+            UInt8 *backdrop = malloc(width * height * 4);
+
+            if (sReadBitmapContextPixels(context, layer->rect, backdrop)) {
+                SwiffBlendModeCompositeSpan(layer->blendMode, backdrop, layer->pixels, NULL, width * height);
+
+                free(layer->pixels);
+                layer->pixels = backdrop;
+                blendMode = kCGBlendModeCopy;
+
+            } else {
+                free(backdrop);
+
+                if (layer->blendMode == SwiffBlendModeInvert) {
+                    for (size_t i = 0; i < (width * height); i++) {
+                        UInt8 *pixel = &layer->pixels[i * 4];
+                        pixel[0] = pixel[1] = pixel[2] = pixel[3];
+                    }
+
+                    blendMode = kCGBlendModeDifference;
+                }
+            }
+        }
+
+        CGImageRef image = layer->image;
+        layer->image = NULL;
+
+        // Without an image made in advance, the new image takes ownership of the pixels
+        if (!image) {
+            sTakeLayerPixels(layer);
+
+            CGColorSpaceRef   colorSpace = CGColorSpaceCreateDeviceRGB();
+            CGDataProviderRef provider   = CGDataProviderCreateWithData(NULL, layer->pixels, width * height * 4, sReleaseLayerPixels);
+
+            image = CGImageCreate(width, height, 8, 32, width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big, provider, NULL, false, kCGRenderingIntentDefault);
+
+            CGDataProviderRelease(provider);
+            CGColorSpaceRelease(colorSpace);
+
+            layer->pixels = NULL;
+        }
+
+        CGContextSaveGState(context);
+        CGContextConcatCTM(context, CGAffineTransformInvert(CGContextGetCTM(context)));
+        CGContextSetBlendMode(context, blendMode);
+        CGContextDrawImage(context, layer->rect, image);
+        CGContextRestoreGState(context);
+
+        CGImageRelease(image);
+
+    } else {
+        SwiffRasterizer *rasterizer = state->rasterizer;
+        CGRect rect = layer->rect;
+
+        SwiffRasterizerPaint paint;
+        memset(&paint, 0, sizeof(SwiffRasterizerPaint));
+
+        paint.type              = SwiffRasterizerPaintTypeBitmap;
+        paint.inverseTransform  = CGAffineTransformMakeTranslation(-rect.origin.x, -rect.origin.y);
+        paint.bitmapPixels      = layer->pixels;
+        paint.bitmapWidth       = width;
+        paint.bitmapHeight      = height;
+        paint.bitmapBytesPerRow = width * 4;
+        paint.bitmapAlpha       = 255;
+        paint.blendMode         = layer->blendMode;
+
+        SwiffRasterizerBeginPath(rasterizer);
+        SwiffRasterizerMoveToPoint(rasterizer,    CGPointMake(CGRectGetMinX(rect), CGRectGetMinY(rect)));
+        SwiffRasterizerAddLineToPoint(rasterizer, CGPointMake(CGRectGetMaxX(rect), CGRectGetMinY(rect)));
+        SwiffRasterizerAddLineToPoint(rasterizer, CGPointMake(CGRectGetMaxX(rect), CGRectGetMaxY(rect)));
+        SwiffRasterizerAddLineToPoint(rasterizer, CGPointMake(CGRectGetMinX(rect), CGRectGetMaxY(rect)));
+        SwiffRasterizerClosePath(rasterizer);
+        SwiffRasterizerFillPath(rasterizer, SwiffRasterizerFillRuleNonZero, &paint);
+    }
+
+    sFreeLayerPixels(layer);
+}
+
+
+// Redirects drawing into a new offscreen layer, covering the bounds of the placed object plus the outset
+// of its filters.  The layer is limited to the clip bounds, also plus the outset, as a blur may pull
+// pixels from outside of them.
+//
+// When the command has a cacheKey, the layer may instead be drawn from the bitmap cache, in which case its
+// commands are skipped.  Otherwise, it covers all of the placed object, so that its pixels can be cached.
+// Layers which only exist for the bitmap cache, and are not cached after all, draw directly into the parent
+static void sBeginLayer(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    NSArray              *filters   = (__bridge NSArray *)command->object;
+    SwiffBlendMode        blendMode = command->layerBlendMode;
+    SwiffRenderBitmapKey *cacheKey  = state->bitmapCache ? (__bridge SwiffRenderBitmapKey *)command->cacheKey : nil;
+
+    CGAffineTransform toDevice = state->affineTransform;
+    CGAffineTransform ctm      = CGAffineTransformIdentity;
+    CGRect            clipRect = CGRectOffset(state->clipBoundingBox, -state->rasterizerOrigin.x, -state->rasterizerOrigin.y);
+    CGFloat           scale    = state->baseScale;
+
+    if (state->context) {
+        ctm = CGContextGetCTM(state->context);
+
+        toDevice = CGAffineTransformConcat(toDevice, ctm);
+        clipRect = CGRectApplyAffineTransform(state->clipBoundingBox, ctm);
+        scale   *= sqrt(fabs((ctm.a * ctm.d) - (ctm.b * ctm.c)));
+    }
+
+    CGSize outset = SwiffFilterListGetOutset(filters, scale);
+    CGRect bounds = CGRectInset(CGRectApplyAffineTransform(command->rect, toDevice), -outset.width, -outset.height);
+
+    if (cacheKey && ((bounds.size.width * bounds.size.height * 4) > [state->bitmapCache byteLimit])) {
+        cacheKey = nil;
+    }
+
+    if (cacheKey) {
+        CGRect cachedRect;
+        BOOL   wasMissed = NO;
+        CGImageRef cachedImage = NULL;
+        NSData *cachedPixels = [state->bitmapCache pixelsForKey:cacheKey transform:toDevice rect:&cachedRect image:&cachedImage wasMissed:&wasMissed];
+
+        // Drawn in place, from the pixels and image held by the cache
+        if (cachedPixels) {
+            SwiffRenderLayer cachedLayer;
+            memset(&cachedLayer, 0, sizeof(SwiffRenderLayer));
+
+            cachedLayer.pixels            = (UInt8 *)[cachedPixels bytes];
+            cachedLayer.hasBorrowedPixels = YES;
+            cachedLayer.rect              = cachedRect;
+            cachedLayer.blendMode         = blendMode;
+
+            if (state->context) {
+                cachedLayer.image = cachedImage ? CGImageRetain(cachedImage) : sCreateImageWithPixels(cachedPixels, cachedRect.size.width, cachedRect.size.height);
+            }
+
+            sDrawLayer(state, &cachedLayer);
+            state->skippedLayersCount = 1;
+
+            return;
+        }
+
+        // A sliding sprite is cached the second time it misses with the same scale and rotation
+        if (cacheKey->_isAutomatic && !wasMissed) {
+            cacheKey = nil;
+        }
+    }
+
+    CGRect rect;
+
+    if (cacheKey) {
+        rect = bounds;
+
+    // Alpha also makes the parent transparent outside of the placed object, so it covers all of the clip bounds
+    } else if (blendMode == SwiffBlendModeAlpha) {
+        rect = CGRectInset(clipRect, -outset.width, -outset.height);
+
+    } else {
+        rect = CGRectIntersection(bounds, CGRectInset(clipRect, -outset.width, -outset.height));
+    }
+
+    rect = CGRectIsNull(rect) ? CGRectZero : CGRectIntegral(rect);
+
+    size_t width  = MAX((size_t)rect.size.width,  1);
+    size_t height = MAX((size_t)rect.size.height, 1);
+    rect.size = CGSizeMake(width, height);
+
+    if (state->layersCount == state->layersCapacity) {
+        state->layersCapacity = state->layersCapacity ? (state->layersCapacity * 2) : 4;
+        state->layers = realloc(state->layers, sizeof(SwiffRenderLayer) * state->layersCapacity);
+    }
+
+    SwiffRenderLayer *layer = &state->layers[state->layersCount++];
+
+    layer->parentContext          = state->context;
+    layer->parentRasterizer       = state->rasterizer;
+    layer->parentRasterizerOrigin = state->rasterizerOrigin;
+    layer->pixels                 = NULL;
+    layer->image                  = NULL;
+    layer->hasBorrowedPixels      = NO;
+    layer->rect                   = rect;
+    layer->scale                  = scale;
+    layer->filters                = filters;
+    layer->blendMode              = blendMode;
+    layer->cacheKey               = cacheKey;
+    layer->cacheTransform         = toDevice;
+    layer->isDirect               = !cacheKey && ([filters count] == 0) && (blendMode == SwiffBlendModeNormal);
+
+    if (layer->isDirect) {
+        return;
+    }
+
+    layer->pixels = calloc(width * height, 4);
+
+    if (state->context) {
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+        CGContextRef    context    = CGBitmapContextCreate(layer->pixels, width, height, 8, width * 4, colorSpace, kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+        CGColorSpaceRelease(colorSpace);
+
+        // The layer keeps the user space of its parent, offset to the position of the layer in device space
+        CGContextTranslateCTM(context, -rect.origin.x, -rect.origin.y);
+        CGContextConcatCTM(context, ctm);
+        sSetupContext(state, context);
+
+        state->context = context;
+
+    } else {
+        state->rasterizer = SwiffRasterizerCreate(layer->pixels, width, height, width * 4);
+        state->rasterizerOrigin.x += rect.origin.x;
+        state->rasterizerOrigin.y += rect.origin.y;
+    }
+}
+
+
+// Returns to the parent of the current layer, without drawing the layer
+static SwiffRenderLayer *sPopLayer(SwiffRenderState *state)
+{
+    SwiffRenderLayer *layer = &state->layers[--state->layersCount];
+
+    if (!layer->isDirect) {
+        if (layer->parentContext) {
+            CGContextRelease(state->context);
+        } else {
+            SwiffRasterizerFree(state->rasterizer);
+        }
+    }
+
+    state->context          = layer->parentContext;
+    state->rasterizer       = layer->parentRasterizer;
+    state->rasterizerOrigin = layer->parentRasterizerOrigin;
+
+    return layer;
+}
+
+
+static void sEndLayer(SwiffRenderState *state)
+{
+    if (!state->layersCount) return;
+
+    SwiffRenderLayer *layer = sPopLayer(state);
+    if (layer->isDirect) return;
+
+    size_t width  = layer->rect.size.width;
+    size_t height = layer->rect.size.height;
+
+    SwiffFilterListApply(layer->filters, layer->pixels, width, height, width * 4, layer->scale);
+
+    // The cache takes the pixels without a copy, and the layer borrows them back.  The NSData must outlive
+    // sDrawLayer(), as the cache does not keep pixels over its byteLimit
+    __attribute__((objc_precise_lifetime)) NSData *cachedPixels = nil;
+
+    if (layer->cacheKey) {
+        cachedPixels = [NSData dataWithBytesNoCopy:layer->pixels length:(width * height * 4) freeWhenDone:YES];
+        layer->hasBorrowedPixels = YES;
+
+        if (state->context) {
+            layer->image = sCreateImageWithPixels(cachedPixels, width, height);
+        }
+
+        [state->bitmapCache addPixels:cachedPixels image:layer->image rect:layer->rect forKey:layer->cacheKey transform:layer->cacheTransform];
+    }
+
+    sDrawLayer(state, layer);
+}
+
+
+// Frees any layers left open, such as when a display list is not balanced
+static void sDiscardLayers(SwiffRenderState *state)
+{
+    while (state->layersCount) {
+        SwiffRenderLayer *layer = sPopLayer(state);
+        sFreeLayerPixels(layer);
+    }
+
+    free(state->layers);
+    state->layers = NULL;
+    state->layersCapacity = 0;
+}
+
+
+#pragma mark -
+#pragma mark Clip Masks
+
+// Looks up the coverage of the clipping path in the bitmap cache, covering the bounds of the mask.  When found, it
+// starts the clipping path, and the commands which would build it are skipped until the EndClipPath.  Otherwise,
+// as with sliding sprites, the coverage is cached by sPushClipMask() the second time it misses.
+static void sBeginClipMask(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    SwiffRenderBitmapKey *cacheKey = state->bitmapCache ? (__bridge SwiffRenderBitmapKey *)command->cacheKey : nil;
+    if (!cacheKey) return;
+
+    CGAffineTransform toDevice = state->affineTransform;
+    if (state->context) {
+        toDevice = CGAffineTransformConcat(toDevice, CGContextGetCTM(state->context));
+    }
+
+    CGRect bounds = CGRectIntegral(CGRectApplyAffineTransform(command->rect, toDevice));
+
+    if (CGRectIsEmpty(bounds) || ((bounds.size.width * bounds.size.height) > [state->bitmapCache byteLimit])) {
+        return;
+    }
+
+    CGRect     cachedRect;
+    CGImageRef cachedImage = NULL;
+    BOOL       wasMissed   = NO;
+    NSData    *coverage    = [state->bitmapCache pixelsForKey:cacheKey transform:toDevice rect:&cachedRect image:&cachedImage wasMissed:&wasMissed];
+
+    if (coverage) {
+        size_t width  = cachedRect.size.width;
+        size_t height = cachedRect.size.height;
+
+        if (state->rasterizer) {
+            SwiffRasterizerAddCoverageToClipMask(state->rasterizer, [coverage bytes], (NSInteger)cachedRect.origin.x, (NSInteger)cachedRect.origin.y, width, height);
+
+        } else {
+            CGImageRelease(state->clipMaskImage);
+            state->clipMaskImage = cachedImage ? CGImageRetain(cachedImage) : sCreateImageWithCoverage(coverage, width, height);
+            state->clipMaskRect  = cachedRect;
+        }
+
+        state->skippedClipPathsCount = 1;
+
+    } else if (wasMissed) {
+        state->clipMaskKey       = cacheKey;
+        state->clipMaskRect      = bounds;
+        state->clipMaskTransform = toDevice;
+    }
+}
+
+
+// Clips to the clipping path, adding its coverage to the bitmap cache when sBeginClipMask() requested it
+static void sPushClipMask(SwiffRenderState *state)
+{
+    CGContextRef          context  = state->context;
+    SwiffRenderBitmapKey *cacheKey = state->clipMaskKey;
+    CGRect                rect     = state->clipMaskRect;
+    size_t                width    = rect.size.width;
+    size_t                height   = rect.size.height;
+
+    state->clipMaskKey = nil;
+
+    if (state->rasterizer) {
+        if (cacheKey) {
+            NSMutableData *coverage = [NSMutableData dataWithLength:(width * height)];
+
+            if (SwiffRasterizerCopyClipMask(state->rasterizer, [coverage mutableBytes], (NSInteger)rect.origin.x, (NSInteger)rect.origin.y, width, height)) {
+                [state->bitmapCache addPixels:coverage image:NULL rect:rect forKey:cacheKey transform:state->clipMaskTransform];
+            }
+        }
+
+        SwiffRasterizerApplyClipMask(state->rasterizer);
+        return;
+    }
+
+    CGContextSaveGState(context);
+
+    if (state->clipMaskImage) {
+        CGAffineTransform ctm = CGContextGetCTM(context);
+
+        CGContextConcatCTM(context, CGAffineTransformInvert(ctm));
+        CGContextClipToMask(context, rect, state->clipMaskImage);
+        CGContextConcatCTM(context, ctm);
+
+        CGImageRelease(state->clipMaskImage);
+        state->clipMaskImage = NULL;
+
+        return;
+    }
+
+    if (cacheKey && !CGContextIsPathEmpty(context)) {
+        NSMutableData   *coverage    = [NSMutableData dataWithLength:(width * height)];
+        CGColorSpaceRef  colorSpace  = CGColorSpaceCreateDeviceGray();
+        CGContextRef     maskContext = CGBitmapContextCreate([coverage mutableBytes], width, height, 8, width, colorSpace, kCGImageAlphaNone);
+        CGPathRef        path        = CGContextCopyPath(context);
+
+        CGColorSpaceRelease(colorSpace);
+
+        // As with layers, the mask keeps the user space of the context, offset to the position of the mask
+        CGContextTranslateCTM(maskContext, -rect.origin.x, -rect.origin.y);
+        CGContextConcatCTM(maskContext, CGContextGetCTM(context));
+        sSetupContext(state, maskContext);
+
+        CGContextSetGrayFillColor(maskContext, 1.0, 1.0);
+        CGContextAddPath(maskContext, path);
+        CGContextFillPath(maskContext);
+
+        CGContextRelease(maskContext);
+        CGPathRelease(path);
+
+        CGImageRef image = sCreateImageWithCoverage(coverage, width, height);
+        [state->bitmapCache addPixels:coverage image:image rect:rect forKey:cacheKey transform:state->clipMaskTransform];
+        CGImageRelease(image);
+    }
+
+    CGContextClip(context);
+}
+
+
+static void sEndClipMask(SwiffRenderState *state)
+{
+    state->clipMaskKey = nil;
+
+    CGImageRelease(state->clipMaskImage);
+    state->clipMaskImage = NULL;
+}
+
+
+#pragma mark -
+#pragma mark Command Execution
+
+static void sExecuteStrokePath(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    SwiffPath *path = (__bridge SwiffPath *)command->object;
+
+    SwiffPathOperation *operations = [path operations];
+    float *xs = [path xCoordinates];
+    float *ys = [path yCoordinates];
+    if (!operations || !xs || !ys) return;
+
+    SwiffLineStyle *lineStyle = [path lineStyle];
+    CGFloat lineWidth = [lineStyle width];
+
+    // Prevent blurry lines when a/d are 1/-1 
+    BOOL isHairline  = (lineWidth == SwiffLineStyleHairlineWidth);
+    BOOL shouldRound = NO;
+    BOOL noScale     = NO;
+
+    if ((lround(lineWidth) % 2) == 1 &&
+        ((state->affineTransform.a == 1.0) || (state->affineTransform.a == -1.0)) &&
+        ((state->affineTransform.d == 1.0) || (state->affineTransform.d == -1.0)))
+    {
+        shouldRound = YES;
+    }
+
+    if (![lineStyle scalesHorizontally] && ![lineStyle scalesVertically]) {
+        noScale = YES;
+    }
+
+    CGContextRef context = state->context;
+    CGContextBeginPath(context);
+    CGContextSaveGState(context);
+
+    if (isHairline || shouldRound || noScale) {
+        if (isHairline) {
+            lineWidth = state->hairlineWidth;
+
+            if ((state->fillHairlineWidth != 0) && [path usesFillHairlineWidth]) {
+                lineWidth = state->fillHairlineWidth;
+            }
+        }
+        
+        NSUInteger count = [path pointsCount];
+        sReservePoints(state, count);
+        SwiffPathTransformPoints(path, state->affineTransform, state->points);
+
+        CGPoint *snappedPoints = NULL;
+
+        if (isHairline || shouldRound) {
+            CGFloat scale  = state->scaleFactorHint;
+            CGFloat offset = (lround(lineWidth * scale) % 2) ? ((1.0 / scale) / 2) : 0;
+
+            snappedPoints = state->snappedPoints;
+            sSnapStrokePoints(state->points, snappedPoints, count, scale, offset, state->ceilX, state->ceilY);
+        }
+
+        sTracePathStrokeAdvanced(state, operations, xs, ys, state->points, snappedPoints, isHairline, [lineStyle closesStroke]);
+
+    } else {
+        CGContextConcatCTM(context, state->affineTransform);
+        sTracePathStrokeSimple(state, operations, xs, ys, [lineStyle closesStroke]);
+    }
+
+    CGContextSetLineWidth(context, lineWidth);
+
+    if (isHairline) {
+        CGContextSetLineCap(context,  kCGLineCapButt);
+        CGContextSetLineJoin(context, kCGLineJoinMiter);
+
+    } else {
+        CGLineJoin lineJoin = [lineStyle lineJoin];
+        
+        //!issue10: Use endLineCap at some point
+        CGLineCap lineCap = [lineStyle startLineCap];
+
+        CGContextSetLineCap(context, lineCap);
+        CGContextSetLineJoin(context, lineJoin);
+
+        if (lineJoin == kCGLineJoinMiter) {
+            //!issue9: Better miter limits
+            //    When the miter limit is hit, Quartz and Flash render it differently -
+            //    Quartz converts it to a bezel that extends to 1/2 the line width
+            //    Flash converts it to a bezel that extends to: MiterLimitFactor * LineWidth
+            //  
+            CGContextSetMiterLimit(context, [lineStyle miterLimit]);
+        }
+    }
+
+    CGContextSetStrokeColor(context, (CGFloat *)&command->color);
+    CGContextDrawPath(context, kCGPathStroke);
 
-    } else if (type == SwiffFillStyleTypeColor) {
-        SwiffColor color = SwiffColorApplyColorTransformStack([style color], state->colorTransforms);
+    CGContextRestoreGState(context);
+}
 
-        if (state->colorModificationBlock) {
-            state->colorModificationBlock(&color);
-        }
 
-        CGContextSetFillColor(context, (CGFloat *)&color);
+static void sExecuteFillPath(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    SwiffPath *path = (__bridge SwiffPath *)command->object;
+
+    SwiffPathOperation *operations = [path operations];
+    float *xs = [path xCoordinates];
+    float *ys = [path yCoordinates];
+
+    if (!operations || !xs || !ys) return;
+
+    SwiffFillStyle    *style = [path fillStyle];
+    SwiffFillStyleType type  = [style type];
+
+    CGContextRef context = state->context;
+
+    // The clipping path accumulates fills until sExecuteCommand() pushes it
+    if (!state->isBuildingClippingPath) {
+        CGContextBeginPath(context);
+    }
+
+    CGContextSaveGState(context);
+    NSUInteger count = [path pointsCount];
+    sReservePoints(state, count);
+    SwiffPathTransformPoints(path, state->affineTransform, state->points);
+    sSnapFillPoints(state->points, state->snappedPoints, count);
+
+    sTracePathFill(state, operations, xs, ys, state->points, state->snappedPoints);
+
+    CGContextConcatCTM(context, state->affineTransform);
+
+    if (state->isBuildingClippingPath) {
+        // Do nothing if we are building the clip path
+
+    } else if (type == SwiffFillStyleTypeColor) {
+        CGContextSetFillColor(context, (CGFloat *)&command->color);
         CGContextDrawPath(context, kCGPathFill);
 
     } else if ((type == SwiffFillStyleTypeLinearGradient) || (type == SwiffFillStyleTypeRadialGradient)) {
         CGContextEOClip(context);
 
-        CGGradientRef gradient = [[style gradient] copyCGGradientWithColorTransformStack:state->colorTransforms colorModificationBlock:state->colorModificationBlock];
+        CGGradientRef gradient = command->gradient;
         CGGradientDrawingOptions options = (kCGGradientDrawsBeforeStartLocation | kCGGradientDrawsAfterEndLocation);
 
-        if (type == SwiffFillStyleTypeLinearGradient) {
+        if (!gradient) {
+            // Nothing to draw
+
+        } else if (type == SwiffFillStyleTypeLinearGradient) {
             // "All gradients are defined in a standard space called the gradient square. The gradient square is
             //  centered at (0,0), and extends from (-16384,-16384) to (16384,16384)." (Page 144)
             // 
@@ -533,8 +1621,6 @@ static void sFillPath(SwiffRenderState *state, SwiffPath *path)
 
             CGContextDrawRadialGradient(context, gradient, centerPoint, 0, centerPoint, radius, options);
         }
-        
-        CGGradientRelease(gradient);
 
     } else if ((type >= SwiffFillStyleTypeRepeatingBitmap) && (type <= SwiffFillStyleTypeNonSmoothedClippedBitmap)) {
         SwiffBitmapDefinition *bitmapDefinition = [state->movie bitmapDefinitionWithLibraryID:[style bitmapID]];
@@ -562,11 +1648,7 @@ static void sFillPath(SwiffRenderState *state, SwiffPath *path)
             CGContextScaleCTM(context, 1, -1);
             
             CGContextSetInterpolationQuality(context, shouldInterpolate ? kCGInterpolationDefault : kCGInterpolationNone);
-
-            SwiffColor color = { 1.0, 1.0, 1.0, 1.0 };
-            color = SwiffColorApplyColorTransformStack(color, state->colorTransforms);
-
-            CGContextSetAlpha(context, color.alpha);
+            CGContextSetAlpha(context, command->color.alpha);
     
             CGContextDrawImage(context, rect, image);
         }   
@@ -576,32 +1658,400 @@ static void sFillPath(SwiffRenderState *state, SwiffPath *path)
 }
 
 
-static void sDrawSpriteDefinition(SwiffRenderState *state, SwiffSpriteDefinition *spriteDefinition)
+static void sExecuteFillText(SwiffRenderState *state, const SwiffDisplayListCommand *command)
 {
-    NSArray    *frames = [spriteDefinition frames];
-    SwiffFrame *frame  = [frames count] ? [frames objectAtIndex:0] : nil;
+    CGContextRef context = state->context;
+
+    CGContextSaveGState(context);
+
+    CGContextConcatCTM(context, state->affineTransform);
+
+    // As with sExecuteFillPath(), the glyphs are added to the clipping path rather than drawn
+    if (state->isBuildingClippingPath) {
+        CGContextAddPath(context, (CGPathRef)command->object);
+
+    } else {
+        CGContextBeginPath(context);
+        CGContextAddPath(context, (CGPathRef)command->object);
+
+        CGContextSetFillColor(context, (CGFloat *)&command->color);
+        CGContextDrawPath(context, kCGPathFill);
+    }
+
+    CGContextRestoreGState(context);
+}
+
+
+static void sExecuteDrawText(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    CFAttributedStringRef as = command->object;
+    CGRect rect = command->rect;
+
+    CGContextRef context = state->context;
+    CTFramesetterRef framesetter = as ? CTFramesetterCreateWithAttributedString(as) : NULL;
     
+    if (framesetter) {
+        CGPathRef  path  = CGPathCreateWithRect(CGRectMake(0, 0, rect.size.width, rect.size.height), NULL);
+        CTFrameRef frame = CTFramesetterCreateFrame(framesetter, CFRangeMake(0, 0), path, NULL);
+
+        if (frame) {
+            CGContextSaveGState(context);
+
+            CGContextConcatCTM(context, state->affineTransform);
+            CGContextTranslateCTM(context, rect.origin.x, CGRectGetMaxY(rect));
+            CGContextScaleCTM(context, 1, -1);
+            
+            NSInteger i;
+            CFArrayRef lines = CTFrameGetLines(frame);
+            CFIndex linesCount = CFArrayGetCount(lines);
+            CGPoint *origins = malloc(sizeof(CGPoint) * linesCount);
+
+            CTFrameGetLineOrigins(frame, CFRangeMake(0, 0), origins);
+
+            for (i = 0; i < linesCount; i++) {
+                CTLineRef line = CFArrayGetValueAtIndex(lines, i);
+                CGPoint origin = origins[i];
+
+                CFRange rangeOfLine = CTLineGetStringRange(line);
+
+                origin.y -= SwiffTextGetMaximumVerticalOffset((__bridge NSAttributedString *)as, rangeOfLine);
+
+                CGContextSetTextPosition(context, origin.x, origin.y);
+                
+                CTLineDraw(line, context);
+            }
+            
+            free(origins);
+
+            CGContextFlush(context);
+            CGContextRestoreGState(context);
+
+            CFRelease(frame);
+        }
+        
+        if (path) CFRelease(path);
+        CFRelease(framesetter);
+    }
+}
+
+
+// Draws command with state->affineTransform as its transform, into either state->context or state->rasterizer
+static void sExecuteCommand(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    // The layer which contains command was drawn from the bitmap cache, see sBeginLayer()
+    if (state->skippedLayersCount) {
+        if (command->type == SwiffDisplayListCommandTypeBeginLayer) {
+            state->skippedLayersCount++;
+        } else if (command->type == SwiffDisplayListCommandTypeEndLayer) {
+            state->skippedLayersCount--;
+        }
+
+        return;
+    }
+
+    // The clipping path which contains command was drawn from the bitmap cache, see sBeginClipMask().
+    // Only its own PushClip and EndClipPath are executed
+    if (state->skippedClipPathsCount) {
+        SwiffDisplayListCommandType type = command->type;
+
+        if (type == SwiffDisplayListCommandTypeBeginClipPath) {
+            state->skippedClipPathsCount++;
+        } else if (type == SwiffDisplayListCommandTypeEndClipPath) {
+            state->skippedClipPathsCount--;
+        }
+
+        BOOL isOwnPush = (type == SwiffDisplayListCommandTypePushClip) && (state->skippedClipPathsCount == 1);
+        BOOL isOwnEnd  = (type == SwiffDisplayListCommandTypeEndClipPath) && (state->skippedClipPathsCount == 0);
+
+        if (!isOwnPush && !isOwnEnd) return;
+    }
+
+    CGContextRef     context    = state->context;
+    SwiffRasterizer *rasterizer = state->rasterizer;
+
+    // Inside a layer, the rasterizer only covers the layer
+    CGAffineTransform savedTransform = state->affineTransform;
+    state->affineTransform.tx -= state->rasterizerOrigin.x;
+    state->affineTransform.ty -= state->rasterizerOrigin.y;
+
+    switch (command->type) {
+    case SwiffDisplayListCommandTypeStrokePath:
+        if (rasterizer) {
+            sRasterizeStrokePath(state, command);
+        } else {
+            sExecuteStrokePath(state, command);
+        }
+
+        break;
+
+    case SwiffDisplayListCommandTypeFillPath:
+        if (rasterizer) {
+            sRasterizeFillPath(state, command);
+        } else {
+            sExecuteFillPath(state, command);
+        }
+
+        break;
+
+    case SwiffDisplayListCommandTypeFillText:
+        if (rasterizer) {
+            sRasterizeFillText(state, command);
+        } else {
+            sExecuteFillText(state, command);
+        }
+
+        break;
+
+    case SwiffDisplayListCommandTypeDrawText:
+        // Dynamic text is laid out and drawn by Core Text, so it requires a context
+        if (context) {
+            sExecuteDrawText(state, command);
+        }
+
+        break;
+
+    case SwiffDisplayListCommandTypeBeginClipPath:
+        state->isBuildingClippingPath = YES;
+
+        if (rasterizer) {
+            SwiffRasterizerBeginClipMask(rasterizer);
+        }
+
+        sBeginClipMask(state, command);
+
+        break;
+
+    case SwiffDisplayListCommandTypeEndClipPath:
+        state->isBuildingClippingPath = NO;
+        sEndClipMask(state);
+        break;
+
+    case SwiffDisplayListCommandTypePushClip:
+        sPushClipMask(state);
+        break;
+
+    case SwiffDisplayListCommandTypePopClip:
+        if (rasterizer) {
+            SwiffRasterizerRemoveClipMask(rasterizer);
+        } else {
+            CGContextRestoreGState(context);
+        }
+
+        break;
+
+    // Traversal draws blend modes through layers instead, see sDrawPlacedObject().
+    // The rasterizer ignores these commands
+    case SwiffDisplayListCommandTypePushBlendMode:
+        if (context) {
+            CGContextSaveGState(context);
+            CGContextSetBlendMode(context, command->blendMode);
+        }
+
+        break;
+
+    case SwiffDisplayListCommandTypePopBlendMode:
+        if (context) {
+            CGContextRestoreGState(context);
+        }
+
+        break;
+
+    case SwiffDisplayListCommandTypeBeginLayer:
+        sBeginLayer(state, command);
+        break;
+
+    case SwiffDisplayListCommandTypeEndLayer:
+        sEndLayer(state);
+        break;
+    }
+
+    state->affineTransform = savedTransform;
+}
+
+
+// Fills state->bitmapPixels with every bitmap used by displayList
+static void sPrepareBitmapPixels(SwiffRenderState *state, SwiffDisplayList *displayList)
+{
+    const SwiffDisplayListCommand *commands = [displayList commands];
+    NSUInteger commandsCount = [displayList commandsCount];
+
+    for (NSUInteger i = 0; i < commandsCount; i++) {
+        const SwiffDisplayListCommand *command = &commands[i];
+        if (command->type != SwiffDisplayListCommandTypeFillPath) continue;
+
+        SwiffFillStyle    *style = [(__bridge SwiffPath *)command->object fillStyle];
+        SwiffFillStyleType type  = [style type];
+
+        if ((type >= SwiffFillStyleTypeRepeatingBitmap) && (type <= SwiffFillStyleTypeNonSmoothedClippedBitmap)) {
+            size_t width, height;
+            sGetBitmapPixels(state, [style bitmapID], &width, &height);
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Traversal
+
+static SwiffDisplayListCommand sMakeCommand(SwiffRenderState *state, SwiffDisplayListCommandType type)
+{
+    SwiffDisplayListCommand command;
+    memset(&command, 0, sizeof(SwiffDisplayListCommand));
+
+    command.type = type;
+    command.transform = state->affineTransform;
+    command.bounds = state->renderBounds;
+
+    return command;
+}
+
+
+// Records command into state->displayList, or draws it immediately when not recording
+static void sSubmitCommand(SwiffRenderState *state, const SwiffDisplayListCommand *command)
+{
+    if (state->displayList) {
+        SwiffDisplayListAddCommand(state->displayList, command);
+
+    } else {
+        CGAffineTransform savedTransform = state->affineTransform;
+
+        state->affineTransform = command->transform;
+        sExecuteCommand(state, command);
+        state->affineTransform = savedTransform;
+    }
+}
+
+
+static void sStartClipping(SwiffRenderState *state, UInt16 clipDepth, CGRect maskBounds)
+{
+    if (state->clipDepth == 0) {
+        SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypePushClip);
+        sSubmitCommand(state, &command);
+
+        state->clipDepth = clipDepth;
+        state->clipMaskBounds = maskBounds;
+    }
+}
+
+
+static void sStopClipping(SwiffRenderState *state)
+{
+    if (state->clipDepth) {
+        SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypePopClip);
+        sSubmitCommand(state, &command);
+
+        state->clipDepth = 0;
+        state->skipUntilClipDepth = NO;
+    }
+}
+
+
+static void sStrokePath(SwiffRenderState *state, SwiffPath *path)
+{
+    SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeStrokePath);
+
+    command.object = (__bridge CFTypeRef)path;
+    command.color  = sResolveColor(state, [[path lineStyle] color]);
+
+    sSubmitCommand(state, &command);
+}
+
+
+static void sFillPath(SwiffRenderState *state, SwiffPath *path)
+{
+    SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeFillPath);
+    command.object = (__bridge CFTypeRef)path;
+
+    SwiffFillStyle    *style = [path fillStyle];
+    SwiffFillStyleType type  = [style type];
+
+    UInt8 gradientTable[SwiffRasterizerGradientTableLength * 4];
+
+    if (state->isBuildingClippingPath) {
+        // Fills of the clipping path have no color
+
+    } else if (type == SwiffFillStyleTypeColor) {
+        command.color = sResolveColor(state, [style color]);
+
+    } else if ((type == SwiffFillStyleTypeLinearGradient) || (type == SwiffFillStyleTypeRadialGradient)) {
+        SwiffGradient *gradient = [style gradient];
+
+        // A display list may be replayed into either backend, so it gets both representations
+        if (!state->context) {
+            [gradient getRGBA8Table:gradientTable length:SwiffRasterizerGradientTableLength composedColorTransform:&state->colorTransform colorModificationBlock:state->colorModificationBlock];
+            command.gradientTable = gradientTable;
+        }
+
+        if (!state->rasterizer) {
+            command.gradient = [gradient copyCGGradientWithComposedColorTransform:&state->colorTransform colorModificationBlock:state->colorModificationBlock];
+        }
+
+    } else if ((type >= SwiffFillStyleTypeRepeatingBitmap) && (type <= SwiffFillStyleTypeNonSmoothedClippedBitmap)) {
+        SwiffColor color = { 1.0, 1.0, 1.0, 1.0 };
+        command.color = SwiffColorApplyComposedColorTransform(color, sGetStackColorTransform(state));
+    }
+
+    sSubmitCommand(state, &command);
+
+    if (command.gradient) {
+        CGGradientRelease(command.gradient);
+    }
+}
+
+
+// Draws the current frame of the sprite instance with timeline, or the first frame when it is nil
+static void sDrawSpriteDefinition(SwiffRenderState *state, SwiffSpriteDefinition *spriteDefinition, SwiffTimeline *timeline)
+{
+    NSArray    *frames = [spriteDefinition frames];
+    SwiffFrame *frame  = timeline ? [timeline frame] : ([frames count] ? [frames objectAtIndex:0] : nil);
+
+    SwiffTimeline *parentTimeline = state->timeline;
+    state->timeline = timeline;
+
     for (SwiffPlacedObject *po in [frame placedObjects]) {
         sDrawPlacedObject(state, po);
     }
+
+    state->timeline = parentTimeline;
+}
+
+
+// Returns the number of paths drawn by the first frame of spriteDefinition, counting text as one path.
+// Stops counting at limit
+static NSUInteger sCountSpritePaths(SwiffRenderState *state, SwiffSpriteDefinition *spriteDefinition, NSUInteger limit)
+{
+    NSArray    *frames = [spriteDefinition frames];
+    SwiffFrame *frame  = [frames count] ? [frames objectAtIndex:0] : nil;
+    NSUInteger  count  = 0;
+
+    for (SwiffPlacedObject *po in [frame placedObjects]) {
+        if (count >= limit) break;
+
+        id<SwiffDefinition> definition = SwiffMovieGetDefinition(state->movie, [po libraryID]);
+
+        if ([definition isKindOfClass:[SwiffShapeDefinition class]]) {
+            count += [[(SwiffShapeDefinition *)definition paths] count];
+        } else if ([definition isKindOfClass:[SwiffSpriteDefinition class]]) {
+            count += sCountSpritePaths(state, (SwiffSpriteDefinition *)definition, limit - count);
+        } else if (definition) {
+            count++;
+        }
+    }
+
+    return count;
 }
 
 
 static void sDrawShapeDefinition(SwiffRenderState *state, SwiffShapeDefinition *shapeDefinition)
 {
-    CGContextRef context = state->context;
-
     for (SwiffPath *path in [shapeDefinition paths]) {
         SwiffLineStyle *lineStyle = [path lineStyle];
 
-        if (state->isBuildingClippingPath) {
-            if (lineStyle) continue;
-        } else {
-            CGContextBeginPath(context);
-        }
-
         if (lineStyle) {
-            sStrokePath(state, path);
+            if (!state->isBuildingClippingPath) {
+                sStrokePath(state, path);
+            }
+
         } else {
             sFillPath(state, path);
         }
@@ -609,72 +2059,28 @@ static void sDrawShapeDefinition(SwiffRenderState *state, SwiffShapeDefinition *
 }
 
 
+// Each text record becomes a single FillText command, using the glyph run path cached by the definition.
+// As these paths are in the space of the definition, the command keeps the current transform
 static void sDrawStaticTextDefinition(SwiffRenderState *state, SwiffStaticTextDefinition *staticTextDefinition)
 {
-    SwiffFontDefinition *font = nil;
-    CGPathRef *glyphPaths = NULL;
-
-    CGContextRef context = state->context;
-    CGPoint offset = CGPointZero;
-    CGFloat aWithMultiplier = state->affineTransform.a;
-    CGFloat dWithMultiplier = state->affineTransform.d;
+    NSArray *glyphRunPaths = [staticTextDefinition glyphRunPaths];
+    NSUInteger index = 0;
 
-    CGContextSaveGState(context);
+    SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeFillText);
+    command.color.alpha = 1.0;
 
     for (SwiffStaticTextRecord *record in [staticTextDefinition textRecords]) {
-        NSInteger glyphEntriesCount = [record glyphEntriesCount];
-        SwiffStaticTextRecordGlyphEntry *glyphEntries = [record glyphEntries];
-        
-        CGFloat advance = 0; 
-
-        if ([record hasFont]) {
-            font = [state->movie fontDefinitionWithLibraryID:[record fontID]];
-            glyphPaths = [font glyphPaths];
+        CGPathRef path = (__bridge CGPathRef)[glyphRunPaths objectAtIndex:index++];
 
-            CGFloat multiplier = (1.0 / SwiffFontEmSquareHeight) * [record textHeight];
-            aWithMultiplier = state->affineTransform.a * multiplier;
-            dWithMultiplier = state->affineTransform.d * multiplier;
-        }
-        
         if ([record hasColor]) {
-            CGContextSetFillColor(context, (CGFloat *)[record colorPointer]);
-        }
-        
-        if ([record hasXOffset]) {
-            offset.x = [record xOffset];
+            command.color = [record color];
         }
 
-        if ([record hasYOffset]) {
-            offset.y = [record yOffset];
-        }
-
-        if (glyphPaths && glyphEntries) {
-            for (NSInteger i = 0; i < glyphEntriesCount; i++) {
-                SwiffStaticTextRecordGlyphEntry entry = glyphEntries[i];
-
-                CGAffineTransform savedTransform = state->affineTransform;
-
-                state->affineTransform = CGAffineTransformTranslate(state->affineTransform, offset.x + advance, offset.y);
-                state->affineTransform.a = aWithMultiplier;
-                state->affineTransform.d = dWithMultiplier;
-
-                CGContextSaveGState(context);
-                CGContextConcatCTM(context, state->affineTransform);
-                CGContextAddPath(context, glyphPaths[entry.index]);
-                CGContextRestoreGState(context);
-
-                advance += entry.advance;
-
-                state->affineTransform = savedTransform;
-            }
+        if (!CGPathIsEmpty(path)) {
+            command.object = path;
+            sSubmitCommand(state, &command);
         }
-        
-        CGContextDrawPath(context, kCGPathFill);
-
-        offset.x += advance;
     }
-
-    CGContextRestoreGState(context);
 }
 
 
@@ -682,7 +2088,6 @@ static void sDrawPlacedDynamicText(SwiffRenderState *state, SwiffPlacedDynamicTe
 {
     NSMutableAttributedString *as = [[placedDynamicText attributedText] mutableCopy];
     SwiffDynamicTextDefinition *definition = [placedDynamicText definition];
-    CGRect rect = [definition bounds];
 
     NSRange entireString = NSMakeRange(0, [as length]);
 
@@ -690,13 +2095,7 @@ static void sDrawPlacedDynamicText(SwiffRenderState *state, SwiffPlacedDynamicTe
     // colorModificationBlock to all kCTForegroundColorAttributeName values
     //
     [as enumerateAttribute:(__bridge NSString *)kCTForegroundColorAttributeName inRange:entireString options:NSAttributedStringEnumerationLongestEffectiveRangeNotRequired usingBlock:^(id value, NSRange range, BOOL *stop) {
-        SwiffColor swiffColor = SwiffColorFromCGColor((__bridge CGColorRef)value);
-
-        swiffColor = SwiffColorApplyColorTransformStack(swiffColor, state->colorTransforms);
-
-        if (state->colorModificationBlock) {
-            state->colorModificationBlock(&swiffColor);
-        }
+        SwiffColor swiffColor = sResolveColor(state, SwiffColorFromCGColor((__bridge CGColorRef)value));
 
         CGColorRef replacementColor = SwiffColorCopyCGColor(swiffColor);
         if (replacementColor) {
@@ -705,62 +2104,31 @@ static void sDrawPlacedDynamicText(SwiffRenderState *state, SwiffPlacedDynamicTe
         }
     }];
 
+    SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeDrawText);
 
-    CGContextRef context = state->context;
-    CTFramesetterRef framesetter = as ? CTFramesetterCreateWithAttributedString((__bridge CFAttributedStringRef)as) : NULL;
-    
-    if (framesetter) {
-        CGPathRef  path  = CGPathCreateWithRect(CGRectMake(0, 0, rect.size.width, rect.size.height), NULL);
-        CTFrameRef frame = CTFramesetterCreateFrame(framesetter, CFRangeMake(0, 0), path, NULL);
-
-        if (frame) {
-            CGContextSaveGState(context);
-
-            CGContextConcatCTM(context, state->affineTransform);
-            CGContextTranslateCTM(context, rect.origin.x, CGRectGetMaxY(rect));
-            CGContextScaleCTM(context, 1, -1);
-            
-            NSInteger i;
-            CFArrayRef lines = CTFrameGetLines(frame);
-            CFIndex linesCount = CFArrayGetCount(lines);
-            CGPoint *origins = malloc(sizeof(CGPoint) * linesCount);
-
-            CTFrameGetLineOrigins(frame, CFRangeMake(0, 0), origins);
-
-            for (i = 0; i < linesCount; i++) {
-                CTLineRef line = CFArrayGetValueAtIndex(lines, i);
-                CGPoint origin = origins[i];
-
-                CFRange rangeOfLine = CTLineGetStringRange(line);
-
-                origin.y -= SwiffTextGetMaximumVerticalOffset(as, rangeOfLine);
-
-                CGContextSetTextPosition(context, origin.x, origin.y);
-                
-                CTLineDraw(line, context);
-            }
-            
-            free(origins);
+    command.object = (__bridge CFTypeRef)as;
+    command.rect   = [definition bounds];
 
-            CGContextFlush(context);
-            CGContextRestoreGState(context);
+    sSubmitCommand(state, &command);
 
-            CFRelease(frame);
-        }
-        
-        if (path) CFRelease(path);
-        CFRelease(framesetter);
+    if (state->displayList) {
+        SwiffDisplayListAddPlacedDynamicText(state->displayList, placedDynamicText);
     }
 }
 
 
 static void sDrawPlacedObject(SwiffRenderState *state, SwiffPlacedObject *placedObject)
 {
-    UInt16      placedObjectClipDepth = placedObject->_additional ? [placedObject clipDepth] : 0;
-    UInt16      placedObjectDepth     = placedObject->_depth;
-    BOOL        placedObjectIsHidden  = placedObject->_additional ? [placedObject isHidden] : NO;
-    BOOL        hasColorTransform     = placedObject->_additional ? [placedObject hasColorTransform] : NO;
-    CGBlendMode blendMode             = placedObject->_additional ? [placedObject CGBlendMode] : kCGBlendModeNormal;
+    UInt16         placedObjectClipDepth = placedObject->_additional ? [placedObject clipDepth] : 0;
+    UInt16         placedObjectDepth     = placedObject->_depth;
+    BOOL           placedObjectIsHidden  = placedObject->_additional ? [placedObject isHidden] : NO;
+    BOOL           hasColorTransform     = placedObject->_additional ? [placedObject hasColorTransform] : NO;
+    BOOL           cachesAsBitmap        = placedObject->_additional ? [placedObject cachesAsBitmap] : NO;
+    SwiffBlendMode blendMode             = placedObject->_additional ? [placedObject blendMode] : SwiffBlendModeNormal;
+    NSArray       *filters               = placedObject->_additional ? [placedObject filters] : nil;
+
+    // SWF files may also use 1 for normal
+    if (blendMode == 1) blendMode = SwiffBlendModeNormal;
 
     // If we are in a clipping mask...
     if (state->clipDepth) {
@@ -776,10 +2144,43 @@ static void sDrawPlacedObject(SwiffRenderState *state, SwiffPlacedObject *placed
         }
     }
 
+    // The clipping path refers to clipMaskKey until the end clip path command
+    NS_VALID_UNTIL_END_OF_SCOPE SwiffRenderBitmapKey *clipMaskKey = nil;
+    CGRect maskBounds = CGRectNull;
+
     // The current depth starts a clipping mask
     if (placedObjectClipDepth) {
+        __unsafe_unretained id<SwiffDefinition> maskDefinition = SwiffMovieGetDefinition(state->movie, [placedObject libraryID]);
+
+        CGAffineTransform maskTransform = CGAffineTransformConcat([placedObject affineTransform], state->affineTransform);
+        maskBounds = CGRectApplyAffineTransform([maskDefinition renderBounds], maskTransform);
+
+        CGRect maskRenderBounds = CGRectInset(maskBounds, -state->filterOutset.width, -state->filterOutset.height);
+
+        // The coverage of a mask may be cached, when it is not inside of another mask, and when it will be
+        // drawn and end with an EndClipPath.  Like sliding sprites, it is only cached once seen unchanged
+        if (state->bitmapCache && !state->isBuildingClippingPath && !placedObjectIsHidden && CGRectIntersectsRect(maskRenderBounds, state->clipBoundingBox)) {
+            __unsafe_unretained SwiffTimeline *maskTimeline = nil;
+            if (state->timeline && [maskDefinition isKindOfClass:[SwiffSpriteDefinition class]]) {
+                maskTimeline = [state->timeline timelineForPlacedObject:placedObject];
+            }
+
+            clipMaskKey = [[SwiffRenderBitmapKey alloc] init];
+            clipMaskKey->_libraryID   = [maskDefinition libraryID];
+            clipMaskKey->_frameIndex  = [maskTimeline frameIndex];
+            clipMaskKey->_childFrames = [maskTimeline childFramesSignature];
+            clipMaskKey->_isClipMask  = YES;
+            clipMaskKey->_isAutomatic = YES;
+        }
+
         state->isBuildingClippingPath = YES;
         state->skipUntilClipDepth = YES;
+
+        SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeBeginClipPath);
+        command.transform = maskTransform;
+        command.rect      = [maskDefinition renderBounds];
+        command.cacheKey  = (__bridge CFTypeRef)clipMaskKey;
+        sSubmitCommand(state, &command);
     }
 
     // Bail out if placedObject is hidden
@@ -790,56 +2191,136 @@ static void sDrawPlacedObject(SwiffRenderState *state, SwiffPlacedObject *placed
     __unsafe_unretained // Workaround for <rdar://11044357> clang 3.1 crashes in ObjCARCOpt::runOnFunction()
     id<SwiffDefinition> definition = SwiffMovieGetDefinition(state->movie, [placedObject libraryID]);
 
+    __unsafe_unretained SwiffTimeline *spriteTimeline = nil;
+    if (state->timeline && [definition isKindOfClass:[SwiffSpriteDefinition class]]) {
+        spriteTimeline = [state->timeline timelineForPlacedObject:placedObject];
+    }
+
     CGAffineTransform newTransform = CGAffineTransformConcat([placedObject affineTransform], state->affineTransform);
 
-    // Bail out if renderBounds is not in the clipBoundingBox
+    // Complex sprites are candidates for the bitmap cache when shouldCacheSlidingSprites is on.  sBeginLayer()
+    // only caches them once they are seen to move without changing scale, rotation, or colors
+    BOOL isSlidingSprite = !cachesAsBitmap && state->shouldCacheSlidingSprites &&
+                           [definition isKindOfClass:[SwiffSpriteDefinition class]] &&
+                           (sCountSpritePaths(state, (SwiffSpriteDefinition *)definition, sComplexSpritePathCount) >= sComplexSpritePathCount);
+
+    // Alpha is not cached, as it also affects the parent outside of the placed object
+    BOOL usesBitmapCache = state->bitmapCache && (cachesAsBitmap || isSlidingSprite) && (blendMode != SwiffBlendModeAlpha);
+
+    // Filters, blend modes, and the bitmap cache are drawn through an offscreen layer, so that the placed object
+    // is blended as one isolated group.  They are ignored on clipping masks, as in Flash Player
+    BOOL   usesLayer    = (([filters count] > 0) || (blendMode != SwiffBlendModeNormal) || usesBitmapCache) && !placedObjectClipDepth && !state->isBuildingClippingPath;
+    CGSize filterOutset = state->filterOutset;
+
+    if (usesLayer && [filters count]) {
+        CGSize outset = SwiffFilterListGetOutset(filters, state->baseScale);
+        filterOutset.width  += outset.width;
+        filterOutset.height += outset.height;
+    }
+
+    // Bail out if renderBounds is not in the clipBoundingBox.  It includes the outset of all filters
+    // being drawn, so that content which is only visible through a filter is kept
     CGRect renderBounds = CGRectApplyAffineTransform([definition renderBounds], newTransform);
+    renderBounds = CGRectInset(renderBounds, -filterOutset.width, -filterOutset.height);
+
     if (!CGRectIntersectsRect(renderBounds, state->clipBoundingBox)) {
         return;
     }
 
+    // Also bail out if renderBounds is outside of the active clipping mask.  Masks have no filters, so content
+    // only reaches outside of their bounds through the filters of a layer, which ends the mask (see below)
+    if (state->clipDepth && !state->isBuildingClippingPath && !CGRectIntersectsRect(renderBounds, state->clipMaskBounds)) {
+        state->maskCulledCount++;
+        return;
+    }
+
     CGAffineTransform savedTransform = state->affineTransform;
+    CGRect savedRenderBounds = state->renderBounds;
+    CGSize savedFilterOutset = state->filterOutset;
+    UInt16 savedClipDepth = state->clipDepth;
+    CGRect savedClipMaskBounds = state->clipMaskBounds;
+    BOOL   savedSkipUntilClipDepth = state->skipUntilClipDepth;
+
     state->affineTransform = newTransform;
+    state->renderBounds = renderBounds;
+    state->filterOutset = filterOutset;
 
     if (hasColorTransform) {
         sPushColorTransform(state, [placedObject colorTransformPointer]);
     }
 
-    //!issue7: non-CG blend modes
-    if (blendMode != kCGBlendModeNormal) {
-        CGContextSaveGState(state->context);
-        CGContextSetBlendMode(state->context, blendMode);
+    // The layer refers to cacheKey until the end layer command, which is executed here when drawing directly
+    NS_VALID_UNTIL_END_OF_SCOPE SwiffRenderBitmapKey *cacheKey = nil;
+
+    if (usesLayer) {
+        if (usesBitmapCache) {
+            cacheKey = [[SwiffRenderBitmapKey alloc] init];
+            cacheKey->_libraryID              = [definition libraryID];
+            cacheKey->_colorTransform         = state->colorTransform;
+            cacheKey->_colorModificationBlock = state->colorModificationBlock;
+            cacheKey->_filters                = filters;
+            cacheKey->_frameIndex             = [spriteTimeline frameIndex];
+            cacheKey->_childFrames            = [spriteTimeline childFramesSignature];
+            cacheKey->_isAutomatic            = !cachesAsBitmap;
+        }
+
+        SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeBeginLayer);
+        command.object   = (__bridge CFTypeRef)filters;
+        command.rect     = [definition renderBounds];
+        command.cacheKey = (__bridge CFTypeRef)cacheKey;
+        command.layerBlendMode = blendMode;
+        sSubmitCommand(state, &command);
+
+        // Clipping masks inside of the layer must end with it
+        state->clipDepth = 0;
+        state->skipUntilClipDepth = NO;
     }
 
-    if ([definition isKindOfClass:[SwiffDynamicTextDefinition class]]) {
-        if ([placedObject isKindOfClass:[SwiffPlacedDynamicText class]]) {
-            sDrawPlacedDynamicText(state, (SwiffPlacedDynamicText *)placedObject);
+    // When drawing directly, a layer or clipping path drawn from the bitmap cache skips its contents
+    if (!state->skippedLayersCount && !state->skippedClipPathsCount) {
+        if ([definition isKindOfClass:[SwiffDynamicTextDefinition class]]) {
+            // Dynamic text is laid out and drawn by Core Text, which the rasterizer cannot use
+            if (!state->rasterizer && [placedObject isKindOfClass:[SwiffPlacedDynamicText class]]) {
+                sDrawPlacedDynamicText(state, (SwiffPlacedDynamicText *)placedObject);
+            }
+
+        } else if ([definition isKindOfClass:[SwiffShapeDefinition class]]) {
+            sDrawShapeDefinition(state, (SwiffShapeDefinition *)definition);
+
+        } else if ([definition isKindOfClass:[SwiffSpriteDefinition class]]) {
+            sDrawSpriteDefinition(state, (SwiffSpriteDefinition *)definition, spriteTimeline);
+
+        } else if ([definition isKindOfClass:[SwiffStaticTextDefinition class]]) {
+            sDrawStaticTextDefinition(state, (SwiffStaticTextDefinition *)definition);
         }
+    }
 
-    } else if ([definition isKindOfClass:[SwiffShapeDefinition class]]) {
-        sDrawShapeDefinition(state, (SwiffShapeDefinition *)definition);
+    if (usesLayer) {
+        sStopClipping(state);
 
-    } else if ([definition isKindOfClass:[SwiffSpriteDefinition class]]) {
-        sDrawSpriteDefinition(state, (SwiffSpriteDefinition *)definition);
+        state->clipDepth = savedClipDepth;
+        state->clipMaskBounds = savedClipMaskBounds;
+        state->skipUntilClipDepth = savedSkipUntilClipDepth;
 
-    } else if ([definition isKindOfClass:[SwiffStaticTextDefinition class]]) {
-        sDrawStaticTextDefinition(state, (SwiffStaticTextDefinition *)definition);
+        SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeEndLayer);
+        sSubmitCommand(state, &command);
     }
 
     if (hasColorTransform) {
         sPopColorTransform(state);
     }
-    
-    if (blendMode != kCGBlendModeNormal) {
-        CGContextRestoreGState(state->context);
-    }
 
     state->affineTransform = savedTransform;
+    state->renderBounds = savedRenderBounds;
+    state->filterOutset = savedFilterOutset;
 
     if (placedObjectClipDepth) {
-        sStartClipping(state, placedObjectClipDepth);
+        sStartClipping(state, placedObjectClipDepth, maskBounds);
         state->isBuildingClippingPath = NO;
         state->skipUntilClipDepth = NO;
+
+        SwiffDisplayListCommand command = sMakeCommand(state, SwiffDisplayListCommandTypeEndClipPath);
+        sSubmitCommand(state, &command);
     }
 }
 
@@ -850,7 +2331,9 @@ static void sDrawPlacedObject(SwiffRenderState *state, SwiffPlacedObject *placed
 @implementation SwiffRenderer {
     CGAffineTransform _baseAffineTransform;
     SwiffColor        _multiplyColor;
+    SwiffColorTransform _colorModificationTransform;
     BOOL              _hasBaseAffineTransform;
+    BOOL              _hasColorModificationTransform;
     BOOL              _hasMultiplyColor;
 }
 
@@ -867,57 +2350,304 @@ static void sDrawPlacedObject(SwiffRenderState *state, SwiffPlacedObject *placed
 }
 
 
-- (void) renderPlacedObjects:(NSArray *)placedObjects inContext:(CGContextRef)context
+- (void) dealloc
 {
-    SwiffRenderState state;
-    memset(&state, 0, sizeof(SwiffRenderState));
+    // See -setColorModificationBlock:
+    if (_colorModificationBlock) [_bitmapCache removeAllPixels];
+}
+
+
+- (void) _setupRenderState:(SwiffRenderState *)state
+{
+    memset(state, 0, sizeof(SwiffRenderState));
+
+    state->movie = _movie;
+    state->colorModificationBlock = _colorModificationBlock;
 
-    state.movie   = _movie;
-    state.context = context;
-    state.colorModificationBlock = _colorModificationBlock;
+    state->colorModificationTransform    = _colorModificationTransform;
+    state->hasColorModificationTransform = _hasColorModificationTransform;
+    sUpdateColorTransform(state);
 
     if (_hasBaseAffineTransform) {
-        state.affineTransform = _baseAffineTransform;
+        state->affineTransform = _baseAffineTransform;
     } else {
-        state.affineTransform = CGAffineTransformIdentity;
+        state->affineTransform = CGAffineTransformIdentity;
     }
 
-    state.ceilX = CGContextGetCTM(context).a < 0;
-    state.ceilY = CGContextGetCTM(context).d > 0;
-    state.hairlineWidth     = _hairlineWidth ? _hairlineWidth : 1.0;
-    state.fillHairlineWidth = _fillHairlineWidth;
-    state.scaleFactorHint   = _scaleFactorHint;
-    state.clipBoundingBox   = CGContextGetClipBoundingBox(context);
+    state->baseScale = sqrt(fabs((state->affineTransform.a * state->affineTransform.d) - (state->affineTransform.b * state->affineTransform.c)));
 
-    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    state->hairlineWidth     = _hairlineWidth ? _hairlineWidth : 1.0;
+    state->fillHairlineWidth = _fillHairlineWidth;
+    state->scaleFactorHint   = _scaleFactorHint;
 
-    CGContextSetInterpolationQuality(context, kCGInterpolationDefault);
+    state->shouldAntialias             = _shouldAntialias;
+    state->shouldSmoothFonts           = _shouldSmoothFonts;
+    state->shouldSubpixelPositionFonts = _shouldSubpixelPositionFonts;
+    state->shouldSubpixelQuantizeFonts = _shouldSubpixelQuantizeFonts;
 
-    CGContextSetShouldAntialias(context, _shouldAntialias);
-    CGContextSetShouldSmoothFonts(context, _shouldSmoothFonts);
-    CGContextSetShouldSubpixelPositionFonts(context, _shouldSubpixelPositionFonts);
-    CGContextSetShouldSubpixelQuantizeFonts(context, _shouldSubpixelQuantizeFonts);
+    state->bitmapCache               = _bitmapCache;
+    state->shouldCacheSlidingSprites = _shouldCacheSlidingSprites;
+    state->timeline                  = _timeline;
+}
 
-    CGContextSetLineCap(context, kCGLineCapRound);
-    CGContextSetLineJoin(context, kCGLineJoinRound);
-    CGContextSetFillColorSpace(context, colorSpace);
-    CGContextSetStrokeColorSpace(context, colorSpace);
 
-    CGColorSpaceRelease(colorSpace);
+- (void) _setupRenderState:(SwiffRenderState *)state withContext:(CGContextRef)context
+{
+    [self _setupRenderState:state];
+
+    state->context = context;
+    state->ceilX = CGContextGetCTM(context).a < 0;
+    state->ceilY = CGContextGetCTM(context).d > 0;
+    state->clipBoundingBox = CGContextGetClipBoundingBox(context);
 
+    sSetupContext(state, context);
+}
+
+
+- (void) _teardownRenderState:(SwiffRenderState *)state
+{
+    sDiscardLayers(state);
+    sEndClipMask(state);
+
+    state->movie   = nil;
+    state->context = NULL;
+    state->displayList = nil;
+    state->bitmapCache = nil;
+    state->timeline    = nil;
+    state->colorModificationBlock = NULL;
+    
+    if (state->points) {
+        free(state->points);
+        state->points = NULL;
+    }
+
+    if (state->snappedPoints) {
+        free(state->snappedPoints);
+        state->snappedPoints = NULL;
+    }
+
+    if (state->bitmapPixels) {
+        CFRelease(state->bitmapPixels);
+        state->bitmapPixels = NULL;
+    }
+
+    if (state->colorTransforms) {
+        free(state->colorTransforms);
+        state->colorTransforms = NULL;
+    }
+}
+
+
+- (void) _drawPlacedObjects:(NSArray *)placedObjects withRenderState:(SwiffRenderState *)state
+{
     for (SwiffPlacedObject *object in placedObjects) {
-        sDrawPlacedObject(&state, object);
+        sDrawPlacedObject(state, object);
     }
 
-    sStopClipping(&state);
+    sStopClipping(state);
 
-    state.movie   = nil;
-    state.context = NULL;
-    state.colorModificationBlock = NULL;
-    
-    if (state.colorTransforms) {
-        CFRelease(state.colorTransforms);
+    _maskCulledCount += state->maskCulledCount;
+
+    [self _teardownRenderState:state];
+}
+
+
+// Returns the index of the end layer command which matches the begin layer command at index
+static NSUInteger sGetEndLayerIndex(const SwiffDisplayListCommand *commands, NSUInteger commandsCount, NSUInteger index)
+{
+    NSUInteger depth = 0;
+
+    for ( ; index < commandsCount; index++) {
+        SwiffDisplayListCommandType type = commands[index].type;
+
+        if (type == SwiffDisplayListCommandTypeBeginLayer) {
+            depth++;
+        } else if ((type == SwiffDisplayListCommandTypeEndLayer) && (--depth == 0)) {
+            break;
+        }
+    }
+
+    return index;
+}
+
+
+// Replays displayList with the base transform followed by a translation of -offset
+- (void) _drawDisplayList:(SwiffDisplayList *)displayList withRenderState:(SwiffRenderState *)state offset:(CGPoint)offset
+{
+    const SwiffDisplayListCommand *commands = [displayList commands];
+    NSUInteger commandsCount = [displayList commandsCount];
+
+    CGAffineTransform base    = _hasBaseAffineTransform ? _baseAffineTransform : CGAffineTransformIdentity;
+    BOOL              hasBase = _hasBaseAffineTransform || !CGPointEqualToPoint(offset, CGPointZero);
+
+    base = CGAffineTransformConcat(base, CGAffineTransformMakeTranslation(-offset.x, -offset.y));
+
+    // Bitmaps are looked up in the movie which the display list was recorded from
+    state->movie = [displayList movie];
+
+    for (NSUInteger i = 0; i < commandsCount; i++) {
+        const SwiffDisplayListCommand *command = &commands[i];
+
+        // Skip drawing commands outside of the clip bounding box.  A layer outside of it is skipped
+        // together with its contents, up to the matching end layer command, so that partial redraws
+        // do not set up offscreen layers or run filters for unseen objects.  Clip and blend commands
+        // are always executed, as they come in pairs
+        BOOL isBeginLayer = (command->type == SwiffDisplayListCommandTypeBeginLayer);
+
+        if ((command->type <= SwiffDisplayListCommandTypeDrawText) || isBeginLayer) {
+            CGRect bounds = hasBase ? CGRectApplyAffineTransform(command->bounds, base) : command->bounds;
+
+            if (!CGRectIntersectsRect(bounds, state->clipBoundingBox)) {
+                if (isBeginLayer) i = sGetEndLayerIndex(commands, commandsCount, i);
+                continue;
+            }
+        }
+
+        if (hasBase) {
+            state->affineTransform = CGAffineTransformConcat(command->transform, base);
+        } else {
+            state->affineTransform = command->transform;
+        }
+
+        sExecuteCommand(state, command);
     }
+
+    [self _teardownRenderState:state];
+}
+
+
+- (void) _drawDisplayList:(SwiffDisplayList *)displayList withRenderState:(SwiffRenderState *)state
+{
+    [self _drawDisplayList:displayList withRenderState:state offset:CGPointZero];
+}
+
+
+- (void) renderPlacedObjects:(NSArray *)placedObjects inContext:(CGContextRef)context
+{
+    SwiffRenderState state;
+    [self _setupRenderState:&state withContext:context];
+    [self _drawPlacedObjects:placedObjects withRenderState:&state];
+}
+
+
+- (void) renderPlacedObjects:(NSArray *)placedObjects intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow
+{
+    SwiffRasterizer *rasterizer = SwiffRasterizerCreate(buffer, width, height, bytesPerRow);
+    if (!rasterizer) return;
+
+    SwiffRenderState state;
+    [self _setupRenderState:&state];
+
+    state.rasterizer = rasterizer;
+    state.clipBoundingBox = CGRectMake(0, 0, width, height);
+
+    [self _drawPlacedObjects:placedObjects withRenderState:&state];
+
+    SwiffRasterizerFree(rasterizer);
+}
+
+
+- (SwiffDisplayList *) displayListForPlacedObjects:(NSArray *)placedObjects
+{
+    SwiffDisplayList *displayList = [[SwiffDisplayList alloc] initWithMovie:_movie colorModificationTransform:[self colorModificationTransform] colorModificationBlock:_colorModificationBlock];
+
+    SwiffRenderState state;
+    [self _setupRenderState:&state];
+
+    // The base transform is applied on replay, and the target's clip bounds are unknown
+    state.displayList = displayList;
+    state.affineTransform = CGAffineTransformIdentity;
+    state.baseScale = 1.0;
+    state.clipBoundingBox = CGRectInfinite;
+
+    [self _drawPlacedObjects:placedObjects withRenderState:&state];
+
+    return displayList;
+}
+
+
+- (void) renderDisplayList:(SwiffDisplayList *)displayList inContext:(CGContextRef)context
+{
+    SwiffRenderState state;
+    [self _setupRenderState:&state withContext:context];
+    [self _drawDisplayList:displayList withRenderState:&state];
+}
+
+
+- (void) renderDisplayList:(SwiffDisplayList *)displayList intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow
+{
+    SwiffRasterizer *rasterizer = SwiffRasterizerCreate(buffer, width, height, bytesPerRow);
+    if (!rasterizer) return;
+
+    SwiffRenderState state;
+    [self _setupRenderState:&state];
+
+    state.rasterizer = rasterizer;
+    state.clipBoundingBox = CGRectMake(0, 0, width, height);
+
+    [self _drawDisplayList:displayList withRenderState:&state];
+
+    SwiffRasterizerFree(rasterizer);
+}
+
+
+- (void) renderPlacedObjects:(NSArray *)placedObjects intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow tileSize:(size_t)tileSize
+{
+    SwiffDisplayList *displayList = [self displayListForPlacedObjects:placedObjects];
+    [self renderDisplayList:displayList intoBuffer:buffer width:width height:height bytesPerRow:bytesPerRow tileSize:tileSize];
+}
+
+
+- (void) renderDisplayList:(SwiffDisplayList *)displayList intoBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow tileSize:(size_t)tileSize
+{
+    if (!buffer || !width || !height) return;
+    if (!tileSize) tileSize = sDefaultTileSize;
+
+    // Decode all bitmaps up front, so that the tiles share them and never touch the movie
+    SwiffRenderState prepareState;
+    [self _setupRenderState:&prepareState];
+    prepareState.movie = [displayList movie];
+
+    sPrepareBitmapPixels(&prepareState, displayList);
+
+    CFMutableDictionaryRef bitmapPixels = prepareState.bitmapPixels;
+    if (bitmapPixels) CFRetain(bitmapPixels);
+
+    [self _teardownRenderState:&prepareState];
+
+    size_t columns = (width  + tileSize - 1) / tileSize;
+    size_t rows    = (height + tileSize - 1) / tileSize;
+
+    // Each tile has its own render state and rasterizer, writing to a disjoint part of buffer
+    dispatch_apply(columns * rows, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        @autoreleasepool {
+            size_t x = (i % columns) * tileSize;
+            size_t y = (i / columns) * tileSize;
+            size_t tileWidth  = MIN(tileSize, width  - x);
+            size_t tileHeight = MIN(tileSize, height - y);
+
+            UInt8 *tilePixels = (UInt8 *)buffer + (y * bytesPerRow) + (x * 4);
+
+            SwiffRasterizer *rasterizer = SwiffRasterizerCreate(tilePixels, tileWidth, tileHeight, bytesPerRow);
+            if (!rasterizer) return;
+
+            SwiffRenderState state;
+            [self _setupRenderState:&state];
+
+            state.rasterizer = rasterizer;
+            state.bitmapPixels = bitmapPixels ? (CFMutableDictionaryRef)CFRetain(bitmapPixels) : NULL;
+            state.clipBoundingBox = CGRectMake(0, 0, tileWidth, tileHeight);
+
+            // SwiffBitmapCache is not thread-safe, and cached pixels would cover more than one tile
+            state.bitmapCache = nil;
+
+            [self _drawDisplayList:displayList withRenderState:&state offset:CGPointMake(x, y)];
+
+            SwiffRasterizerFree(rasterizer);
+        }
+    });
+
+    if (bitmapPixels) CFRelease(bitmapPixels);
 }
 
 
@@ -942,5 +2672,38 @@ static void sDrawPlacedObject(SwiffRenderState *state, SwiffPlacedObject *placed
 }
 
 
+// Bitmap cache keys refer to the block without retaining it, so that the cache (usually owned by the movie) does
+// not keep the block and everything it captures alive.  Once the block may be freed, its address may be reused
+// by another block, so the pixels cached with it are removed
+- (void) setColorModificationBlock:(SwiffColorModificationBlock)block
+{
+    if (block != _colorModificationBlock) {
+        if (_colorModificationBlock) [_bitmapCache removeAllPixels];
+        _colorModificationBlock = [block copy];
+    }
+}
+
+
+- (void) setColorModificationTransform:(SwiffColorTransform *)transform
+{
+    if (transform && !SwiffColorTransformIsIdentity(transform)) {
+        _colorModificationTransform = *transform;
+        _hasColorModificationTransform = YES;
+    } else {
+        _hasColorModificationTransform = NO;
+    }
+}
+
+
+- (SwiffColorTransform *) colorModificationTransform
+{
+    if (_hasColorModificationTransform) {
+        return &_colorModificationTransform;
+    } else {
+        return NULL;
+    }
+}
+
+
 @end
 
@@ -39,4 +39,7 @@
 - (void) applyLabelsToFrames:(NSArray *)frames;
 - (NSArray *) scenesForFrames:(NSArray *)frames;
 
+@property (nonatomic, strong, readonly) NSDictionary *offsetToSceneNameMap;   // NSNumber -> NSString
+@property (nonatomic, strong, readonly) NSDictionary *numberToFrameLabelMap;  // NSNumber -> NSString
+
 @end
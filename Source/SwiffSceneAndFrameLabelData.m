@@ -37,11 +37,12 @@
 
 
 @implementation SwiffSceneAndFrameLabelData {
-    SwiffMovie   *_movie;
-    NSDictionary *_offsetToSceneNameMap;
-    NSDictionary *_numberToFrameLabelMap;
+    SwiffMovie *_movie;
 }
 
+@synthesize offsetToSceneNameMap  = _offsetToSceneNameMap,
+            numberToFrameLabelMap = _numberToFrameLabelMap;
+
 
 - (id) initWithParser:(SwiffParser *)parser movie:(SwiffMovie *)movie
 {
@@ -42,6 +42,13 @@
 
 @property (nonatomic, strong, readonly) NSArray *paths;
 
+// Edges waiting for -paths, the memory used by their packed storage, and the memory which the same edges
+// take while -paths expands them into shape operations (the storage used before edges were packed).
+// All are zero once -paths has been built
+@property (nonatomic, assign, readonly) NSUInteger edgeCount;
+@property (nonatomic, assign, readonly) NSUInteger edgeByteCount;
+@property (nonatomic, assign, readonly) NSUInteger unpackedEdgeByteCount;
+
 @property (nonatomic, assign, readonly) BOOL usesFillWindingRule;
 @property (nonatomic, assign, readonly) BOOL usesNonScalingStrokes;
 @property (nonatomic, assign, readonly) BOOL usesScalingStrokes;
@@ -52,31 +52,383 @@ typedef struct SwiffShapeOperation {
 } SwiffShapeOperation;
 
 
+// Edges are stored packed until the paths are first requested.  Each edge is a flags byte
+// followed by 16-bit (or, with SwiffShapeEdgeFlagWide, 32-bit) twip deltas:
+//
+//     [move dx, dy]       if SwiffShapeEdgeFlagMove, relative to the end of the previous edge
+//     [control dx, dy]    if SwiffShapeEdgeFlagCurve, relative to the start of the edge
+//     anchor dx, dy       relative to the control point (curves) or the start (lines)
+//
+// An edge with both fill styles is stored once.  Style indices live in a side table of runs.
+//
+enum {
+    SwiffShapeEdgeFlagCurve = 1 << 0,
+    SwiffShapeEdgeFlagWide  = 1 << 1,
+    SwiffShapeEdgeFlagMove  = 1 << 2
+};
+
+
+typedef struct SwiffShapeStyleRun {
+    NSUInteger edgeIndex;       // Index of the first edge using these styles
+    UInt16     fillStyleIndex0;
+    UInt16     fillStyleIndex1;
+    UInt16     lineStyleIndex;
+} SwiffShapeStyleRun;
+
+
+typedef struct SwiffShapeEdgeGroup {
+    UInt8              *bytes;
+    NSUInteger          length;
+    NSUInteger          capacity;
+    NSUInteger          edgeCount;
+    NSUInteger          operationCount;     // Edges plus those needing a reversed SwiffShapeOperation for fill style 1
+    SwiffPoint          position;
+    SwiffShapeStyleRun *runs;
+    NSUInteger          runCount;
+    NSUInteger          runCapacity;
+} SwiffShapeEdgeGroup;
+
+
+static void sEdgeGroupFree(SwiffShapeEdgeGroup *group)
+{
+    free(group->bytes);
+    free(group->runs);
+    free(group);
+}
+
+
+static void sEdgeGroupAppendDelta(SwiffShapeEdgeGroup *group, SwiffTwips delta, BOOL isWide)
+{
+    if (isWide) {
+        SInt32 value = OSSwapHostToLittleInt32((SInt32)delta);
+        memcpy(group->bytes + group->length, &value, sizeof(value));
+        group->length += sizeof(value);
+    } else {
+        SInt16 value = OSSwapHostToLittleInt16((SInt16)delta);
+        memcpy(group->bytes + group->length, &value, sizeof(value));
+        group->length += sizeof(value);
+    }
+}
+
+
+static void sEdgeGroupAddEdge(
+    SwiffShapeEdgeGroup *group, SwiffShapeOperationType type,
+    SwiffPoint from, SwiffPoint control, SwiffPoint to,
+    UInt16 fillStyleIndex0, UInt16 fillStyleIndex1, UInt16 lineStyleIndex
+) {
+    SwiffShapeStyleRun *lastRun = group->runCount ? &group->runs[group->runCount - 1] : NULL;
+
+    if (!lastRun ||
+        (lastRun->fillStyleIndex0 != fillStyleIndex0) ||
+        (lastRun->fillStyleIndex1 != fillStyleIndex1) ||
+        (lastRun->lineStyleIndex  != lineStyleIndex))
+    {
+        if (group->runCount == group->runCapacity) {
+            group->runCapacity = group->runCapacity ? (group->runCapacity * 2) : 4;
+            group->runs = realloc(group->runs, group->runCapacity * sizeof(SwiffShapeStyleRun));
+        }
+
+        SwiffShapeStyleRun *run = &group->runs[group->runCount++];
+        run->edgeIndex       = group->edgeCount;
+        run->fillStyleIndex0 = fillStyleIndex0;
+        run->fillStyleIndex1 = fillStyleIndex1;
+        run->lineStyleIndex  = lineStyleIndex;
+    }
+
+    BOOL isMove  = (from.x != group->position.x) || (from.y != group->position.y);
+    BOOL isCurve = (type == SwiffShapeOperationTypeCurve);
+
+    SwiffTwips deltas[6];
+    NSInteger  deltaCount = 0;
+
+    if (isMove) {
+        deltas[deltaCount++] = from.x - group->position.x;
+        deltas[deltaCount++] = from.y - group->position.y;
+    }
+
+    if (isCurve) {
+        deltas[deltaCount++] = control.x - from.x;
+        deltas[deltaCount++] = control.y - from.y;
+        deltas[deltaCount++] = to.x - control.x;
+        deltas[deltaCount++] = to.y - control.y;
+    } else {
+        deltas[deltaCount++] = to.x - from.x;
+        deltas[deltaCount++] = to.y - from.y;
+    }
+
+    BOOL isWide = NO;
+    for (NSInteger i = 0; i < deltaCount; i++) {
+        if ((deltas[i] < INT16_MIN) || (deltas[i] > INT16_MAX)) {
+            isWide = YES;
+            break;
+        }
+    }
+
+    NSUInteger needed = 1 + (deltaCount * (isWide ? sizeof(SInt32) : sizeof(SInt16)));
+
+    if ((group->length + needed) > group->capacity) {
+        group->capacity = MAX(group->capacity * 2, 64);
+        group->bytes = realloc(group->bytes, group->capacity);
+    }
+
+    group->bytes[group->length++] = (isCurve ? SwiffShapeEdgeFlagCurve : 0) |
+                                    (isWide  ? SwiffShapeEdgeFlagWide  : 0) |
+                                    (isMove  ? SwiffShapeEdgeFlagMove  : 0);
+
+    for (NSInteger i = 0; i < deltaCount; i++) {
+        sEdgeGroupAppendDelta(group, deltas[i], isWide);
+    }
+
+    group->position = to;
+    group->edgeCount++;
+    group->operationCount += fillStyleIndex1 ? 2 : 1;
+}
+
+
+static SwiffTwips sEdgeGroupReadDelta(const UInt8 **inOutBytes, BOOL isWide)
+{
+    const UInt8 *bytes = *inOutBytes;
+    SwiffTwips result;
+
+    if (isWide) {
+        SInt32 value;
+        memcpy(&value, bytes, sizeof(value));
+        result = (SInt32)OSSwapLittleToHostInt32(value);
+        *inOutBytes = bytes + sizeof(value);
+    } else {
+        SInt16 value;
+        memcpy(&value, bytes, sizeof(value));
+        result = (SInt16)OSSwapLittleToHostInt16(value);
+        *inOutBytes = bytes + sizeof(value);
+    }
+
+    return result;
+}
+
+
+// Returns a malloc'd array of operations terminated by SwiffShapeOperationTypeEnd.  Each edge
+// with a fill style 1 is followed by its reversed duplicate, as the path builders expect
+//
+static SwiffShapeOperation *sEdgeGroupCreateOperations(SwiffShapeEdgeGroup *group)
+{
+    SwiffShapeOperation *operations = malloc((group->operationCount + 1) * sizeof(SwiffShapeOperation));
+    SwiffShapeOperation *o = operations;
+
+    const UInt8 *bytes = group->bytes;
+    SwiffPoint position = { 0, 0 };
+
+    NSUInteger runIndex = 0;
+    SwiffShapeStyleRun *run = group->runs;
+
+    for (NSUInteger edgeIndex = 0; edgeIndex < group->edgeCount; edgeIndex++) {
+        while (((runIndex + 1) < group->runCount) && (group->runs[runIndex + 1].edgeIndex <= edgeIndex)) {
+            run = &group->runs[++runIndex];
+        }
+
+        UInt8 flags  = *bytes++;
+        BOOL  isWide = (flags & SwiffShapeEdgeFlagWide) > 0;
+
+        SwiffPoint from = position;
+        SwiffPoint control = { 0, 0 };
+        SwiffPoint to;
+
+        if (flags & SwiffShapeEdgeFlagMove) {
+            from.x += sEdgeGroupReadDelta(&bytes, isWide);
+            from.y += sEdgeGroupReadDelta(&bytes, isWide);
+        }
+
+        if (flags & SwiffShapeEdgeFlagCurve) {
+            control.x = from.x + sEdgeGroupReadDelta(&bytes, isWide);
+            control.y = from.y + sEdgeGroupReadDelta(&bytes, isWide);
+            to.x = control.x + sEdgeGroupReadDelta(&bytes, isWide);
+            to.y = control.y + sEdgeGroupReadDelta(&bytes, isWide);
+        } else {
+            to.x = from.x + sEdgeGroupReadDelta(&bytes, isWide);
+            to.y = from.y + sEdgeGroupReadDelta(&bytes, isWide);
+        }
+
+        SwiffShapeOperationType type = (flags & SwiffShapeEdgeFlagCurve) ? SwiffShapeOperationTypeCurve : SwiffShapeOperationTypeLine;
+
+        o->type           = type;
+        o->duplicate      = NO;
+        o->fromPoint      = from;
+        o->controlPoint   = control;
+        o->toPoint        = to;
+        o->fillStyleIndex = run->fillStyleIndex0;
+        o->lineStyleIndex = run->lineStyleIndex;
+        o++;
+
+        if (run->fillStyleIndex1) {
+            o->type           = type;
+            o->duplicate      = YES;
+            o->fromPoint      = to;
+            o->controlPoint   = control;
+            o->toPoint        = from;
+            o->fillStyleIndex = run->fillStyleIndex1;
+            o->lineStyleIndex = run->lineStyleIndex;
+            o++;
+        }
+
+        position = to;
+    }
+
+    o->type = SwiffShapeOperationTypeEnd;
+    o->fillStyleIndex = UINT16_MAX;
+    o->lineStyleIndex = UINT16_MAX;
+
+    return operations;
+}
+
+
 static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, SwiffPoint *position)
 {
     if ((op->fromPoint.x != position->x) ||
         (op->fromPoint.y != position->y))
     {
-        SwiffPathAddOperationAndTwips(path, SwiffPathOperationMove, op->fromPoint.x, op->fromPoint.y);
+        SwiffPathAddMove(path, op->fromPoint);
     }
     
     if (op->type == SwiffShapeOperationTypeLine) {
         if (op->fromPoint.x == op->toPoint.x) {
-            SwiffPathAddOperationAndTwips(path, SwiffPathOperationVerticalLine, op->toPoint.y);
+            SwiffPathAddVerticalLine(path, op->toPoint);
             
         } else if (op->fromPoint.y == op->toPoint.y) {
-            SwiffPathAddOperationAndTwips(path, SwiffPathOperationHorizontalLine, op->toPoint.x);
+            SwiffPathAddHorizontalLine(path, op->toPoint);
         
         } else {
-            SwiffPathAddOperationAndTwips(path, SwiffPathOperationLine, op->toPoint.x, op->toPoint.y);
+            SwiffPathAddLine(path, op->toPoint);
         }
     
     } else if (op->type == SwiffShapeOperationTypeCurve) {
-        SwiffPathAddOperationAndTwips(path, SwiffPathOperationCurve, op->toPoint.x, op->toPoint.y, op->controlPoint.x, op->controlPoint.y);
+        SwiffPathAddCurve(path, op->toPoint, op->controlPoint);
     }
     
     *position = op->toPoint;
 }
+
+
+// Sizes path for operationCount shape operations: at most a move and a curve (three points) each,
+// plus the two end operations.  SwiffPathAddOperationEnd() trims the excess.
+static void sPathReserveForShapeOperations(SwiffPath *path, NSUInteger operationCount)
+{
+    SwiffPathReserveCapacity(path, (operationCount * 2) + 2, operationCount * 3);
+}
+
+
+// Maps a fromPoint to the lowest index (in file order) of the remaining operations starting there.
+// Operations with the same fromPoint are chained through next[] in ascending order.
+//
+typedef struct SwiffShapeEndpointSlot {
+    SwiffPoint point;
+    CFIndex    head;
+    BOOL       isUsed;
+} SwiffShapeEndpointSlot;
+
+
+static SwiffShapeEndpointSlot *sGetEndpointSlot(SwiffShapeEndpointSlot *slots, NSUInteger mask, SwiffPoint point, BOOL insert)
+{
+    NSUInteger hash = ((NSUInteger)point.x * 73856093) ^ ((NSUInteger)point.y * 19349663);
+    NSUInteger i    = hash & mask;
+
+    while (slots[i].isUsed) {
+        if ((slots[i].point.x == point.x) && (slots[i].point.y == point.y)) {
+            return &slots[i];
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    if (!insert) return NULL;
+
+    slots[i].isUsed = YES;
+    slots[i].point  = point;
+    slots[i].head   = kCFNotFound;
+
+    return &slots[i];
+}
+
+
+// Reorders operations (in file order) so that connecting edges are adjacent.  Each step takes the
+// first remaining operation starting at the current end point.  If there is none, remaining operations
+// are taken in file order, prepending those which end at the start of the first operation.
+//
+static void sSortFillOperations(SwiffShapeOperation **operations, CFIndex count)
+{
+    NSUInteger capacity = 16;
+    while (capacity < (NSUInteger)(count * 2)) capacity <<= 1;
+
+    SwiffShapeEndpointSlot *slots    = calloc(capacity, sizeof(SwiffShapeEndpointSlot));
+    CFIndex                *next     = malloc(count * sizeof(CFIndex));
+    BOOL                   *isUsed   = calloc(count, sizeof(BOOL));
+    SwiffShapeOperation   **prepends = malloc(count * sizeof(SwiffShapeOperation *));
+    SwiffShapeOperation   **appends  = malloc(count * sizeof(SwiffShapeOperation *));
+    CFIndex prependCount = 0;
+    CFIndex appendCount  = 0;
+
+    for (CFIndex i = count - 1; i >= 0; i--) {
+        SwiffShapeEndpointSlot *slot = sGetEndpointSlot(slots, capacity - 1, operations[i]->fromPoint, YES);
+        next[i] = slot->head;
+        slot->head = i;
+    }
+
+    SwiffShapeOperation *currentOperation = operations[0];
+    SwiffShapeOperation *firstOperation   = currentOperation;
+    CFIndex remaining = count - 1;
+    CFIndex cursor    = 0;
+
+    isUsed[0] = YES;
+    appends[appendCount++] = currentOperation;
+
+    while (remaining > 0) {
+        SwiffShapeEndpointSlot *slot = sGetEndpointSlot(slots, capacity - 1, currentOperation->toPoint, NO);
+        CFIndex found = kCFNotFound;
+
+        if (slot) {
+            CFIndex head = slot->head;
+            while ((head != kCFNotFound) && isUsed[head]) head = next[head];
+            slot->head = found = head;
+        }
+
+        if (found != kCFNotFound) {
+            currentOperation = operations[found];
+            isUsed[found] = YES;
+            remaining--;
+
+            appends[appendCount++] = currentOperation;
+
+        } else {
+            while (remaining > 0) {
+                while (isUsed[cursor]) cursor++;
+
+                currentOperation = operations[cursor];
+                isUsed[cursor] = YES;
+                remaining--;
+
+                SwiffPoint point1 = firstOperation->fromPoint;
+                SwiffPoint point2 = currentOperation->toPoint;
+
+                if ((point1.x == point2.x) && (point1.y == point2.y)) {
+                    prepends[prependCount++] = currentOperation;
+                    firstOperation = currentOperation;
+
+                } else {
+                    appends[appendCount++] = currentOperation;
+                    break;
+                }
+            }
+        }
+    }
+
+    CFIndex o = 0;
+    for (CFIndex i = prependCount - 1; i >= 0; i--) operations[o++] = prepends[i];
+    for (CFIndex i = 0; i < appendCount; i++)       operations[o++] = appends[i];
+
+    free(slots);
+    free(next);
+    free(isUsed);
+    free(prepends);
+    free(appends);
+}
  
 
 @implementation SwiffShapeDefinition {
@@ -139,9 +491,7 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
         NSMutableArray *fillStyles = [[NSMutableArray alloc] init];
         NSMutableArray *lineStyles = [[NSMutableArray alloc] init];
 
-        __block SwiffShapeOperation *operations = NULL;
-        __block NSUInteger operationsCount = 0;
-        __block NSUInteger operationsCapacity = 0;
+        __block SwiffShapeEdgeGroup *group = NULL;
         __block CGFloat maxWidth = 0.0;
 
         CFMutableArrayRef groups = CFArrayCreateMutable(NULL, 0, NULL);
@@ -166,46 +516,20 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
             [lineStyles addObjectsFromArray:moreLineStyles];
         };
         
-        SwiffShapeOperation *(^nextOperation)() = ^{
-            if (operationsCount == operationsCapacity) {
-                operationsCapacity *= 2;
-                if (!operationsCapacity) operationsCapacity = 32;
-                operations = realloc(operations, operationsCapacity * sizeof(SwiffShapeOperation));
+        void (^endGroup)() = ^{
+            if (group) {
+                // Release the growth slack, the group lives until -paths is first called
+                group->bytes = realloc(group->bytes, group->length);
+                group->capacity = group->length;
+
+                CFArrayAppendValue(groups, group);
+                group = NULL;
             }
-    
-            return &operations[operationsCount++];
-        };
-        
-        void (^addEndOperation)() = ^{
-            SwiffShapeOperation *o = nextOperation();
-
-            o->type = SwiffShapeOperationTypeEnd;
-            o->fillStyleIndex = UINT16_MAX;
-            o->lineStyleIndex = UINT16_MAX;
         };
         
         void (^addOperation)(NSInteger, SwiffPoint, SwiffPoint, SwiffPoint) = ^(NSInteger type, SwiffPoint from, SwiffPoint control, SwiffPoint to) {
-            {
-                SwiffShapeOperation *o = nextOperation();
-                o->fromPoint      = from;
-                o->controlPoint   = control;
-                o->toPoint        = to;
-                o->fillStyleIndex = fillStyleIndex0;
-                o->lineStyleIndex = lineStyleIndex;
-                o->type           = type;
-                o->duplicate      = NO;
-            }
-
-            if (fillStyleIndex1) {
-                SwiffShapeOperation *o = nextOperation();
-                o->fromPoint      = to;
-                o->controlPoint   = control;
-                o->toPoint        = from;
-                o->fillStyleIndex = fillStyleIndex1;
-                o->lineStyleIndex = lineStyleIndex;
-                o->type           = type;
-                o->duplicate      = YES;
-            }
+            if (!group) group = calloc(1, sizeof(SwiffShapeEdgeGroup));
+            sEdgeGroupAddEdge(group, type, from, control, to, fillStyleIndex0, fillStyleIndex1, lineStyleIndex);
         };
 
         if (tag == SwiffTagDefineShape) {
@@ -266,14 +590,7 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
                     }
 
                     if (newStyles) {
-                        if (operations) {
-                            addEndOperation();
-                            CFArrayAppendValue(groups, operations);
-                        }
-                        operations         = NULL;
-                        operationsCount    = 0;
-                        operationsCapacity = 0;
-
+                        endGroup();
                         readStyles();
                         SwiffParserReadUBits(parser, 4, &fillBits);
                         SwiffParserReadUBits(parser, 4, &lineBits);
@@ -340,11 +657,8 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
             // SwiffParserByteAlign(parser);
         }
 
-        if (operations) {
-            addEndOperation();
-            CFArrayAppendValue(groups, operations);
-        }
-        
+        endGroup();
+
         CGFloat padding = SwiffCeil(maxWidth / 2.0) + 1;
         _renderBounds = CGRectInset(_bounds, -padding, -padding);
     }
@@ -358,7 +672,7 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
     if (_groups) {
         CFIndex length = CFArrayGetCount(_groups);
         for (CFIndex i = 0; i < length; i++) {
-            free((void *)CFArrayGetValueAtIndex(_groups, i));
+            sEdgeGroupFree((SwiffShapeEdgeGroup *)CFArrayGetValueAtIndex(_groups, i));
         }
 
         CFRelease(_groups);
@@ -376,41 +690,41 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
 #pragma mark -
 #pragma mark Private Methods
 
-- (NSArray *) _linePathsForOperations:(SwiffShapeOperation *)inOperations
+- (void) _addLinePathsForOperations:(SwiffShapeOperation *)inOperations
+                              heads:(const CFIndex *)heads
+                               next:(const CFIndex *)next
+                            toArray:(NSMutableArray *)result
 {
-    UInt16 index;
-    NSMutableArray *result = [NSMutableArray array];
-
     NSUInteger lineStyleCount = [_lineStyles count];
 
-    for (index = 1; index <= lineStyleCount; index++) {
-        SwiffShapeOperation *operation = inOperations;
+    for (NSUInteger index = 1; index <= lineStyleCount; index++) {
         SwiffPoint position = { NSIntegerMax, NSIntegerMax };
         SwiffPath *path = nil;
         
         BOOL hadFillStyle = NO;
         
-        while (operation->type != SwiffShapeOperationTypeEnd) {
-            BOOL   isDuplicate    = operation->duplicate;
-            UInt16 lineStyleIndex = operation->lineStyleIndex; 
-            UInt16 fillStyleIndex = operation->fillStyleIndex; 
-            
-            if (lineStyleIndex == index) {
-                if (!isDuplicate) { 
-                    if (!path) {
-                        SwiffLineStyle *lineStyle = [_lineStyles objectAtIndex:(index - 1)];
-                        path = [[SwiffPath alloc] initWithLineStyle:lineStyle fillStyle:nil];
+        for (CFIndex i = heads[index]; i != kCFNotFound; i = next[i]) {
+            SwiffShapeOperation *operation = &inOperations[i];
+
+            if (!operation->duplicate) { 
+                if (!path) {
+                    SwiffLineStyle *lineStyle = [_lineStyles objectAtIndex:(index - 1)];
+                    path = [[SwiffPath alloc] initWithLineStyle:lineStyle fillStyle:nil];
+
+                    NSUInteger remaining = 0;
+                    for (CFIndex k = i; k != kCFNotFound; k = next[k]) {
+                        remaining++;
                     }
 
-                    sPathAddShapeOperation(path, operation, &position);
-                }
-                
-                if (fillStyleIndex) {
-                    hadFillStyle = YES;
+                    sPathReserveForShapeOperations(path, remaining);
                 }
+
+                sPathAddShapeOperation(path, operation, &position);
             }
             
-            operation++;
+            if (operation->fillStyleIndex) {
+                hadFillStyle = YES;
+            }
         }
         
         if (hadFillStyle && ([[path lineStyle] width] == SwiffLineStyleHairlineWidth)) {
@@ -423,37 +737,11 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
             [result addObject:path];
         }
     }
-    
-    return result;
 }
 
 
-- (NSArray *) _fillPathsForOperations:(SwiffShapeOperation *)inOperations
+- (void) _addFillPathsForOperationMap:(CFDictionaryRef)map toArray:(NSMutableArray *)results
 {
-    NSMutableArray *results = [NSMutableArray array];
-    CFMutableDictionaryRef map = CFDictionaryCreateMutable(NULL, 0, NULL, &kCFTypeDictionaryValueCallBacks);
-    
-    // Collect operations by fill style
-    SwiffShapeOperation *operation = inOperations;
-    while (operation->type != SwiffShapeOperationTypeEnd) {
-        const void *key = (const void *)((NSInteger)operation->fillStyleIndex);
-        if (!key) {
-            operation++;
-            continue;
-        }
-
-        CFMutableArrayRef operations = (CFMutableArrayRef)CFDictionaryGetValue(map, key);
-
-        if (!operations) {
-            operations = CFArrayCreateMutable(NULL, 0, NULL);
-            CFDictionarySetValue(map, key, operations);
-            CFRelease(operations);
-        }
-    
-        CFArrayAppendValue(operations, operation);
-        operation++;
-    }
-
     CFIndex      i, j;
     CFIndex      count  = CFDictionaryGetCount(map);
     CFIndex     jCount;
@@ -464,92 +752,102 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
     
     for (i = 0; i < count; i++) {
         NSInteger fillStyleIndex = (NSInteger)keys[i];
-        CFMutableArrayRef operations = (CFMutableArrayRef)values[i];
-
-        CFMutableArrayRef sortedOperations = CFArrayCreateMutable(NULL, 0, NULL);
-
-        SwiffShapeOperation *currentOperation = (SwiffShapeOperation *)CFArrayGetValueAtIndex(operations, 0);
-        SwiffShapeOperation *firstOperation   = NULL;
-
-        CFArrayAppendValue(sortedOperations, currentOperation);
-        CFArrayRemoveValueAtIndex(operations, 0);
-        firstOperation = currentOperation;
-        
-        while ((jCount = CFArrayGetCount(operations)) > 0) {
-            for (j = 0; j < jCount; j++) {
-                SwiffShapeOperation *o = (SwiffShapeOperation *)CFArrayGetValueAtIndex(operations, j);
-                SwiffPoint point1 = o->fromPoint;
-                SwiffPoint point2 = currentOperation->toPoint;
-                
-                if ((point1.x == point2.x) && (point1.y == point2.y)) {
-                    SwiffLog(@"Shape", @"Found connecting path operation");
-
-                    CFArrayAppendValue(sortedOperations, o);
-                    currentOperation = o;
-                    SwiffLog(@"Shape", @"currentOperation = %p", currentOperation);
-                    break;
-                }
-            }
-            
-            
-            CFRange entireRange = { 0, CFArrayGetCount(operations) };
-            CFIndex indexOfCurrent = CFArrayGetFirstIndexOfValue(operations, entireRange, currentOperation);
-            if (indexOfCurrent != kCFNotFound) {
-                CFArrayRemoveValueAtIndex(operations, indexOfCurrent);
-
-            } else {
-                while ((jCount = CFArrayGetCount(operations)) > 0) {
-                    currentOperation = (SwiffShapeOperation *)CFArrayGetValueAtIndex(operations, 0);
-                    CFArrayRemoveValueAtIndex(operations, 0);
-
-                    SwiffLog(@"Shape", @"No connecting path operation found");
-                    SwiffLog(@"Shape", @"currentOperation = %p", currentOperation);
+        CFArrayRef operations = (CFArrayRef)values[i];
 
-                    SwiffPoint point1 = firstOperation->fromPoint;
-                    SwiffPoint point2 = currentOperation->toPoint;
-
-                    if ((point1.x == point2.x) && (point1.y == point2.y)) {
-                        CFArrayInsertValueAtIndex(sortedOperations, 0, currentOperation);
-                        firstOperation = currentOperation;
-                        SwiffLog(@"Shape", @"firstOperation = %p", firstOperation);
-
-                    } else {
-                        CFArrayAppendValue(sortedOperations, currentOperation);
-                        SwiffLog(@"Shape", @"No join found, moving to:\n    %p\n", currentOperation);
-                        break;
-                    }
-                }
-            }
-        }
-        
-        jCount = CFArrayGetCount(sortedOperations);
+        jCount = CFArrayGetCount(operations);
         if (jCount > 0) {
             SwiffFillStyle *fillStyle = [_fillStyles objectAtIndex:(fillStyleIndex - 1)];
             
             if (fillStyle) {
+                SwiffShapeOperation **sortedOperations = malloc(jCount * sizeof(SwiffShapeOperation *));
+                CFArrayGetValues(operations, CFRangeMake(0, jCount), (const void **)sortedOperations);
+
+                sSortFillOperations(sortedOperations, jCount);
+
                 SwiffPath *path = [[SwiffPath alloc] initWithLineStyle:nil fillStyle:fillStyle];
                 SwiffPoint position = { NSIntegerMax, NSIntegerMax };
 
+                sPathReserveForShapeOperations(path, jCount);
+
                 for (j = 0; j < jCount; j++) {
-                    SwiffShapeOperation *op = (SwiffShapeOperation *)CFArrayGetValueAtIndex(sortedOperations, j);
-                    sPathAddShapeOperation(path, op, &position);
+                    sPathAddShapeOperation(path, sortedOperations[j], &position);
                 }
 
                 SwiffPathAddOperationEnd(path);
 
                 [results addObject:path];
+
+                free(sortedOperations);
             }
         }
-
-        CFRelease(sortedOperations);
     }
     
-    CFRelease(map);
-    
     if (keys) free(keys);
     if (values) free(values);
+}
+
 
-    return results;
+// Buckets the operations of a style group by fill style and by line style in a single pass,
+// then adds the group's fill paths followed by its line paths
+//
+- (void) _addPathsForOperations:(SwiffShapeOperation *)inOperations toArray:(NSMutableArray *)result
+{
+    NSUInteger lineStyleCount = [_lineStyles count];
+    NSUInteger operationCount = 0;
+
+    while (inOperations[operationCount].type != SwiffShapeOperationTypeEnd) {
+        operationCount++;
+    }
+
+    CFMutableDictionaryRef map = CFDictionaryCreateMutable(NULL, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+
+    // Operations of each line style, as a linked list of indexes into inOperations
+    CFIndex *lineHeads = malloc((lineStyleCount + 1) * sizeof(CFIndex));
+    CFIndex *lineTails = malloc((lineStyleCount + 1) * sizeof(CFIndex));
+    CFIndex *lineNext  = malloc(MAX(operationCount, 1) * sizeof(CFIndex));
+
+    for (NSUInteger index = 0; index <= lineStyleCount; index++) {
+        lineHeads[index] = lineTails[index] = kCFNotFound;
+    }
+
+    for (NSUInteger i = 0; i < operationCount; i++) {
+        SwiffShapeOperation *operation = &inOperations[i];
+
+        const void *key = (const void *)((NSInteger)operation->fillStyleIndex);
+        if (key) {
+            CFMutableArrayRef operations = (CFMutableArrayRef)CFDictionaryGetValue(map, key);
+
+            if (!operations) {
+                operations = CFArrayCreateMutable(NULL, 0, NULL);
+                CFDictionarySetValue(map, key, operations);
+                CFRelease(operations);
+            }
+        
+            CFArrayAppendValue(operations, operation);
+        }
+
+        UInt16 lineStyleIndex = operation->lineStyleIndex;
+        if (lineStyleIndex && (lineStyleIndex <= lineStyleCount)) {
+            lineNext[i] = kCFNotFound;
+
+            if (lineTails[lineStyleIndex] == kCFNotFound) {
+                lineHeads[lineStyleIndex] = i;
+            } else {
+                lineNext[lineTails[lineStyleIndex]] = i;
+            }
+
+            lineTails[lineStyleIndex] = i;
+        }
+    }
+
+    [self _addFillPathsForOperationMap:map toArray:result];
+    [self _addLinePathsForOperations:inOperations heads:lineHeads next:lineNext toArray:result];
+
+    CFRelease(map);
+
+    free(lineHeads);
+    free(lineTails);
+    free(lineNext);
 }
 
 
@@ -560,12 +858,13 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
 
         CFIndex length = CFArrayGetCount(_groups);
         for (CFIndex i = 0; i < length; i++) {
-            SwiffShapeOperation *operations = (SwiffShapeOperation *)CFArrayGetValueAtIndex(_groups, i);
+            SwiffShapeEdgeGroup *group      = (SwiffShapeEdgeGroup *)CFArrayGetValueAtIndex(_groups, i);
+            SwiffShapeOperation *operations = sEdgeGroupCreateOperations(group);
            
-            [result addObjectsFromArray:[self _fillPathsForOperations:operations]];
-            [result addObjectsFromArray:[self _linePathsForOperations:operations]];
+            [self _addPathsForOperations:operations toArray:result];
         
             free(operations);
+            sEdgeGroupFree(group);
         }
         
         CFRelease(_groups);
@@ -588,5 +887,46 @@ static void sPathAddShapeOperation(SwiffPath *path, SwiffShapeOperation *op, Swi
     return _paths;
 }
 
+
+- (NSUInteger) edgeCount
+{
+    NSUInteger result = 0;
+
+    CFIndex length = _groups ? CFArrayGetCount(_groups) : 0;
+    for (CFIndex i = 0; i < length; i++) {
+        result += ((SwiffShapeEdgeGroup *)CFArrayGetValueAtIndex(_groups, i))->edgeCount;
+    }
+
+    return result;
+}
+
+
+- (NSUInteger) edgeByteCount
+{
+    NSUInteger result = 0;
+
+    CFIndex length = _groups ? CFArrayGetCount(_groups) : 0;
+    for (CFIndex i = 0; i < length; i++) {
+        SwiffShapeEdgeGroup *group = (SwiffShapeEdgeGroup *)CFArrayGetValueAtIndex(_groups, i);
+        result += sizeof(SwiffShapeEdgeGroup) + group->length + (group->runCount * sizeof(SwiffShapeStyleRun));
+    }
+
+    return result;
+}
+
+
+- (NSUInteger) unpackedEdgeByteCount
+{
+    NSUInteger result = 0;
+
+    CFIndex length = _groups ? CFArrayGetCount(_groups) : 0;
+    for (CFIndex i = 0; i < length; i++) {
+        SwiffShapeEdgeGroup *group = (SwiffShapeEdgeGroup *)CFArrayGetValueAtIndex(_groups, i);
+        result += (group->operationCount + 1) * sizeof(SwiffShapeOperation);
+    }
+
+    return result;
+}
+
 @end
 
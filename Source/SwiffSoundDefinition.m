@@ -37,7 +37,7 @@
 
 
 @implementation SwiffSoundDefinition {
-    NSMutableData *_data;
+    NSData        *_data;  // NSMutableData for streaming sounds
     NSUInteger    *_frames;
     NSInteger      _framesCount;
     NSInteger      _framesCapacity;
@@ -82,17 +82,25 @@
         _rawSampleRate  = soundRate;
         _bitsPerChannel = (soundSize == 1) ? 16 : 8;
         _stereo         = (soundType == 1) ? YES : NO;
-        _data           = [[NSMutableData alloc] init];
 
         if (tag == SwiffTagDefineSound) {
             SwiffParserReadUInt32(parser, &_sampleCount);
 
             if (soundFormat == SwiffSoundFormatMP3) {
                 SwiffParserReadSInt16(parser, &_latencySeek);
-                [self _readMP3FramesFromParser:parser];
+
+                // The frames of an event sound are contiguous, keep them as a single
+                // (possibly zero-copy) NSData and index into it
+                NSData *data = nil;
+                SwiffParserReadData(parser, SwiffParserGetBytesRemainingInCurrentTag(parser), &data);
+
+                [self _indexMP3FramesInBytes:[data bytes] length:[data length] baseOffset:0];
+                _data = data;
             }
 
         } else if (tag == SwiffTagSoundStreamHead) {
+            _data = [[NSMutableData alloc] init];
+
             SwiffParserReadUInt16(parser, &_averageSampleCount);
             
             if (soundFormat == SwiffSoundFormatMP3) {
@@ -121,29 +129,47 @@
 #pragma mark -
 #pragma mark - Private Methods
 
-- (void) _readMP3FramesFromParser:(SwiffParser *)parser
+// Returns the number of bytes consumed by complete frames
+- (NSUInteger) _indexMP3FramesInBytes:(const UInt8 *)bytes length:(NSUInteger)length baseOffset:(NSUInteger)baseOffset
 {
-    while (SwiffParserGetBytesRemainingInCurrentTag(parser) > 0) {
-        const void *frameStart = SwiffParserGetCurrentBytePointer(parser);
+    NSUInteger offset = 0;
 
+    while ((length - offset) >= 4) {
         SwiffMPEGHeader header;
-        SwiffMPEGError  error = SwiffMPEGReadHeader(frameStart, &header);
+        SwiffMPEGError  error = SwiffMPEGReadHeader(bytes + offset, &header);
         if (error != SwiffMPEGErrorNone) {
             SwiffWarn(@"Sound", @"SwiffMPEGReadHeader() returned %ld", (long)error);
         }
 
+        if ((header.frameSize == 0) || (header.frameSize > (length - offset))) {
+            break;
+        }
+
         if (_framesCount == _framesCapacity) {
             _framesCapacity = _framesCapacity ? _framesCapacity * 2 : 256;
             _frames = realloc(_frames, sizeof(NSUInteger) * _framesCapacity);
         }
 
-        _frames[_framesCount] = [_data length];
+        _frames[_framesCount] = baseOffset + offset;
         _framesCount++;
-        
-        [_data appendBytes:frameStart length:header.frameSize];
 
-        SwiffParserAdvance(parser, header.frameSize);
+        offset += header.frameSize;
     }
+    
+    return offset;
+}
+
+
+- (void) _readMP3FramesFromParser:(SwiffParser *)parser
+{
+    NSMutableData *data   = (NSMutableData *)_data;
+    const UInt8   *bytes  = SwiffParserGetCurrentBytePointer(parser);
+    NSUInteger     length = SwiffParserGetBytesRemainingInCurrentTag(parser);
+
+    NSUInteger consumed = [self _indexMP3FramesInBytes:bytes length:length baseOffset:[data length]];
+    [data appendBytes:bytes length:consumed];
+
+    SwiffParserAdvance(parser, length);
 }
 
 
@@ -59,7 +59,8 @@ static NSString * const SwiffSpriteDefinitionStreamBlockKey = @"SwiffSpriteDefin
                           withNames: (NSArray *) placedObjectsWithNames
                         soundEvents: (NSArray *) soundEvents
                         streamSound: (SwiffSoundDefinition *) streamSound
-                        streamBlock: (SwiffSoundStreamBlock *) streamBlock;
+                        streamBlock: (SwiffSoundStreamBlock *) streamBlock
+              changedInstanceDepths: (NSIndexSet *) changedInstanceDepths;
 @end
 
 
@@ -69,11 +70,13 @@ static NSString * const SwiffSpriteDefinitionStreamBlockKey = @"SwiffSpriteDefin
 
 
 @implementation SwiffSpriteDefinition {
-    NSDictionary     *_labelToFrameMap;
-    SwiffFrame       *_lastFrame;
-    NSDictionary     *_sceneNameToSceneMap;
-    SwiffSparseArray *_placedObjects;
-    NSMutableArray   *_frames;
+    NSDictionary      *_labelToFrameMap;
+    SwiffFrame        *_lastFrame;
+    NSDictionary      *_sceneNameToSceneMap;
+    SwiffSparseArray  *_placedObjects;
+    NSMutableArray    *_frames;
+    NSMutableIndexSet *_changedInstanceDepths;
+    UInt32             _lastInstanceID;
 }
 
 @synthesize movie        = _movie,
@@ -90,6 +93,7 @@ static NSString * const SwiffSpriteDefinitionStreamBlockKey = @"SwiffSpriteDefin
     if ((self = [super init])) {
         _frames = [[NSMutableArray alloc] init];
         _placedObjects = [[SwiffSparseArray alloc] init];
+        _changedInstanceDepths = [[NSMutableIndexSet alloc] init];
     }
     
     return self;
@@ -261,6 +265,12 @@ static NSString * const SwiffSpriteDefinitionStreamBlockKey = @"SwiffSpriteDefin
 
     [placedObject setDepth:depth];
 
+    // Moving the existing character keeps its instance, and its playhead when it is a sprite
+    if (!move || !existingPlacedObject || (hasLibraryID && (libraryID != [existingPlacedObject libraryID]))) {
+        [placedObject setInstanceID:++_lastInstanceID];
+        [_changedInstanceDepths addIndex:depth];
+    }
+
     if (hasImage) {
         [placedObject setPlacesImage:YES];
         [placedObject setClassName:className];
@@ -313,6 +323,7 @@ static NSString * const SwiffSpriteDefinitionStreamBlockKey = @"SwiffSpriteDefin
     }
 
     SwiffSparseArraySetObjectAtIndex(_placedObjects, depth, nil);
+    [_changedInstanceDepths addIndex:depth];
     _lastFrame = nil;
 }
 
@@ -356,7 +367,10 @@ static NSString * const SwiffSpriteDefinitionStreamBlockKey = @"SwiffSpriteDefin
                                                                withNames: placedObjectsWithNames
                                                              soundEvents: soundEvents
                                                              streamSound: streamSound
-                                                             streamBlock: streamBlock];
+                                                             streamBlock: streamBlock
+                                                   changedInstanceDepths: ([_changedInstanceDepths count] ? [_changedInstanceDepths copy] : nil)];
+
+    [_changedInstanceDepths removeAllIndexes];
 
     [_frames addObject:frame];
     _lastFrame = frame;
@@ -38,4 +38,9 @@
 
 @property (nonatomic, strong, readonly) NSArray *textRecords;
 @property (nonatomic, assign, readonly) CGAffineTransform textTransform;
+
+// One CGPathRef per text record, containing all of its glyphs scaled and positioned in the coordinate
+// space of the definition.  Built on first use, and rebuilt only when the glyphs of a record's font change
+@property (nonatomic, strong, readonly) NSArray *glyphRunPaths;
+
 @end
@@ -27,10 +27,15 @@
 
 #import "SwiffStaticTextDefinition.h"
 
+#import "SwiffFontDefinition.h"
+#import "SwiffMovie.h"
 #import "SwiffParser.h"
 #import "SwiffStaticTextRecord.h"
 
-@implementation SwiffStaticTextDefinition
+@implementation SwiffStaticTextDefinition {
+    NSArray   *_glyphRunPaths;
+    CGPathRef **_glyphRunFontGlyphPaths;    // The -[SwiffFontDefinition glyphPaths] used by each record, or NULL
+}
 
 @synthesize movie     = _movie,
             libraryID = _libraryID,
@@ -60,12 +65,115 @@
 }
 
 
+- (void) dealloc
+{
+    free(_glyphRunFontGlyphPaths);
+    _glyphRunFontGlyphPaths = NULL;
+}
+
+
 - (void) clearWeakReferences
 {
     _movie = nil;
 }
 
 
+#pragma mark -
+#pragma mark Glyph Runs
+
+- (BOOL) _areGlyphRunPathsValid
+{
+    if (!_glyphRunPaths) return NO;
+
+    NSUInteger index = 0;
+    for (SwiffStaticTextRecord *record in _textRecords) {
+        if ([record hasFont]) {
+            SwiffFontDefinition *font = [_movie fontDefinitionWithLibraryID:[record fontID]];
+            if ([font glyphPaths] != _glyphRunFontGlyphPaths[index]) return NO;
+        }
+
+        index++;
+    }
+
+    return YES;
+}
+
+
+- (void) _buildGlyphRunPaths
+{
+    NSUInteger recordCount = [_textRecords count];
+    NSMutableArray *paths = [NSMutableArray arrayWithCapacity:recordCount];
+
+    free(_glyphRunFontGlyphPaths);
+    _glyphRunFontGlyphPaths = calloc(recordCount, sizeof(CGPathRef *));
+
+    CGPathRef *glyphPaths = NULL;
+    NSUInteger glyphCount = 0;
+    CGFloat    multiplier = 1.0;
+    CGPoint    offset     = CGPointZero;
+
+    NSUInteger index = 0;
+    for (SwiffStaticTextRecord *record in _textRecords) {
+        NSInteger glyphEntriesCount = [record glyphEntriesCount];
+        SwiffStaticTextRecordGlyphEntry *glyphEntries = [record glyphEntries];
+
+        CGFloat advance = 0;
+
+        if ([record hasFont]) {
+            SwiffFontDefinition *font = [_movie fontDefinitionWithLibraryID:[record fontID]];
+            glyphPaths = [font glyphPaths];
+            glyphCount = [font glyphCount];
+            multiplier = (1.0 / SwiffFontEmSquareHeight) * [record textHeight];
+
+            _glyphRunFontGlyphPaths[index] = glyphPaths;
+        }
+
+        if ([record hasXOffset]) {
+            offset.x = [record xOffset];
+        }
+
+        if ([record hasYOffset]) {
+            offset.y = [record yOffset];
+        }
+
+        CGMutablePathRef path = CGPathCreateMutable();
+
+        if (glyphPaths && glyphEntries) {
+            for (NSInteger i = 0; i < glyphEntriesCount; i++) {
+                SwiffStaticTextRecordGlyphEntry entry = glyphEntries[i];
+
+                if (entry.index < glyphCount) {
+                    CGAffineTransform glyphTransform = CGAffineTransformMake(multiplier, 0, 0, multiplier, offset.x + advance, offset.y);
+                    CGPathAddPath(path, &glyphTransform, glyphPaths[entry.index]);
+                }
+
+                advance += entry.advance;
+            }
+        }
+
+        [paths addObject:(__bridge id)path];
+        CGPathRelease(path);
+
+        offset.x += advance;
+        index++;
+    }
+
+    _glyphRunPaths = paths;
+}
+
+
+- (NSArray *) glyphRunPaths
+{
+    @synchronized (self) {
+        if (![self _areGlyphRunPathsValid]) {
+            [self _buildGlyphRunPaths];
+        }
+
+        return _glyphRunPaths;
+    }
+}
+
+
 - (CGRect) renderBounds
 {
     return _bounds;
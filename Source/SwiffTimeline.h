@@ -0,0 +1,69 @@
+/*
+    SwiffTimeline.h
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <SwiffImport.h>
+
+@class SwiffMovie, SwiffFrame, SwiffPlacedObject, SwiffSpriteDefinition;
+
+
+// The playhead of one instance of a sprite, plus the playheads of the sprite instances in its current
+// frame, which advance with it.  Instances only keep a frame index, their frames (and placed objects)
+// are the immutable ones of the sprite definition, shared by all of its instances.
+//
+// Stepping applies the -[SwiffFrame changedInstanceDepths] of the new frame, so its cost depends on the
+// number of changes and live sprite instances, not on the number of placed objects.
+//
+@interface SwiffTimeline : NSObject
+
+// The root timeline of movie, at its first frame
+- (id) initWithMovie:(SwiffMovie *)movie;
+
+// Advances the timeline by one tick, to frameIndex, and the sprite instances in the current frame
+// to their next frame, looping.  Instances placed by the new frame start at their first frame
+- (void) stepToFrameWithIndex:(NSUInteger)frameIndex;
+
+// Jumps to frameIndex without advancing the sprite instances.  Instances which are in both frames
+// keep their playheads
+- (void) gotoFrameWithIndex:(NSUInteger)frameIndex;
+
+// Returns the timeline of the sprite instance placed by placedObject in the current frame.  Instances
+// which are unknown to the timeline, such as ones placed in code, are added at their first frame.
+// Returns nil when placedObject does not place a sprite
+- (SwiffTimeline *) timelineForPlacedObject:(SwiffPlacedObject *)placedObject;
+
+// Identifies the current frames of all of the sprite instances, which placed objects of the current
+// frame alone do not.  nil when there are none
+- (NSData *) childFramesSignature;
+
+@property (nonatomic, strong, readonly) SwiffSpriteDefinition *spriteDefinition;
+@property (nonatomic, assign, readonly) NSUInteger frameIndex;
+@property (nonatomic, strong, readonly) SwiffFrame *frame;
+
+// YES when the last step or goto changed what the timeline draws, including its sprite instances
+@property (nonatomic, assign, readonly) BOOL didChange;
+
+@end
@@ -0,0 +1,264 @@
+/*
+    SwiffTimeline.m
+    Copyright (c) 2011-2012, musictheory.net, LLC.  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+        * Redistributions of source code must retain the above copyright
+          notice, this list of conditions and the following disclaimer.
+        * Redistributions in binary form must reproduce the above copyright
+          notice, this list of conditions and the following disclaimer in the
+          documentation and/or other materials provided with the distribution.
+        * Neither the name of musictheory.net, LLC nor the names of its contributors
+          may be used to endorse or promote products derived from this software
+          without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL MUSICTHEORY.NET, LLC BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SwiffTimeline.h"
+
+#import "SwiffFrame.h"
+#import "SwiffMovie.h"
+#import "SwiffPlacedObject.h"
+#import "SwiffSparseArray.h"
+#import "SwiffSpriteDefinition.h"
+
+
+@implementation SwiffTimeline {
+    SwiffMovie       *_movie;
+    NSArray          *_frames;
+    SwiffSparseArray *_children;      // SwiffTimeline of each sprite instance, by depth.  Created on demand
+    UInt32            _instanceID;
+    UInt16            _depth;
+}
+
+
+// placedObjects is sorted by ascending depth
+static SwiffPlacedObject *sGetPlacedObjectAtDepth(NSArray *placedObjects, NSUInteger depth)
+{
+    NSInteger low  = 0;
+    NSInteger high = (NSInteger)[placedObjects count] - 1;
+
+    while (low <= high) {
+        NSInteger mid = (low + high) / 2;
+        SwiffPlacedObject *placedObject = [placedObjects objectAtIndex:mid];
+
+        if (placedObject->_depth < depth) {
+            low = mid + 1;
+        } else if (placedObject->_depth > depth) {
+            high = mid - 1;
+        } else {
+            return placedObject;
+        }
+    }
+
+    return nil;
+}
+
+
+// Returns the depths at which the instances of oldFrame and newFrame differ, for transitions which
+// are not a step to the next frame, and so are not covered by -[SwiffFrame changedInstanceDepths]
+static NSIndexSet *sGetChangedInstanceDepths(SwiffFrame *oldFrame, SwiffFrame *newFrame)
+{
+    NSArray *oldPlacedObjects = [oldFrame placedObjects];
+    NSArray *newPlacedObjects = [newFrame placedObjects];
+
+    if (oldPlacedObjects == newPlacedObjects) return nil;
+
+    NSMutableIndexSet *result = [NSMutableIndexSet indexSet];
+
+    NSUInteger oldCount = [oldPlacedObjects count], oldIndex = 0;
+    NSUInteger newCount = [newPlacedObjects count], newIndex = 0;
+
+    while ((oldIndex < oldCount) || (newIndex < newCount)) {
+        SwiffPlacedObject *oldPlacedObject = (oldIndex < oldCount) ? [oldPlacedObjects objectAtIndex:oldIndex] : nil;
+        SwiffPlacedObject *newPlacedObject = (newIndex < newCount) ? [newPlacedObjects objectAtIndex:newIndex] : nil;
+
+        NSInteger oldDepth = oldPlacedObject ? oldPlacedObject->_depth : NSIntegerMax;
+        NSInteger newDepth = newPlacedObject ? newPlacedObject->_depth : NSIntegerMax;
+
+        if (oldDepth == newDepth) {
+            if (oldPlacedObject->_instanceID != newPlacedObject->_instanceID) {
+                [result addIndex:newDepth];
+            }
+
+            oldIndex++;
+            newIndex++;
+
+        } else if (oldDepth < newDepth) {
+            [result addIndex:oldDepth];
+            oldIndex++;
+
+        } else {
+            [result addIndex:newDepth];
+            newIndex++;
+        }
+    }
+
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Lifecycle
+
+- (id) _initWithSpriteDefinition:(SwiffSpriteDefinition *)spriteDefinition movie:(SwiffMovie *)movie placedObject:(SwiffPlacedObject *)placedObject
+{
+    if ((self = [super init])) {
+        _movie            = movie;
+        _spriteDefinition = spriteDefinition;
+        _frames           = [spriteDefinition frames];
+        _frame            = [_frames count] ? [_frames objectAtIndex:0] : nil;
+        _instanceID       = placedObject ? placedObject->_instanceID : 0;
+        _depth            = placedObject ? placedObject->_depth      : 0;
+
+        for (SwiffPlacedObject *childPlacedObject in [_frame placedObjects]) {
+            [self _addChildForPlacedObject:childPlacedObject];
+        }
+    }
+
+    return self;
+}
+
+
+- (id) initWithMovie:(SwiffMovie *)movie
+{
+    return [self _initWithSpriteDefinition:movie movie:movie placedObject:nil];
+}
+
+
+#pragma mark -
+#pragma mark Private Methods
+
+- (SwiffTimeline *) _addChildForPlacedObject:(SwiffPlacedObject *)placedObject
+{
+    UInt16 libraryID = placedObject->_libraryID;
+
+    // Avoid decoding definitions which are not sprites
+    if (![SwiffMovieGetDefinitionClass(_movie, libraryID) isSubclassOfClass:[SwiffSpriteDefinition class]]) {
+        return nil;
+    }
+
+    SwiffSpriteDefinition *spriteDefinition = (SwiffSpriteDefinition *)SwiffMovieGetDefinition(_movie, libraryID);
+    SwiffTimeline *child = [[SwiffTimeline alloc] _initWithSpriteDefinition:spriteDefinition movie:_movie placedObject:placedObject];
+
+    if (!_children) {
+        _children = [[SwiffSparseArray alloc] init];
+    }
+
+    SwiffSparseArraySetObjectAtIndex(_children, placedObject->_depth, child);
+
+    return child;
+}
+
+
+- (void) _moveToFrameWithIndex:(NSUInteger)frameIndex stepsChildren:(BOOL)stepsChildren
+{
+    SwiffFrame *oldFrame      = _frame;
+    SwiffFrame *newFrame      = (frameIndex < [_frames count]) ? [_frames objectAtIndex:frameIndex] : nil;
+    NSIndexSet *changedDepths = nil;
+
+    _didChange = NO;
+
+    if (newFrame && (newFrame != oldFrame)) {
+        if (oldFrame && (frameIndex == (_frameIndex + 1))) {
+            changedDepths = [newFrame changedInstanceDepths];
+        } else {
+            changedDepths = sGetChangedInstanceDepths(oldFrame, newFrame);
+        }
+
+        _didChange  = ([newFrame placedObjects] != [oldFrame placedObjects]);
+        _frame      = newFrame;
+        _frameIndex = frameIndex;
+    }
+
+    // Removed and replaced instances lose their playheads
+    if (_children) {
+        for (NSUInteger depth = [changedDepths firstIndex]; depth != NSNotFound; depth = [changedDepths indexGreaterThanIndex:depth]) {
+            SwiffSparseArraySetObjectAtIndex(_children, depth, nil);
+        }
+    }
+
+    if (stepsChildren) {
+        for (SwiffTimeline *child in _children) {
+            NSUInteger frameCount = [child->_frames count];
+
+            if (frameCount) {
+                [child _moveToFrameWithIndex:((child->_frameIndex + 1) % frameCount) stepsChildren:YES];
+                if (child->_didChange) _didChange = YES;
+            }
+        }
+    }
+
+    // Instances placed by the new frame start at their first frame, after the existing ones have advanced
+    for (NSUInteger depth = [changedDepths firstIndex]; depth != NSNotFound; depth = [changedDepths indexGreaterThanIndex:depth]) {
+        SwiffPlacedObject *placedObject = sGetPlacedObjectAtDepth([_frame placedObjects], depth);
+        if (placedObject) [self _addChildForPlacedObject:placedObject];
+    }
+}
+
+
+- (void) _appendChildFramesSignatureToData:(NSMutableData *)data
+{
+    for (SwiffTimeline *child in _children) {
+        UInt32 values[2] = { child->_depth, (UInt32)child->_frameIndex };
+        [data appendBytes:values length:sizeof(values)];
+
+        [child _appendChildFramesSignatureToData:data];
+
+        // Closes the children of child, so that their nesting is part of the signature
+        UInt32 end = UINT32_MAX;
+        [data appendBytes:&end length:sizeof(end)];
+    }
+}
+
+
+#pragma mark -
+#pragma mark Public Methods
+
+- (void) stepToFrameWithIndex:(NSUInteger)frameIndex
+{
+    [self _moveToFrameWithIndex:frameIndex stepsChildren:YES];
+}
+
+
+- (void) gotoFrameWithIndex:(NSUInteger)frameIndex
+{
+    [self _moveToFrameWithIndex:frameIndex stepsChildren:NO];
+}
+
+
+- (SwiffTimeline *) timelineForPlacedObject:(SwiffPlacedObject *)placedObject
+{
+    SwiffTimeline *child = SwiffSparseArrayGetObjectAtIndex(_children, placedObject->_depth);
+
+    if (child && (child->_instanceID == placedObject->_instanceID) && ([child->_spriteDefinition libraryID] == placedObject->_libraryID)) {
+        return child;
+    }
+
+    return [self _addChildForPlacedObject:placedObject];
+}
+
+
+- (NSData *) childFramesSignature
+{
+    if (!_children) return nil;
+
+    NSMutableData *data = [NSMutableData data];
+    [self _appendChildFramesSignatureToData:data];
+
+    return [data length] ? data : nil;
+}
+
+
+@end
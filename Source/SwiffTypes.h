@@ -50,6 +50,17 @@ typedef struct SwiffColorTransform {
 extern const SwiffColorTransform SwiffColorTransformIdentity;
 
 
+// A sequence of SwiffColorTransforms composed into one.  As each transform clamps its result to 0-1,
+// the composition is a multiply and add followed by a clamp to [minimum, maximum], per channel.
+typedef struct SwiffComposedColorTransform {
+    SwiffColorTransform transform;
+    CGFloat minimum[4];
+    CGFloat maximum[4];
+} SwiffComposedColorTransform;
+
+extern const SwiffComposedColorTransform SwiffComposedColorTransformIdentity;
+
+
 typedef struct SwiffColor {
     CGFloat red;
     CGFloat green;
@@ -60,9 +71,16 @@ typedef struct SwiffColor {
 
 typedef void (^SwiffColorModificationBlock)(SwiffColor *);
 
+typedef NS_ENUM(NSInteger, SwiffCompression) {
+    SwiffCompressionZlib = 0,   // 'CWS', version 6 and later
+    SwiffCompressionLZMA = 1    // 'ZWS', version 13 and later
+};
+
+
 typedef struct SwiffHeader {
     UInt8   version;
     BOOL    isCompressed;
+    SwiffCompression compression;  // Only used when isCompressed is YES
     UInt16  frameCount;
     UInt32  fileLength;
     CGRect  stageRect;
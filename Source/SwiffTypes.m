@@ -31,3 +31,9 @@ const SwiffColorTransform SwiffColorTransformIdentity = {
     1.0, 1.0, 1.0, 1.0,
     0.0, 0.0, 0.0, 0.0
 };
+
+const SwiffComposedColorTransform SwiffComposedColorTransformIdentity = {
+    { 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0 },
+    { -INFINITY, -INFINITY, -INFINITY, -INFINITY },
+    {  INFINITY,  INFINITY,  INFINITY,  INFINITY }
+};
@@ -124,6 +124,15 @@ extern BOOL SwiffColorTransformEqualToTransform(const SwiffColorTransform *a, co
 // CFArrayRef values must be valid (SwiffColorTransform *).  If stack is NULL, color is returned
 extern SwiffColor SwiffColorApplyColorTransformStack(SwiffColor color, CFArrayRef stack);
 
+// Returns the composition which applies composed, then transform.  Applying the result to a color is
+// equivalent to applying each transform of the composition in order
+extern SwiffComposedColorTransform SwiffComposedColorTransformAppend(const SwiffComposedColorTransform *composed, const SwiffColorTransform *transform);
+
+// Composes a stack as used by SwiffColorApplyColorTransformStack().  If stack is NULL, the identity is returned
+extern SwiffComposedColorTransform SwiffComposedColorTransformMakeWithStack(CFArrayRef stack);
+
+extern SwiffColor SwiffColorApplyComposedColorTransform(SwiffColor color, const SwiffComposedColorTransform *composed);
+
 extern NSString *SwiffStringFromColorTransform(const SwiffColorTransform *transform);
 extern NSString *SwiffStringFromColorTransformStack(CFArrayRef stack);
 
@@ -209,6 +209,83 @@ SwiffColor SwiffColorApplyColorTransformStack(SwiffColor color, CFArrayRef stack
 }
 
 
+// Composes clamp(m * x + a, 0, 1) after clamp(multiply * x + add, minimum, maximum), which is again of the latter form
+static void sComposeChannel(CGFloat *multiply, CGFloat *add, CGFloat *minimum, CGFloat *maximum, CGFloat m, CGFloat a)
+{
+    CGFloat newMinimum, newMaximum;
+
+    if (m > 0.0) {
+        newMinimum = (*minimum * m) + a;
+        newMaximum = (*maximum * m) + a;
+    } else if (m < 0.0) {
+        newMinimum = (*maximum * m) + a;
+        newMaximum = (*minimum * m) + a;
+    } else {
+        newMinimum = newMaximum = a;    // Avoids 0 * INFINITY
+    }
+
+    *minimum  = (newMinimum < 0.0) ? 0.0 : ((newMinimum > 1.0) ? 1.0 : newMinimum);
+    *maximum  = (newMaximum < 0.0) ? 0.0 : ((newMaximum > 1.0) ? 1.0 : newMaximum);
+    *multiply = *multiply * m;
+    *add      = (*add * m) + a;
+}
+
+
+static CGFloat sApplyComposedChannel(CGFloat x, CGFloat multiply, CGFloat add, CGFloat minimum, CGFloat maximum)
+{
+    x = (x * multiply) + add;
+
+    if      (x < minimum) x = minimum;
+    else if (x > maximum) x = maximum;
+
+    return x;
+}
+
+
+SwiffComposedColorTransform SwiffComposedColorTransformAppend(const SwiffComposedColorTransform *inComposed, const SwiffColorTransform *t)
+{
+    SwiffComposedColorTransform composed = inComposed ? *inComposed : SwiffComposedColorTransformIdentity;
+    if (!t) return composed;
+
+    SwiffColorTransform *c = &composed.transform;
+
+    sComposeChannel(&c->redMultiply,   &c->redAdd,   &composed.minimum[0], &composed.maximum[0], t->redMultiply,   t->redAdd);
+    sComposeChannel(&c->greenMultiply, &c->greenAdd, &composed.minimum[1], &composed.maximum[1], t->greenMultiply, t->greenAdd);
+    sComposeChannel(&c->blueMultiply,  &c->blueAdd,  &composed.minimum[2], &composed.maximum[2], t->blueMultiply,  t->blueAdd);
+    sComposeChannel(&c->alphaMultiply, &c->alphaAdd, &composed.minimum[3], &composed.maximum[3], t->alphaMultiply, t->alphaAdd);
+
+    return composed;
+}
+
+
+SwiffComposedColorTransform SwiffComposedColorTransformMakeWithStack(CFArrayRef stack)
+{
+    SwiffComposedColorTransform composed = SwiffComposedColorTransformIdentity;
+    if (!stack) return composed;
+
+    for (CFIndex i = 0, count = CFArrayGetCount(stack); i < count; i++) {
+        composed = SwiffComposedColorTransformAppend(&composed, (SwiffColorTransform *)CFArrayGetValueAtIndex(stack, i));
+    }
+
+    return composed;
+}
+
+
+SwiffColor SwiffColorApplyComposedColorTransform(SwiffColor color, const SwiffComposedColorTransform *composed)
+{
+    if (!composed) return color;
+
+    const SwiffColorTransform *c = &composed->transform;
+
+    color.red   = sApplyComposedChannel(color.red,   c->redMultiply,   c->redAdd,   composed->minimum[0], composed->maximum[0]);
+    color.green = sApplyComposedChannel(color.green, c->greenMultiply, c->greenAdd, composed->minimum[1], composed->maximum[1]);
+    color.blue  = sApplyComposedChannel(color.blue,  c->blueMultiply,  c->blueAdd,  composed->minimum[2], composed->maximum[2]);
+    color.alpha = sApplyComposedChannel(color.alpha, c->alphaMultiply, c->alphaAdd, composed->minimum[3], composed->maximum[3]);
+
+    return color;
+}
+
+
 BOOL SwiffColorTransformEqualToTransform(const SwiffColorTransform *a, const SwiffColorTransform *b)
 {
     if (a && b) {
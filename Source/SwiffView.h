@@ -64,6 +64,7 @@
 @property (nonatomic, assign) BOOL drawsBackground;
 
 @property (nonatomic, strong) SwiffColorModificationBlock colorModificationBlock;
+@property (nonatomic, assign) SwiffColorTransform *colorModificationTransform;
 @property (nonatomic, assign) CGFloat hairlineWidth;
 @property (nonatomic, assign) CGFloat fillHairlineWidth;
 
@@ -71,6 +72,7 @@
 @property (nonatomic, assign) BOOL shouldSmoothFonts;
 @property (nonatomic, assign) BOOL shouldSubpixelPositionFonts;
 @property (nonatomic, assign) BOOL shouldSubpixelQuantizeFonts;
+@property (nonatomic, assign) BOOL shouldCacheSlidingSprites;
 @property (nonatomic, assign) BOOL shouldFlattenSublayers;
 @property (nonatomic, assign) BOOL shouldDrawDebugColors;
 
@@ -40,7 +40,7 @@
     CGSize _forcedSize;
 }
 
-@dynamic colorModificationBlock;
+@dynamic colorModificationBlock, colorModificationTransform;
 
 
 - (void) dealloc
@@ -289,12 +289,25 @@
 }
 
 
+- (void) setColorModificationTransform:(SwiffColorTransform *)transform
+{
+    [_layer setColorModificationTransform:transform];
+}
+
+
+- (SwiffColorTransform *) colorModificationTransform
+{
+    return [_layer colorModificationTransform];
+}
+
+
 - (void) setHairlineWidth:(CGFloat)width              { [_layer setHairlineWidth:width];             }
 - (void) setFillHairlineWidth:(CGFloat)width          { [_layer setFillHairlineWidth:width];         }
 - (void) setShouldAntialias:(BOOL)yn                  { [_layer setShouldAntialias:yn];              }
 - (void) setShouldSmoothFonts:(BOOL)yn                { [_layer setShouldSmoothFonts:yn];            }
 - (void) setShouldSubpixelPositionFonts:(BOOL)yn      { [_layer setShouldSubpixelPositionFonts:yn];  }
 - (void) setShouldSubpixelQuantizeFonts:(BOOL)yn      { [_layer setShouldSubpixelQuantizeFonts:yn];  }
+- (void) setShouldCacheSlidingSprites:(BOOL)yn        { [_layer setShouldCacheSlidingSprites:yn];    }
 - (void) setShouldFlattenSublayers:(BOOL)yn           { [_layer setShouldFlattenSublayers:yn];       }
 - (void) setShouldDrawDebugColors:(BOOL)yn            { [_layer setShouldDrawDebugColors:yn];        }
 
@@ -307,6 +320,7 @@
 - (BOOL)            shouldSmoothFonts                 { return [_layer shouldSmoothFonts];           }
 - (BOOL)            shouldSubpixelPositionFonts       { return [_layer shouldSubpixelPositionFonts]; }
 - (BOOL)            shouldSubpixelQuantizeFonts       { return [_layer shouldSubpixelQuantizeFonts]; }
+- (BOOL)            shouldCacheSlidingSprites         { return [_layer shouldCacheSlidingSprites];   }
 - (BOOL)            shouldFlattenSublayers            { return [_layer shouldFlattenSublayers];      }
 - (BOOL)            shouldDrawDebugColors             { return [_layer shouldDrawDebugColors];       }
 
@@ -36,6 +36,7 @@ extern void SwiffWriterFree(SwiffWriter *writer);
 
 extern NSData *SwiffWriterGetData(SwiffWriter *writer);
 
+// Writes a 'CWS' or 'ZWS' file when header.isCompressed is YES, depending on header.compression
 extern NSData *SwiffWriterGetDataWithHeader(SwiffWriter *writer, SwiffHeader header);
 
 
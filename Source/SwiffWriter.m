@@ -27,6 +27,7 @@
 
 #import "SwiffWriter.h"
 
+#import <SwiffLZMA.h>
 #import <SwiffUtils.h>
 
 #include <stdlib.h>
@@ -108,8 +109,10 @@ NSData *SwiffWriterGetDataWithHeader(SwiffWriter *writer, SwiffHeader header)
 
     NSUInteger fileSize = CFDataGetLength(subwriter->data) + 8;
 
+    BOOL isLZMA = header.isCompressed && (header.compression == SwiffCompressionLZMA);
+
     UInt8 signature[4];
-    signature[0] = (header.isCompressed ? 'C' : 'F');
+    signature[0] = (header.isCompressed ? (isLZMA ? 'Z' : 'C') : 'F');
     signature[1] = 'W';
     signature[2] = 'S';
     signature[3] = header.version;
@@ -118,7 +121,29 @@ NSData *SwiffWriterGetDataWithHeader(SwiffWriter *writer, SwiffHeader header)
     [result appendBytes:&signature length:4];
     [result appendBytes:&fileSize  length:4];
 
-    if (header.isCompressed) {
+    if (isLZMA) {
+        UInt8      properties[SwiffLZMAPropertiesLength];
+        NSUInteger compressedLength = 0;
+        UInt8     *compressedBytes  = SwiffLZMAEncode(CFDataGetBytePtr(subwriter->data), CFDataGetLength(subwriter->data), properties, &compressedLength);
+
+        if (compressedBytes) {
+            UInt32 length32 = (UInt32)compressedLength;
+
+            [result appendBytes:&length32 length:4];
+            [result appendBytes:properties length:SwiffLZMAPropertiesLength];
+            [result appendBytes:compressedBytes length:compressedLength];
+
+            free(compressedBytes);
+
+        // Fallback to uncompressed
+        } else {
+            SwiffWarn(@"Writer", @"SwiffWriterGetDataWithHeader(): falling back to uncompressed");
+
+            [result replaceBytesInRange:NSMakeRange(0, 1) withBytes:"F"];
+            [result appendData:(__bridge NSData *)subwriter->data];
+        }
+
+    } else if (header.isCompressed) {
         z_stream stream;
         bzero(&stream, sizeof(z_stream));
 